@@ -125,6 +125,27 @@ void benchmark_text_rendering(display_handle_t display, int iterations) {
     printf("Text rendering benchmark: %d iterations in %.2f ms\n", iterations, elapsed);
     printf("Average time per text: %.2f ms\n", elapsed / iterations);
     printf("Text operations per second: %.2f\n", (iterations * 1000.0) / elapsed);
+    
+    // Rendering alone, with the bus out of the picture
+    int draws = iterations * 200;
+    
+    start_time = get_time_ms();
+    for (int i = 0; i < draws && running; i++) {
+        rpi_display_draw_text(display, (i * 20) % 240, ((i * 20) / 240) * 10 % 400, test_text, (i % 8) << 13);
+    }
+    double text_ms = get_time_ms() - start_time;
+    
+    start_time = get_time_ms();
+    for (int i = 0; i < draws && running; i++) {
+        rpi_display_draw_text_opaque(display, (i * 20) % 240, ((i * 20) / 240) * 10 % 400, test_text,
+                                     (i % 8) << 13, COLOR_BLACK);
+    }
+    double opaque_ms = get_time_ms() - start_time;
+    
+    rpi_display_refresh(display);
+    
+    printf("Draw only: %.2f us per text, %.2f us opaque (%d strings each)\n",
+           text_ms * 1000.0 / draws, opaque_ms * 1000.0 / draws, draws);
 }
 
 void benchmark_line_drawing(display_handle_t display, int iterations) {
@@ -192,6 +213,610 @@ void benchmark_circle_drawing(display_handle_t display, int iterations) {
     printf("Circle operations per second: %.2f\n", (iterations * 1000.0) / elapsed);
 }
 
+// The pre-batching drawing path: one locked set_pixel call per pixel
+static void draw_line_per_pixel(display_handle_t display, int x0, int y0, int x1, int y1, uint16_t color) {
+    int dx = abs(x1 - x0);
+    int dy = abs(y1 - y0);
+    int sx = x0 < x1 ? 1 : -1;
+    int sy = y0 < y1 ? 1 : -1;
+    int err = dx - dy;
+    
+    while (true) {
+        rpi_display_set_pixel(display, x0, y0, color);
+        if (x0 == x1 && y0 == y1) break;
+        
+        int e2 = 2 * err;
+        if (e2 > -dy) { err -= dy; x0 += sx; }
+        if (e2 < dx) { err += dx; y0 += sy; }
+    }
+}
+
+static void draw_circle_per_pixel(display_handle_t display, int x, int y, int radius, uint16_t color) {
+    int xx = 0;
+    int yy = radius;
+    int d = 3 - 2 * radius;
+    
+    while (yy >= xx) {
+        rpi_display_set_pixel(display, x + xx, y + yy, color);
+        rpi_display_set_pixel(display, x - xx, y + yy, color);
+        rpi_display_set_pixel(display, x + xx, y - yy, color);
+        rpi_display_set_pixel(display, x - xx, y - yy, color);
+        rpi_display_set_pixel(display, x + yy, y + xx, color);
+        rpi_display_set_pixel(display, x - yy, y + xx, color);
+        rpi_display_set_pixel(display, x + yy, y - xx, color);
+        rpi_display_set_pixel(display, x - yy, y - xx, color);
+        
+        xx++;
+        if (d > 0) {
+            yy--;
+            d = d + 4 * (xx - yy) + 10;
+        } else {
+            d = d + 4 * xx + 6;
+        }
+    }
+}
+
+// mode 0: per-pixel locking, 1: one lock per primitive, 2: one lock per frame
+static double run_batching_mode(display_handle_t display, int primitive, int mode, int iterations) {
+    int width = rpi_display_get_width(display);
+    int height = rpi_display_get_height(display);
+    
+    srand(1234); // Same shapes in every mode
+    
+    double start_time = get_time_ms();
+    
+    if (mode == 2) rpi_display_begin_frame(display);
+    
+    for (int i = 0; i < iterations && running; i++) {
+        uint16_t color = (i % 8) << 13;
+        int x = rand() % width;
+        int y = rand() % height;
+        int x1 = rand() % width;
+        int y1 = rand() % height;
+        
+        if (primitive == 0) {
+            if (mode == 0) draw_line_per_pixel(display, x, y, x1, y1, color);
+            else rpi_display_draw_line(display, x, y, x1, y1, color);
+        } else if (primitive == 1) {
+            if (mode == 0) draw_circle_per_pixel(display, x, y, 5 + x1 % 30, color);
+            else rpi_display_draw_circle(display, x, y, 5 + x1 % 30, color);
+        } else {
+            rpi_display_draw_text(display, x % (width - 136), y, "Hello, World! 123", color);
+        }
+    }
+    
+    if (mode == 2) rpi_display_end_frame(display);
+    
+    return get_time_ms() - start_time;
+}
+
+void benchmark_frame_batching(display_handle_t display, int iterations) {
+    printf("\nBenchmarking draw locking (no refresh)...\n");
+    
+    static const char* primitives[] = { "line", "circle", "text" };
+    
+    for (int primitive = 0; primitive < 3; primitive++) {
+        double per_pixel = primitive < 2 ? run_batching_mode(display, primitive, 0, iterations) : 0.0;
+        double per_call = run_batching_mode(display, primitive, 1, iterations);
+        double batched = run_batching_mode(display, primitive, 2, iterations);
+        
+        if (primitive < 2) {
+            printf("%-6s: %7.2f us per-pixel lock, %7.2f us per-call lock, %7.2f us in frame\n",
+                   primitives[primitive], per_pixel * 1000.0 / iterations,
+                   per_call * 1000.0 / iterations, batched * 1000.0 / iterations);
+        } else {
+            printf("%-6s: %7.2f us per-call lock, %7.2f us in frame\n",
+                   primitives[primitive], per_call * 1000.0 / iterations, batched * 1000.0 / iterations);
+        }
+    }
+    
+    rpi_display_refresh(display);
+}
+
+void benchmark_filled_shapes(display_handle_t display, int iterations) {
+    printf("\nBenchmarking filled shapes (no refresh)...\n");
+    
+    static const char* shapes[] = { "circle", "ellipse", "round rect", "triangle" };
+    int width = rpi_display_get_width(display);
+    int height = rpi_display_get_height(display);
+    
+    for (int shape = 0; shape < 4; shape++) {
+        double start_time = get_time_ms();
+        
+        for (int i = 0; i < iterations && running; i++) {
+            uint16_t color = (i % 8) << 13;
+            int x = rand() % width;
+            int y = rand() % height;
+            
+            switch (shape) {
+                case 0: rpi_display_fill_circle(display, x, y, 30, color); break;
+                case 1: rpi_display_fill_ellipse(display, x, y, 40, 20, color); break;
+                case 2: rpi_display_fill_round_rect(display, x, y, 80, 40, 8, color); break;
+                default: rpi_display_fill_triangle(display, x, y, x + 60, y + 20, x + 10, y + 50, color); break;
+            }
+        }
+        
+        double elapsed = get_time_ms() - start_time;
+        printf("%-10s: %.2f us per shape\n", shapes[shape], elapsed * 1000.0 / iterations);
+    }
+    
+    rpi_display_refresh(display);
+}
+
+void benchmark_copy_rect(display_handle_t display, int iterations) {
+    printf("\nBenchmarking framebuffer moves (no refresh)...\n");
+    
+    static const char* directions[] = { "up", "down", "left", "right" };
+    static const int dx[] = { 0, 0, -1, 1 };
+    static const int dy[] = { -1, 1, 0, 0 };
+    
+    // Slide a 200x200 panel one pixel per call; every move overlaps itself
+    for (int dir = 0; dir < 4; dir++) {
+        double start_time = get_time_ms();
+        
+        for (int i = 0; i < iterations && running; i++) {
+            rpi_display_copy_rect(display, 60, 140, 200, 200, 60 + dx[dir], 140 + dy[dir]);
+        }
+        
+        double elapsed = get_time_ms() - start_time;
+        printf("%-5s: %.2f us per 200x200 move\n", directions[dir], elapsed * 1000.0 / iterations);
+    }
+    
+    rpi_display_refresh(display);
+}
+
+void benchmark_alpha_blit(display_handle_t display, int iterations) {
+    printf("\nBenchmarking alpha blits against the opaque copy (no refresh)...\n");
+    
+    // 64x64 icon: a disc with a soft edge over a transparent square
+    enum { ICON = 64 };
+    static uint16_t pixels[ICON * ICON];
+    static uint8_t alpha[ICON * ICON];
+    static uint32_t argb[ICON * ICON];
+    
+    for (int y = 0; y < ICON; y++) {
+        for (int x = 0; x < ICON; x++) {
+            double d = sqrt((x - 31.5) * (x - 31.5) + (y - 31.5) * (y - 31.5));
+            int a = d < 24 ? 255 : d < 32 ? (int)((32 - d) * 255 / 8) : 0;
+            uint32_t rgb = (uint32_t)(x * 4) << 16 | (uint32_t)(y * 4) << 8 | 0x80;
+            
+            pixels[y * ICON + x] = ((x * 4) & 0xF8) << 8 | ((y * 4) & 0xFC) << 3 | 0x80 >> 3;
+            alpha[y * ICON + x] = a;
+            argb[y * ICON + x] = (uint32_t)a << 24 | rgb;
+        }
+    }
+    
+    static const char* modes[] = { "copy_buffer", "blit_rgb565a8", "blit_argb8888" };
+    double copy_us = 0;
+    
+    for (int mode = 0; mode < 3; mode++) {
+        double start_time = get_time_ms();
+        
+        for (int i = 0; i < iterations && running; i++) {
+            int x = (i * 37) % (320 - ICON);
+            int y = (i * 53) % (480 - ICON);
+            
+            if (mode == 0) {
+                rpi_display_copy_buffer(display, pixels, x, y, ICON, ICON);
+            } else if (mode == 1) {
+                rpi_display_blit_rgb565a8(display, pixels, alpha, x, y, ICON, ICON);
+            } else {
+                rpi_display_blit_argb8888(display, argb, x, y, ICON, ICON);
+            }
+        }
+        
+        double us = (get_time_ms() - start_time) * 1000.0 / iterations;
+        if (mode == 0) copy_us = us;
+        printf("%-14s: %.2f us per %dx%d icon (%.2fx copy)\n", modes[mode], us, ICON, ICON, us / copy_us);
+    }
+    
+    // Anti-aliased text against the 1 bpp built-in font, same cell size.
+    // Every glyph of the coverage font is a soft ring; only the cost matters.
+    static uint8_t coverage[95 * 8 * 8];
+    for (int i = 0; i < 95 * 64; i++) {
+        double d = sqrt((i % 8 - 3.5) * (i % 8 - 3.5) + (i / 8 % 8 - 3.5) * (i / 8 % 8 - 3.5));
+        double c = 255 - fabs(d - 2.5) * 170;
+        coverage[i] = c > 0 ? (uint8_t)c : 0;
+    }
+    
+    font_handle_t font = rpi_display_create_font(8, 8, 8, ' ', 95, coverage);
+    if (font) {
+        const char* test_text = "Hello, World! 123";
+        int draws = iterations * 10;
+        
+        double start_time = get_time_ms();
+        for (int i = 0; i < draws && running; i++) {
+            rpi_display_draw_text(display, (i * 20) % 240, (i * 7) % 400, test_text, COLOR_WHITE);
+        }
+        double bitmap_us = (get_time_ms() - start_time) * 1000.0 / draws;
+        
+        start_time = get_time_ms();
+        for (int i = 0; i < draws && running; i++) {
+            rpi_display_draw_text_font(display, font, (i * 20) % 240, (i * 7) % 400, test_text, COLOR_WHITE);
+        }
+        double smooth_us = (get_time_ms() - start_time) * 1000.0 / draws;
+        
+        printf("Text: %.2f us per string 1 bpp, %.2f us anti-aliased\n", bitmap_us, smooth_us);
+        rpi_display_free_font(font);
+    }
+    
+    rpi_display_refresh(display);
+}
+
+static void* volatile surface_sink;
+
+// A gauge-like widget: ring, needle and label
+static void draw_widget(display_handle_t display, int x, int y, int value) {
+    rpi_display_fill_round_rect(display, x, y, 96, 96, 12, COLOR_BLUE);
+    rpi_display_draw_circle(display, x + 48, y + 44, 36, COLOR_WHITE);
+    rpi_display_fill_circle(display, x + 48, y + 44, 30, COLOR_BLACK);
+    rpi_display_draw_line(display, x + 48, y + 44, x + 48 + value % 25, y + 20, COLOR_RED);
+    rpi_display_draw_text(display, x + 20, y + 84, "Speed", COLOR_YELLOW);
+}
+
+void benchmark_surfaces(display_handle_t display, int iterations) {
+    printf("\nBenchmarking offscreen surfaces (no refresh)...\n");
+    
+    // Redraw a widget every time against rendering it once and blitting
+    double start_time = get_time_ms();
+    for (int i = 0; i < iterations && running; i++) {
+        draw_widget(display, (i * 37) % 224, (i * 53) % 384, 7);
+    }
+    double redraw_us = (get_time_ms() - start_time) * 1000.0 / iterations;
+    
+    surface_handle_t widget = rpi_surface_create(96, 96);
+    if (!widget) {
+        printf("Failed to create surface\n");
+        return;
+    }
+    
+    rpi_display_set_target(display, widget);
+    draw_widget(display, 0, 0, 7);
+    rpi_display_set_target(display, NULL);
+    
+    start_time = get_time_ms();
+    for (int i = 0; i < iterations && running; i++) {
+        rpi_display_blit_surface(display, widget, 0, 0, 96, 96, (i * 37) % 224, (i * 53) % 384);
+    }
+    double blit_us = (get_time_ms() - start_time) * 1000.0 / iterations;
+    rpi_surface_destroy(widget);
+    
+    printf("96x96 widget: %.2f us redrawn, %.2f us blitted from a surface\n", redraw_us, blit_us);
+    
+    // Create/destroy churn of mixed sizes, pooled against plain malloc
+    static const int sizes[][2] = { {32, 32}, {96, 96}, {200, 40}, {320, 100}, {320, 480} };
+    int cycles = iterations * 10;
+    surface_pool_stats_t before, after;
+    
+    rpi_surface_get_pool_stats(&before);
+    start_time = get_time_ms();
+    for (int i = 0; i < cycles && running; i++) {
+        surface_handle_t surface = rpi_surface_create(sizes[i % 5][0], sizes[i % 5][1]);
+        rpi_surface_destroy(surface);
+    }
+    double pool_us = (get_time_ms() - start_time) * 1000.0 / cycles;
+    rpi_surface_get_pool_stats(&after);
+    
+    start_time = get_time_ms();
+    for (int i = 0; i < cycles && running; i++) {
+        uint16_t* buffer = calloc(sizes[i % 5][0] * sizes[i % 5][1], sizeof(uint16_t));
+        if (buffer) buffer[0] = (uint16_t)i;  // Keep the allocation from being elided
+        surface_sink = buffer;
+        free(buffer);
+    }
+    double calloc_us = (get_time_ms() - start_time) * 1000.0 / cycles;
+    
+    printf("Create/destroy: %.2f us pooled (%llu of %llu reused), %.2f us calloc\n",
+           pool_us, (unsigned long long)(after.reused - before.reused),
+           (unsigned long long)(after.allocations - before.allocations), calloc_us);
+    printf("Pool: %llu KiB reserved, %llu KiB cached\n",
+           (unsigned long long)after.bytes_reserved / 1024, (unsigned long long)after.bytes_cached / 1024);
+    
+    rpi_display_refresh(display);
+}
+
+void benchmark_full_refresh(display_handle_t display, int iterations) {
+    printf("\nBenchmarking full-screen flush against wire time...\n");
+    
+    display_stats_t stats;
+    uint64_t total_ns = 0;
+    uint64_t total_wire_ns = 0;
+    int frames = 0;
+    
+    rpi_display_get_stats(display, &stats);
+    uint64_t start_staged = stats.bytes_staged;
+    
+    for (int i = 0; i < iterations && running; i++) {
+        rpi_display_clear(display, (i % 2) ? COLOR_BLUE : COLOR_RED);
+        rpi_display_refresh(display);
+        
+        rpi_display_get_stats(display, &stats);
+        total_ns += stats.last_frame_ns;
+        total_wire_ns += stats.last_frame_wire_ns;
+        frames++;
+    }
+    
+    if (frames == 0) return;
+    
+    double frame_ms = total_ns / 1e6 / frames;
+    double wire_ms = total_wire_ns / 1e6 / frames;
+    
+    printf("Full flush: %.2f ms per frame, %.2f ms wire time (%.1f%% overhead)\n",
+           frame_ms, wire_ms, wire_ms > 0 ? (frame_ms - wire_ms) * 100.0 / wire_ms : 0.0);
+    printf("SPI ioctls per frame: %u\n", stats.last_frame_spi_ioctls);
+    printf("Bytes staged per frame: %.0f\n", (double)(stats.bytes_staged - start_staged) / frames);
+}
+
+void run_scattered_scenario(display_handle_t display, const char* name, uint32_t setup_cost, int iterations) {
+    int width = rpi_display_get_width(display);
+    int height = rpi_display_get_height(display);
+    display_stats_t stats;
+    uint64_t total_bytes = 0;
+    uint64_t total_rects = 0;
+    int frames = 0;
+    
+    rpi_display_set_damage_cost(display, setup_cost);
+    
+    double start_time = get_time_ms();
+    
+    for (int i = 0; i < iterations && running; i++) {
+        uint16_t color = (i % 8) << 13;
+        
+        // Status icon top-left, clock bottom-right, and a few scattered badges
+        rpi_display_fill_rect(display, 4, 4, 16, 16, color);
+        rpi_display_fill_rect(display, width - 68, height - 20, 64, 16, color);
+        rpi_display_fill_rect(display, width / 2 - 8, 4, 16, 16, color);
+        rpi_display_fill_rect(display, 4, height / 2, 24, 8, color);
+        rpi_display_refresh(display);
+        
+        rpi_display_get_stats(display, &stats);
+        total_bytes += stats.last_frame_bytes;
+        total_rects += stats.last_frame_rects;
+        frames++;
+    }
+    
+    double elapsed = get_time_ms() - start_time;
+    
+    if (frames == 0) return;
+    
+    printf("%-14s cost %10u: %8.0f bytes/frame, %5.2f windows/frame, %.2f ms/frame\n",
+           name, setup_cost, (double)total_bytes / frames, (double)total_rects / frames,
+           elapsed / frames);
+}
+
+void benchmark_scattered_updates(display_handle_t display, int iterations) {
+    printf("\nBenchmarking scattered partial updates (bytes on wire)...\n");
+    
+    run_scattered_scenario(display, "separate", 0, iterations);
+    run_scattered_scenario(display, "default", 384, iterations);
+    run_scattered_scenario(display, "bounding box", 0xFFFFFFFF, iterations);
+    
+    // Restore the driver default
+    rpi_display_set_damage_cost(display, 384);
+}
+
+void benchmark_full_redraw(display_handle_t display, int iterations) {
+    int width = rpi_display_get_width(display);
+    display_stats_t stats;
+    uint64_t total_bytes = 0;
+    uint64_t total_skipped = 0;
+    int frames = 0;
+    char text[32];
+    
+    double start_time = get_time_ms();
+    
+    // Immediate-mode style UI: the whole screen is redrawn every frame but
+    // only the counter actually changes
+    for (int i = 0; i < iterations && running; i++) {
+        rpi_display_clear(display, COLOR_BLACK);
+        rpi_display_fill_rect(display, 0, 0, width, 24, COLOR_BLUE);
+        rpi_display_draw_text(display, 4, 8, "STATUS", COLOR_WHITE);
+        snprintf(text, sizeof(text), "FRAME %d", i);
+        rpi_display_draw_text(display, 10, 40, text, COLOR_GREEN);
+        rpi_display_refresh(display);
+        
+        rpi_display_get_stats(display, &stats);
+        total_bytes += stats.last_frame_bytes;
+        total_skipped += stats.last_frame_bytes_skipped;
+        frames++;
+    }
+    
+    double elapsed = get_time_ms() - start_time;
+    
+    if (frames == 0) return;
+    
+    printf("Full redraw: %8.0f bytes/frame sent, %8.0f bytes/frame skipped, %.2f ms/frame\n",
+           (double)total_bytes / frames, (double)total_skipped / frames, elapsed / frames);
+}
+
+void benchmark_layers(display_handle_t display, int iterations) {
+    printf("\nBenchmarking layered compositing...\n");
+    
+    int width = rpi_display_get_width(display);
+    int height = rpi_display_get_height(display);
+    display_stats_t stats;
+    uint64_t total_bytes = 0;
+    uint64_t total_composed = 0;
+    int frames = 0;
+    
+    // Background, a gauge in the middle and a touch marker on top; only
+    // the marker moves. First everything is redrawn for every frame.
+    double start_time = get_time_ms();
+    for (int i = 0; i < iterations && running; i++) {
+        for (int y = 0; y < height; y += 32) {
+            rpi_display_fill_rect(display, 0, y, width, 32, (y / 32 % 2) ? COLOR_BLACK : COLOR_BLUE);
+        }
+        draw_widget(display, 40, 40, 7);
+        rpi_display_fill_circle(display, 20 + (i * 7) % (width - 40), height / 2, 16, COLOR_RED);
+        rpi_display_refresh(display);
+        
+        rpi_display_get_stats(display, &stats);
+        total_bytes += stats.last_frame_bytes;
+        frames++;
+    }
+    double redraw_ms = frames ? (get_time_ms() - start_time) / frames : 0;
+    double redraw_bytes = frames ? (double)total_bytes / frames : 0;
+    
+    layer_handle_t background = rpi_display_create_layer(display, 0, 0, width, height, 0, LAYER_OPAQUE);
+    layer_handle_t gauge = rpi_display_create_layer(display, 40, 40, 96, 96, 1, LAYER_KEYED);
+    layer_handle_t marker = rpi_display_create_layer(display, 4, height / 2 - 16, 33, 33, 2, LAYER_KEYED);
+    
+    if (!background || !gauge || !marker) {
+        printf("Failed to create layers\n");
+    } else {
+        rpi_display_set_target(display, rpi_layer_get_surface(background));
+        for (int y = 0; y < height; y += 32) {
+            rpi_display_fill_rect(display, 0, y, width, 32, (y / 32 % 2) ? COLOR_BLACK : COLOR_BLUE);
+        }
+        rpi_display_set_target(display, rpi_layer_get_surface(gauge));
+        draw_widget(display, 0, 0, 7);
+        rpi_display_set_target(display, rpi_layer_get_surface(marker));
+        rpi_display_fill_circle(display, 16, 16, 16, COLOR_RED);
+        rpi_display_set_target(display, NULL);
+        rpi_display_refresh(display);
+        
+        total_bytes = 0;
+        frames = 0;
+        
+        start_time = get_time_ms();
+        for (int i = 0; i < iterations && running; i++) {
+            rpi_display_move_layer(display, marker, 4 + (i * 7) % (width - 40), height / 2 - 16);
+            rpi_display_refresh(display);
+            
+            rpi_display_get_stats(display, &stats);
+            total_bytes += stats.last_frame_bytes;
+            total_composed += stats.last_frame_pixels_composed;
+            frames++;
+        }
+        double layers_ms = frames ? (get_time_ms() - start_time) / frames : 0;
+        
+        if (frames > 0) {
+            printf("Redraw all:  %8.0f bytes/frame, %.2f ms/frame\n", redraw_bytes, redraw_ms);
+            printf("Move layer:  %8.0f bytes/frame, %.2f ms/frame, %.0f pixels composed/frame\n",
+                   (double)total_bytes / frames, layers_ms, (double)total_composed / frames);
+        }
+    }
+    
+    rpi_display_destroy_layer(display, marker);
+    rpi_display_destroy_layer(display, gauge);
+    rpi_display_destroy_layer(display, background);
+    rpi_display_refresh(display);
+}
+
+void benchmark_sprites(display_handle_t display, int iterations) {
+    printf("\nBenchmarking touch crosshair...\n");
+    
+    int width = rpi_display_get_width(display);
+    int height = rpi_display_get_height(display);
+    display_stats_t stats;
+    uint64_t total_bytes = 0;
+    int frames = 0;
+    
+    // 31x31 crosshair, solid lines over a translucent center
+    static uint16_t pixels[31 * 31];
+    static uint8_t alpha[31 * 31];
+    for (int i = 0; i < 31 * 31; i++) {
+        int dx = i % 31 - 15;
+        int dy = i / 31 - 15;
+        pixels[i] = COLOR_WHITE;
+        alpha[i] = (dx == 0 || dy == 0) ? 255 : (dx * dx + dy * dy < 25 ? 96 : 0);
+    }
+    
+    // Without sprites the content under the old position is repainted
+    // before the crosshair is drawn at the new one
+    for (int y = 0; y < height; y += 16) {
+        rpi_display_fill_rect(display, 0, y, width, 16, (y / 16 % 2) ? COLOR_BLACK : COLOR_BLUE);
+    }
+    rpi_display_refresh(display);
+    
+    double start_time = get_time_ms();
+    for (int i = 0; i < iterations && running; i++) {
+        int x = 20 + (i * 5) % (width - 40);
+        int y = height / 2 + (i % 20) - 10;
+        int old_x = 20 + ((i - 1) * 5) % (width - 40);
+        
+        for (int row = y - 31; row < y + 31; row++) {
+            int band = row < 0 ? 0 : row / 16;
+            rpi_display_fill_rect(display, old_x - 15, row, 31, 1, (band % 2) ? COLOR_BLACK : COLOR_BLUE);
+        }
+        rpi_display_blit_rgb565a8(display, pixels, alpha, x - 15, y - 15, 31, 31);
+        rpi_display_refresh(display);
+        
+        rpi_display_get_stats(display, &stats);
+        total_bytes += stats.last_frame_bytes;
+        frames++;
+    }
+    double repaint_ms = frames ? (get_time_ms() - start_time) / frames : 0;
+    double repaint_bytes = frames ? (double)total_bytes / frames : 0;
+    
+    sprite_handle_t cursor = rpi_display_create_sprite(display, pixels, alpha, 31, 31, 15, 15);
+    if (!cursor) {
+        printf("Failed to create sprite\n");
+        return;
+    }
+    
+    for (int y = 0; y < height; y += 16) {
+        rpi_display_fill_rect(display, 0, y, width, 16, (y / 16 % 2) ? COLOR_BLACK : COLOR_BLUE);
+    }
+    rpi_display_set_sprite_visible(display, cursor, true);
+    rpi_display_refresh(display);
+    
+    total_bytes = 0;
+    frames = 0;
+    
+    start_time = get_time_ms();
+    for (int i = 0; i < iterations && running; i++) {
+        rpi_display_move_sprite(display, cursor, 20 + (i * 5) % (width - 40), height / 2 + (i % 20) - 10);
+        rpi_display_refresh(display);
+        
+        rpi_display_get_stats(display, &stats);
+        total_bytes += stats.last_frame_bytes;
+        frames++;
+    }
+    double sprite_ms = frames ? (get_time_ms() - start_time) / frames : 0;
+    
+    rpi_display_destroy_sprite(display, cursor);
+    rpi_display_refresh(display);
+    
+    if (frames > 0) {
+        printf("Repaint + draw: %6.0f bytes/frame, %.3f ms/frame\n", repaint_bytes, repaint_ms);
+        printf("Sprite move:    %6.0f bytes/frame, %.3f ms/frame\n", (double)total_bytes / frames, sprite_ms);
+    }
+}
+
+void benchmark_log_scroll(display_handle_t display, int iterations) {
+    printf("\nBenchmarking log view scrolling...\n");
+    
+    int height = rpi_display_get_height(display);
+    display_stats_t stats;
+    uint64_t total_bytes = 0;
+    uint64_t total_wire_ns = 0;
+    int frames = 0;
+    char text[32];
+    
+    double start_time = get_time_ms();
+    
+    // New line at the bottom of a scrolling area below a fixed header
+    for (int i = 0; i < iterations && running; i++) {
+        rpi_display_scroll_region(display, 24, height - 24, 10, COLOR_BLACK);
+        snprintf(text, sizeof(text), "LOG LINE %d", i);
+        rpi_display_draw_text(display, 4, height - 9, text, COLOR_WHITE);
+        rpi_display_refresh(display);
+        
+        rpi_display_get_stats(display, &stats);
+        total_bytes += stats.last_frame_bytes;
+        total_wire_ns += stats.last_frame_wire_ns;
+        frames++;
+    }
+    
+    double elapsed = get_time_ms() - start_time;
+    
+    if (frames == 0) return;
+    
+    printf("Log scroll: %8.0f bytes/frame, %.2f ms wire, %.2f ms/frame\n",
+           (double)total_bytes / frames, total_wire_ns / 1e6 / frames, elapsed / frames);
+}
+
 void benchmark_refresh_rate(display_handle_t display, int duration_seconds) {
     printf("\nBenchmarking refresh rate for %d seconds...\n", duration_seconds);
     
@@ -250,12 +875,50 @@ void run_all_benchmarks(display_handle_t display) {
     benchmark_text_rendering(display, 50);
     benchmark_line_drawing(display, 200);
     benchmark_circle_drawing(display, 100);
+    benchmark_frame_batching(display, 1000);
+    benchmark_filled_shapes(display, 1000);
+    benchmark_copy_rect(display, 1000);
+    benchmark_alpha_blit(display, 1000);
+    benchmark_surfaces(display, 1000);
+    benchmark_full_refresh(display, 30);
+    benchmark_scattered_updates(display, 50);
+    benchmark_full_redraw(display, 50);
+    benchmark_layers(display, 50);
+    benchmark_sprites(display, 200);
+    benchmark_log_scroll(display, 100);
     benchmark_refresh_rate(display, 5);
     
     printf("\n=== BENCHMARK COMPLETE ===\n");
 }
 
-int main() {
+// Compare the panel contents against the framebuffer after a full refresh
+void verify_panel(display_handle_t display) {
+    int width = rpi_display_get_width(display);
+    int height = rpi_display_get_height(display);
+    uint16_t* panel = malloc(width * height * sizeof(uint16_t));
+    int mismatches = 0;
+    
+    if (!panel) return;
+    
+    if (rpi_display_read_panel(display, panel) != RPI_DISPLAY_OK) {
+        printf("Panel readback not supported\n");
+        free(panel);
+        return;
+    }
+    
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            if (panel[y * width + x] != rpi_display_get_pixel(display, x, y)) {
+                mismatches++;
+            }
+        }
+    }
+    
+    printf("\nPanel readback: %d of %d pixels differ from the framebuffer\n", mismatches, width * height);
+    free(panel);
+}
+
+int main(int argc, char** argv) {
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
     
@@ -272,6 +935,19 @@ int main() {
         .refresh_rate = 60
     };
     
+    // --shadow diffs every refresh against the last-sent frame,
+    // --zero-copy sends contiguous rows without staging,
+    // --virtual runs against the in-memory panel model
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--shadow") == 0) {
+            config.enable_shadow_frame = true;
+        } else if (strcmp(argv[i], "--zero-copy") == 0) {
+            config.enable_zero_copy = true;
+        } else if (strcmp(argv[i], "--virtual") == 0) {
+            config.transport = DISPLAY_TRANSPORT_VIRTUAL;
+        }
+    }
+    
     display_handle_t display = rpi_display_init(&config);
     if (!display) {
         printf("Failed to initialize display\n");
@@ -289,6 +965,13 @@ int main() {
     rpi_display_draw_text(display, 10, 30, "Check console for results", COLOR_WHITE);
     rpi_display_refresh(display);
     
+    // Nothing to look at on a virtual panel; check what it received instead
+    if (config.transport == DISPLAY_TRANSPORT_VIRTUAL) {
+        verify_panel(display);
+        rpi_display_destroy(display);
+        return 0;
+    }
+    
     printf("\nBenchmark complete. Display will remain active.\n");
     printf("Press Ctrl+C to exit.\n");
     
@@ -10,7 +10,7 @@ void signal_handler(int sig) {
     running = 0;
 }
 
-int main() {
+int main(int argc, char** argv) {
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
     
@@ -45,6 +45,17 @@ int main() {
     // Draw text
     rpi_display_draw_text(display, 10, 80, "Hello, Efficient RPi Display!", COLOR_WHITE);
     rpi_display_draw_text(display, 10, 100, "Press Ctrl+C to exit", COLOR_YELLOW);
+    rpi_display_draw_text_font(display, NULL, 10, 120, "UTF-8: Grüße, café ═╬═ ▒▓█", COLOR_CYAN);
+    
+    // Optional console font, e.g. an unpacked /usr/share/consolefonts/*.psf
+    font_handle_t font = argc > 1 ? rpi_display_load_font(argv[1]) : NULL;
+    if (font) {
+        int font_height;
+        rpi_display_get_font_size(font, NULL, &font_height);
+        rpi_display_draw_text_font(display, font, 10, 140, "Hello, Efficient RPi Display!", COLOR_WHITE);
+        rpi_display_draw_text_font_opaque(display, font, 10, 140 + font_height + 4, "Grüße ← → ✓",
+                                          COLOR_BLACK, COLOR_YELLOW);
+    }
     
     // Refresh display
     rpi_display_refresh(display);
@@ -57,6 +68,7 @@ int main() {
     
     printf("Cleaning up...\n");
     rpi_display_destroy(display);
+    rpi_display_free_font(font);
     
     return 0;
 } 
\ No newline at end of file
@@ -0,0 +1,135 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/time.h>
+#include "efficient_rpi_display.h"
+#include "ili9486l_driver.h"
+
+#define TOGGLE_ITERATIONS   10000
+#define REFRESH_ITERATIONS  200
+
+static volatile int running = 1;
+
+void signal_handler(int sig) {
+    (void)sig;
+    running = 0;
+}
+
+double get_time_ms() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+static const char* backend_name(gpio_backend_t backend) {
+    switch (backend) {
+        case GPIO_BACKEND_CHARDEV: return "chardev";
+        case GPIO_BACKEND_SYSFS:   return "sysfs";
+        default:                   return "auto";
+    }
+}
+
+void benchmark_toggle_sysfs(int pin, int iterations) {
+    if (gpio_export(pin) < 0 || gpio_set_direction(pin, "out") < 0) {
+        printf("sysfs:   GPIO %d unavailable, skipping\n", pin);
+        return;
+    }
+
+    double start_time = get_time_ms();
+
+    for (int i = 0; i < iterations && running; i++) {
+        gpio_set_value(pin, i & 1);
+    }
+
+    double elapsed = get_time_ms() - start_time;
+    gpio_unexport(pin);
+
+    printf("sysfs:   %d toggles in %.2f ms, %.2f us/call, %d syscalls/call\n",
+           iterations, elapsed, elapsed * 1000.0 / iterations, GPIO_SYSFS_SYSCALLS);
+}
+
+void benchmark_toggle_chardev(int pin, int iterations) {
+    int line_fd = gpio_request_line(pin, "out", NULL, 0);
+    if (line_fd < 0) {
+        printf("chardev: GPIO %d unavailable, skipping\n", pin);
+        return;
+    }
+
+    double start_time = get_time_ms();
+
+    for (int i = 0; i < iterations && running; i++) {
+        gpio_line_set_value(line_fd, i & 1);
+    }
+
+    double elapsed = get_time_ms() - start_time;
+    gpio_release_line(&line_fd);
+
+    printf("chardev: %d toggles in %.2f ms, %.2f us/call, %d syscalls/call\n",
+           iterations, elapsed, elapsed * 1000.0 / iterations, GPIO_CHARDEV_SYSCALLS);
+}
+
+void benchmark_refresh(gpio_backend_t backend, int iterations) {
+    display_config_t config = {
+        .spi_speed = 80000000,
+        .spi_mode = 0,
+        .rotation = ROTATE_0,
+        .enable_dma = true,
+        .enable_double_buffer = false,
+        .refresh_rate = 60,
+        .gpio_backend = backend
+    };
+
+    display_handle_t display = rpi_display_init(&config);
+    if (!display) {
+        printf("%-8s: failed to initialize display, skipping\n", backend_name(backend));
+        return;
+    }
+
+    rpi_display_reset_stats(display);
+
+    double start_time = get_time_ms();
+
+    // Small widget updates, the case where per-call overhead dominates
+    for (int i = 0; i < iterations && running; i++) {
+        rpi_display_fill_rect(display, (i * 16) % 304, 0, 16, 16, (i & 1) ? COLOR_RED : COLOR_BLUE);
+        rpi_display_refresh(display);
+    }
+
+    double elapsed = get_time_ms() - start_time;
+
+    display_stats_t stats;
+    rpi_display_get_stats(display, &stats);
+
+    if (stats.frames > 0) {
+        printf("%-8s: %.2f GPIO writes, %.2f GPIO syscalls, %.2f SPI ioctls per refresh; %.3f ms/refresh\n",
+               backend_name(rpi_display_get_gpio_backend(display)),
+               (double)stats.gpio_writes / stats.frames,
+               (double)stats.gpio_syscalls / stats.frames,
+               (double)stats.spi_ioctls / stats.frames,
+               elapsed / stats.frames);
+    }
+
+    rpi_display_destroy(display);
+}
+
+int main(int argc, char** argv) {
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+
+    int pin = argc > 1 ? atoi(argv[1]) : GPIO_DC;
+
+    printf("Efficient RPi Display Driver - GPIO Backend Benchmark\n\n");
+
+    printf("Per-call GPIO toggle cost (GPIO %d):\n", pin);
+    benchmark_toggle_sysfs(pin, TOGGLE_ITERATIONS);
+    benchmark_toggle_chardev(pin, TOGGLE_ITERATIONS);
+
+    printf("\nPer-refresh cost (16x16 partial updates):\n");
+    benchmark_refresh(GPIO_BACKEND_SYSFS, REFRESH_ITERATIONS);
+    benchmark_refresh(GPIO_BACKEND_CHARDEV, REFRESH_ITERATIONS);
+
+    return 0;
+}
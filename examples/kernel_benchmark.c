@@ -0,0 +1,188 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/time.h>
+#include "pixel_kernels.h"
+
+#define PIXELS      (480 * 320)  // One full frame
+#define ITERATIONS  500
+
+static volatile int running = 1;
+
+void signal_handler(int sig) {
+    (void)sig;
+    running = 0;
+}
+
+double get_time_ms() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+// Bytes touched per call (read + write) over elapsed time
+static void report(const char* isa, const char* kernel, double bytes, int iterations, double elapsed) {
+    printf("%-7s %-20s %8.3f ms/frame  %7.2f GB/s\n",
+           isa, kernel, elapsed / iterations, bytes * iterations / (elapsed * 1e6));
+}
+
+static const char* const kernel_names[] = {
+    "fill16", "swap16_copy", "rgb888_to_rgb565", "argb8888_to_rgb565",
+    "blend_a8", "blend_argb8888", "blend_color_a8"
+};
+
+#define KERNEL_COUNT (int)(sizeof(kernel_names) / sizeof(kernel_names[0]))
+
+// Run one kernel of the table into dst; the blends read it too
+static void run_kernel(const pixel_kernels_t* kernels, int kernel, void* dst, const uint16_t* pixels,
+                       const uint8_t* bytes, const uint32_t* words, size_t count) {
+    switch (kernel) {
+        case 0: kernels->fill16(dst, 0x1234, count); break;
+        case 1: kernels->swap16_copy(dst, pixels, count); break;
+        case 2: kernels->rgb888_to_rgb565(dst, bytes, count); break;
+        case 3: kernels->argb8888_to_rgb565(dst, words, count); break;
+        case 4: kernels->blend_a8(dst, (const uint16_t*)words, bytes, count); break;
+        case 5: kernels->blend_argb8888(dst, words, count); break;
+        case 6: kernels->blend_color_a8(dst, 0x1234, bytes, count); break;
+    }
+}
+
+// Compare every kernel against the scalar one on the benchmark inputs. An
+// odd length runs the tail paths, and the guard bytes past it catch
+// overruns. Returns the number of kernels that disagree.
+static int verify_kernels(const pixel_kernels_t* kernels, const uint16_t* pixels,
+                          const uint8_t* bytes, const uint32_t* words) {
+    const pixel_kernels_t* reference = pixel_kernels_for_isa(PIXEL_ISA_SCALAR);
+    size_t count = PIXELS - 7;
+    size_t size = PIXELS * sizeof(uint16_t) + 64;
+    uint8_t* expected = malloc(size);
+    uint8_t* actual = malloc(size);
+    int failures = 0;
+
+    if (!expected || !actual) {
+        printf("Failed to allocate verification buffers\n");
+        free(expected);
+        free(actual);
+        return KERNEL_COUNT;
+    }
+
+    for (int k = 0; k < KERNEL_COUNT; k++) {
+        memset(expected, 0xA5, size);
+        memcpy(expected, pixels, count * sizeof(uint16_t));
+        memcpy(actual, expected, size);
+
+        run_kernel(reference, k, expected, pixels, bytes, words, count);
+        run_kernel(kernels, k, actual, pixels, bytes, words, count);
+
+        if (memcmp(expected, actual, size) != 0) {
+            printf("%-7s %-20s differs from scalar\n", kernels->name, kernel_names[k]);
+            failures++;
+        }
+    }
+
+    free(expected);
+    free(actual);
+    return failures;
+}
+
+void benchmark_kernels(const pixel_kernels_t* kernels, uint16_t* pixels, uint8_t* bytes, uint32_t* words) {
+    double start_time;
+    int i;
+
+    start_time = get_time_ms();
+    for (i = 0; i < ITERATIONS && running; i++) {
+        kernels->fill16(pixels, (uint16_t)i, PIXELS);
+    }
+    report(kernels->name, "fill16", PIXELS * 2.0, i, get_time_ms() - start_time);
+
+    start_time = get_time_ms();
+    for (i = 0; i < ITERATIONS && running; i++) {
+        kernels->swap16_copy(bytes, pixels, PIXELS);
+    }
+    report(kernels->name, "swap16_copy", PIXELS * 4.0, i, get_time_ms() - start_time);
+
+    start_time = get_time_ms();
+    for (i = 0; i < ITERATIONS && running; i++) {
+        kernels->rgb888_to_rgb565(pixels, bytes, PIXELS);
+    }
+    report(kernels->name, "rgb888_to_rgb565", PIXELS * 5.0, i, get_time_ms() - start_time);
+
+    start_time = get_time_ms();
+    for (i = 0; i < ITERATIONS && running; i++) {
+        kernels->argb8888_to_rgb565(pixels, words, PIXELS);
+    }
+    report(kernels->name, "argb8888_to_rgb565", PIXELS * 6.0, i, get_time_ms() - start_time);
+
+    // Blends read the destination too; bytes doubles as the alpha plane
+    start_time = get_time_ms();
+    for (i = 0; i < ITERATIONS && running; i++) {
+        kernels->blend_a8(pixels, (const uint16_t*)words, bytes, PIXELS);
+    }
+    report(kernels->name, "blend_a8", PIXELS * 7.0, i, get_time_ms() - start_time);
+
+    start_time = get_time_ms();
+    for (i = 0; i < ITERATIONS && running; i++) {
+        kernels->blend_argb8888(pixels, words, PIXELS);
+    }
+    report(kernels->name, "blend_argb8888", PIXELS * 8.0, i, get_time_ms() - start_time);
+
+    start_time = get_time_ms();
+    for (i = 0; i < ITERATIONS && running; i++) {
+        kernels->blend_color_a8(pixels, (uint16_t)i, bytes, PIXELS);
+    }
+    report(kernels->name, "blend_color_a8", PIXELS * 5.0, i, get_time_ms() - start_time);
+}
+
+int main() {
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+
+    printf("Efficient RPi Display Driver - Pixel Kernel Benchmark\n");
+    printf("Frame: %d pixels, %d iterations, active ISA: %s\n\n",
+           PIXELS, ITERATIONS, pixel_kernels_get()->name);
+
+    uint16_t* pixels = malloc(PIXELS * sizeof(uint16_t));
+    uint8_t* bytes = malloc(PIXELS * 3);
+    uint32_t* words = malloc(PIXELS * sizeof(uint32_t));
+
+    if (!pixels || !bytes || !words) {
+        printf("Failed to allocate buffers\n");
+        free(pixels);
+        free(bytes);
+        free(words);
+        return 1;
+    }
+
+    for (int i = 0; i < PIXELS; i++) {
+        pixels[i] = rand();
+        words[i] = rand();
+    }
+    for (int i = 0; i < PIXELS * 3; i++) {
+        bytes[i] = rand();
+    }
+
+    // Every ISA this build and CPU support, scalar reference first
+    int failed = 0;
+    for (int isa = PIXEL_ISA_SCALAR; isa < PIXEL_ISA_COUNT && running; isa++) {
+        const pixel_kernels_t* kernels = pixel_kernels_for_isa((pixel_isa_t)isa);
+        if (!kernels) continue;
+
+        // Timings of a wrong kernel mean nothing
+        if (isa != PIXEL_ISA_SCALAR && verify_kernels(kernels, pixels, bytes, words) > 0) {
+            printf("%-7s skipped\n\n", kernels->name);
+            failed = 1;
+            continue;
+        }
+
+        benchmark_kernels(kernels, pixels, bytes, words);
+        printf("\n");
+    }
+
+    free(pixels);
+    free(bytes);
+    free(words);
+
+    return failed;
+}
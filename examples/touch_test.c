@@ -1,6 +1,5 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include <unistd.h>
 #include <signal.h>
 #include "efficient_rpi_display.h"
 
@@ -43,16 +42,51 @@ int main() {
     printf("Touch test running. Touch the screen to see coordinates.\n");
     
     while (running) {
-        if (rpi_touch_is_pressed(display)) {
-            touch_point_t point = rpi_touch_read(display);
-            printf("Touch at: %d, %d\n", point.x, point.y);
+        // Sleeps until the touch thread queues something; the timeout
+        // only bounds how long Ctrl+C takes to be noticed
+        int result = rpi_touch_wait(display, 500);
+        if (result == RPI_DISPLAY_ERROR_TIMEOUT) {
+            continue;
+        }
+        if (result != RPI_DISPLAY_OK) {
+            printf("Touch input not available\n");
+            break;
+        }
+        
+        // Everything since the last pass, so fast strokes are not lost
+        touch_event_t events[32];
+        int count = rpi_touch_poll_events(display, events, 32);
+        
+        for (int i = 0; i < count; i++) {
+            const touch_event_t* event = &events[i];
+            
+            if (event->type == TOUCH_EVENT_DOWN) {
+                printf("Touch down at: %d, %d (pressure %d)\n", event->x, event->y, event->pressure);
+            } else if (event->type == TOUCH_EVENT_UP) {
+                printf("Touch up at: %d, %d\n", event->x, event->y);
+                continue;
+            }
             
             // Draw a small circle at touch point
-            rpi_display_draw_circle(display, point.x, point.y, 5, COLOR_RED);
-            rpi_display_refresh(display);
+            rpi_display_draw_circle(display, event->x, event->y, 5, COLOR_RED);
         }
         
-        usleep(50000); // 50ms
+        if (count > 0) {
+            rpi_display_refresh(display);
+        }
+    }
+    
+    touch_stats_t stats;
+    if (rpi_touch_get_stats(display, &stats) == RPI_DISPLAY_OK && stats.reports > 0) {
+        printf("Touch reports: %llu at %.1f/s, %.1f syscalls and %.0f us each\n",
+               (unsigned long long)stats.reports, stats.report_rate, stats.syscalls_per_report,
+               stats.last_report_ns / 1000.0);
+        printf("Samples: %llu (%llu under pressure threshold), %llu SPI messages, %llu reports oversampled\n",
+               (unsigned long long)stats.samples, (unsigned long long)stats.rejected,
+               (unsigned long long)stats.spi_ioctls, (unsigned long long)stats.oversampled);
+        printf("Events: %llu queued, %llu moves coalesced, %llu dropped\n",
+               (unsigned long long)stats.events, (unsigned long long)stats.moves_coalesced,
+               (unsigned long long)stats.events_dropped);
     }
     
     printf("Cleaning up...\n");
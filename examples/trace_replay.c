@@ -0,0 +1,84 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "efficient_rpi_display.h"
+#include "ili9486l_driver.h"
+#include "spi_trace.h"
+#include "virtual_panel.h"
+
+static void usage(const char* name) {
+    printf("Usage: %s [--spidev] [--realtime] <trace>\n", name);
+    printf("  --spidev    Replay onto the attached panel instead of the virtual one\n");
+    printf("  --realtime  Keep the recorded timing instead of replaying flat out\n");
+    printf("\nRecord a trace with rpi_display_trace_start() or RPI_DISPLAY_TRACE=<file>.\n");
+}
+
+int main(int argc, char** argv) {
+    const char* path = NULL;
+    int flags = 0;
+    
+    display_config_t config = {
+        .spi_speed = 0,
+        .gpio_backend = GPIO_BACKEND_AUTO,
+        .transport = DISPLAY_TRANSPORT_VIRTUAL
+    };
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--spidev") == 0) {
+            config.transport = DISPLAY_TRANSPORT_SPIDEV;
+        } else if (strcmp(argv[i], "--realtime") == 0) {
+            flags |= SPI_TRACE_REPLAY_REALTIME;
+        } else if (argv[i][0] != '-' && !path) {
+            path = argv[i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    
+    if (!path) {
+        usage(argv[0]);
+        return 1;
+    }
+    
+    // Only the transport is brought up; the trace carries everything else
+    ili9486l_ctx_t* ctx = calloc(1, sizeof(ili9486l_ctx_t));
+    if (!ctx) {
+        printf("Failed to allocate driver context\n");
+        return 1;
+    }
+    
+    const ili9486l_transport_t* transport = config.transport == DISPLAY_TRANSPORT_VIRTUAL ?
+                                            &virtual_panel_transport : &spidev_transport;
+    ctx->spi_speed = SPI_MAX_SPEED_HZ;
+    ctx->spi_fd = -1;
+    
+    if (transport->open(ctx, &config) != RPI_DISPLAY_OK) {
+        printf("Failed to open %s transport\n", transport->name);
+        free(ctx);
+        return 1;
+    }
+    ctx->transport = transport;
+    
+    spi_trace_stats_t stats;
+    int result = spi_trace_replay(ctx, path, flags, &stats);
+    
+    printf("Replayed %s onto %s transport%s\n", path, transport->name,
+           (flags & SPI_TRACE_REPLAY_REALTIME) ? " in real time" : "");
+    printf("Records: %llu (%llu messages, %llu transfers, %llu line writes)\n",
+           (unsigned long long)stats.records, (unsigned long long)stats.messages,
+           (unsigned long long)stats.transfers, (unsigned long long)stats.line_writes);
+    printf("Payload: %llu bytes, %llu elided\n",
+           (unsigned long long)stats.bytes, (unsigned long long)stats.bytes_elided);
+    printf("Recorded span: %.2f ms at %u Hz\n", stats.trace_ns / 1e6, stats.spi_speed);
+    printf("Replay time:   %.2f ms\n", stats.replay_ns / 1e6);
+    
+    if (transport->bus_time_ns) {
+        printf("Wire time:     %.2f ms\n", transport->bus_time_ns(ctx) / 1e6);
+    }
+    
+    transport->close(ctx);
+    free(ctx);
+    
+    return result == RPI_DISPLAY_OK ? 0 : 1;
+}
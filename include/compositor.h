@@ -0,0 +1,61 @@
+#ifndef COMPOSITOR_H
+#define COMPOSITOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "efficient_rpi_display.h"
+#include "ili9486l_driver.h"
+#include "raster.h"
+#include "surface.h"
+
+#define COMPOSITOR_MAX_LAYERS  16
+#define COMPOSITOR_SPAN        256   // Pixels per alpha row built for a blend
+
+// One z-ordered layer. Pixels live in a pool surface; drawing into it with
+// the surface as target records damage in layer coordinates.
+typedef struct layer {
+    surface_t* surface;
+    damage_region_t damage;  // Changed since the last compose, layer coordinates
+    int x, y;
+    int z;
+    layer_mode_t mode;
+    bool visible;
+    uint8_t opacity;
+    uint16_t key;            // Transparent color of LAYER_KEYED layers
+} layer_t;
+
+typedef struct {
+    layer_t* layers[COMPOSITOR_MAX_LAYERS];  // Bottom to top, equal z in creation order
+    int count;
+    damage_region_t pending;   // Screen rects uncovered or exposed by layer changes
+    damage_region_t previous;  // Last composed rects, stale in the swapped-in buffer
+    uint32_t setup_cost;       // Damage merge threshold, as ili9486l_ctx_t
+    int width, height;         // Screen size at the last compose
+    uint16_t background;       // Shown where no layer covers the screen
+} compositor_t;
+
+void compositor_init(compositor_t* comp, uint32_t setup_cost);
+void compositor_destroy(compositor_t* comp);
+
+// Layer changes queue the footprints they expose, old and new, for the
+// next compose; a move costs only those two rects.
+layer_t* compositor_create_layer(compositor_t* comp, int x, int y, int width, int height, int z,
+                                 layer_mode_t mode);
+void compositor_destroy_layer(compositor_t* comp, layer_t* layer);
+void compositor_move_layer(compositor_t* comp, layer_t* layer, int x, int y);
+void compositor_set_visible(compositor_t* comp, layer_t* layer, bool visible);
+void compositor_set_opacity(compositor_t* comp, layer_t* layer, uint8_t opacity);
+void compositor_set_key(compositor_t* comp, layer_t* layer, uint16_t key);
+void compositor_set_z(compositor_t* comp, layer_t* layer, int z);
+void compositor_set_background(compositor_t* comp, uint16_t color);
+void compositor_damage_layer(compositor_t* comp, layer_t* layer, int x, int y, int width, int height);
+
+// Recomposite every damaged screen rect into screen, bottom layer up, and
+// add the rects to composed. swapped says screen holds the frame before
+// the last one, so the rects composed last time are redone as well.
+// Returns the pixels written.
+uint64_t compositor_compose(compositor_t* comp, const raster_target_t* screen, bool swapped,
+                            damage_region_t* composed);
+
+#endif // COMPOSITOR_H
@@ -4,6 +4,17 @@
 #include "efficient_rpi_display.h"
 #include "ili9486l_driver.h"
 #include "xpt2046_touch.h"
+#include "text_render.h"
+#include "surface.h"
+#include "compositor.h"
+#include "sprite.h"
+
+// Snapshot of a damaged region waiting for the flush thread
+typedef struct {
+    const uint16_t* buffer;
+    damage_region_t region;  // Empty means full screen
+    uint64_t seq;
+} flush_job_t;
 
 // Main display context structure
 typedef struct rpi_display_ctx {
@@ -22,7 +33,35 @@ typedef struct rpi_display_ctx {
     
     // Threading and synchronization
     pthread_mutex_t context_mutex;
+    pthread_mutex_t transport_mutex;  // Serializes SPI access; taken after context_mutex
+    
+    // Asynchronous flushing
+    bool async_enabled;
+    pthread_t flush_thread;
+    pthread_mutex_t flush_mutex;
+    pthread_cond_t flush_cond;
+    bool flush_running;
+    uint16_t* staging[2];
+    int staging_stale;      // Snapshots still to be copied in full
+    flush_job_t jobs[2];
+    int job_head;           // Next job for the flush thread
+    int job_count;          // Queued or in-flight jobs
+    uint64_t submitted_seq;
+    uint64_t completed_seq;
+    int flush_error;
+    
+    // Expanded glyphs for opaque text, guarded by context_mutex
+    glyph_cache_t glyph_cache;
     
+    // Drawing goes here instead of the screen when set, guarded by context_mutex
+    surface_t* target;
+    
+    // Layers composited into the screen at refresh, guarded by context_mutex
+    compositor_t compositor;
+    
+    // Sprites blended in at flush time only, guarded by context_mutex
+    sprite_set_t sprites;
+
 } rpi_display_ctx_t;
 
 // Internal function prototypes
@@ -31,6 +31,19 @@ typedef enum {
     ROTATE_270 = 3
 } display_rotation_t;
 
+// GPIO backend
+typedef enum {
+    GPIO_BACKEND_AUTO    = 0,  // Character device, falling back to sysfs
+    GPIO_BACKEND_CHARDEV = 1,  // /dev/gpiochipN line requests
+    GPIO_BACKEND_SYSFS   = 2   // Legacy /sys/class/gpio
+} gpio_backend_t;
+
+// Bus the display driver talks to
+typedef enum {
+    DISPLAY_TRANSPORT_SPIDEV  = 0,  // /dev/spidev0.0 plus GPIO control lines
+    DISPLAY_TRANSPORT_VIRTUAL = 1   // In-memory ILI9486 model, no hardware needed
+} display_transport_t;
+
 // Display configuration
 typedef struct {
     uint32_t spi_speed;
@@ -39,11 +52,67 @@ typedef struct {
     bool enable_dma;
     bool enable_double_buffer;
     uint32_t refresh_rate;
+    gpio_backend_t gpio_backend;
+    uint32_t spi_stripe_size;  // Bytes per flush stripe, 0 = spidev bufsiz
+    bool enable_async_flush;   // Flush from a dedicated thread (see rpi_display_refresh_async)
+    bool enable_shadow_frame;  // Diff damage against the last-sent frame before flushing
+    bool enable_zero_copy;     // Send contiguous rows straight from the framebuffer as 16-bit words
+    display_transport_t transport;
 } display_config_t;
 
+// Display driver statistics
+typedef struct {
+    uint64_t frames;         // Completed refreshes
+    uint64_t gpio_writes;    // GPIO line updates
+    uint64_t gpio_syscalls;  // System calls spent on GPIO updates
+    uint64_t spi_ioctls;     // SPI_IOC_MESSAGE submissions
+    uint64_t spi_bytes;      // Bytes clocked out over SPI
+    uint32_t last_frame_spi_ioctls;  // SPI submissions for the last refresh
+    uint32_t last_frame_syscalls;    // SPI + GPIO kernel entries for the last refresh
+    uint64_t last_frame_ns;          // Wall time of the last refresh
+    uint64_t last_frame_wire_ns;     // Bus time of the last refresh at spi_speed
+    uint32_t last_frame_bytes;       // Bytes clocked out for the last refresh
+    uint32_t last_frame_rects;       // Windows flushed for the last refresh
+    uint64_t bytes_staged;           // Pixel bytes copied into transfer buffers
+    uint64_t bytes_skipped;          // Damaged bytes found unchanged by the shadow frame
+    uint32_t last_frame_bytes_skipped;
+    uint64_t pixels_composed;        // Pixels recomposited from layers
+    uint32_t last_frame_pixels_composed;
+} display_stats_t;
+
 // Display handle (opaque)
 typedef struct rpi_display_ctx* display_handle_t;
 
+// Font handle (opaque), shared by every display
+typedef struct font* font_handle_t;
+
+// Offscreen surface handle (opaque), shared by every display
+typedef struct surface* surface_handle_t;
+
+// Surface pool accounting, process-wide
+typedef struct {
+    uint64_t allocations;     // Surfaces created
+    uint64_t reused;          // Of those, served from a free list
+    uint64_t bytes_reserved;  // Held from the system: arenas and blocks
+    uint64_t bytes_in_use;    // Blocks backing live surfaces
+    uint64_t bytes_cached;    // Blocks on free lists
+    uint32_t surfaces;        // Live surfaces
+} surface_pool_stats_t;
+
+// Compositor layer handle (opaque), owned by one display
+typedef struct layer* layer_handle_t;
+
+// How a layer covers what is below it
+typedef enum {
+    LAYER_OPAQUE = 0,  // Every pixel, blended by the layer opacity
+    LAYER_KEYED        // Pixels equal to the color key are left out
+} layer_mode_t;
+
+#define RPI_LAYER_DEFAULT_KEY  0xF81F  // Magenta
+
+// Sprite handle (opaque), owned by one display
+typedef struct sprite* sprite_handle_t;
+
 // Touch point structure
 typedef struct {
     int16_t x;
@@ -52,6 +121,21 @@ typedef struct {
     uint32_t timestamp;
 } touch_point_t;
 
+// Touch events, in the order they happened
+typedef enum {
+    TOUCH_EVENT_DOWN,
+    TOUCH_EVENT_MOVE,
+    TOUCH_EVENT_UP           // Position of the last report before lift-off
+} touch_event_type_t;
+
+typedef struct {
+    touch_event_type_t type;
+    int16_t x;
+    int16_t y;
+    int16_t pressure;        // 0 on TOUCH_EVENT_UP
+    uint64_t timestamp_ns;   // CLOCK_MONOTONIC
+} touch_event_t;
+
 // Touch configuration
 typedef struct {
     int16_t cal_x_min;
@@ -61,14 +145,56 @@ typedef struct {
     bool swap_xy;
     bool invert_x;
     bool invert_y;
+    gpio_backend_t gpio_backend;
+    uint8_t samples;     // X/Y/Z1/Z2 sets per report, up to 16, 0 = 3
+    uint8_t max_samples; // Total when those disagree, up to 16, 0 = 9; at most samples disables
+    uint8_t resolution;  // Conversion bits, 12 or 8, 0 = 12
+    bool software_cs;    // Drive T_CS from a GPIO instead of the SPI controller (fixed at init)
+    uint16_t report_rate; // Reports per second while pressed, up to 1000, 0 = 125
 } touch_config_t;
 
+// Touch sampling statistics
+typedef struct {
+    uint64_t reports;         // Positions published
+    uint64_t samples;         // X/Y/Z1/Z2 sets converted
+    uint64_t rejected;        // Of those, below the pressure threshold
+    uint64_t oversampled;     // Reports that took max_samples because samples disagreed
+    uint64_t spi_ioctls;      // SPI_IOC_MESSAGE submissions
+    uint64_t syscalls;        // Kernel entries spent sampling, wake-up included
+    uint64_t last_report_ns;  // Wake-up to published position, last report
+    uint64_t events;          // Queued for rpi_touch_poll_events
+    uint64_t moves_coalesced; // Merged into a later event while the queue was full
+    uint64_t events_dropped;  // Downs and ups lost to a full queue
+    float report_rate;        // Reports per second over the last second of contact
+    float syscalls_per_report;
+} touch_stats_t;
+
 // Display API
 display_handle_t rpi_display_init(const display_config_t* config);
 void rpi_display_destroy(display_handle_t display);
 int rpi_display_set_rotation(display_handle_t display, display_rotation_t rotation);
 int rpi_display_get_width(display_handle_t display);
 int rpi_display_get_height(display_handle_t display);
+gpio_backend_t rpi_display_get_gpio_backend(display_handle_t display);
+int rpi_display_get_stats(display_handle_t display, display_stats_t* stats);
+void rpi_display_reset_stats(display_handle_t display);
+int rpi_display_read_panel(display_handle_t display, uint16_t* buffer);  // Needs a transport with readback
+
+// SPI trace capture: record what the driver sends to a file for offline
+// replay (see spi_trace.h). Flags are RPI_DISPLAY_TRACE_*. Starting a
+// trace resets and reconfigures the panel so the trace can be replayed on
+// its own; the picture stays but the panel blanks for about a third of a
+// second.
+#define RPI_DISPLAY_TRACE_ELIDE_PAYLOAD  0x01  // Keep only the length of pixel payloads
+#define RPI_DISPLAY_TRACE_COMPRESS       0x02  // Run-length encode payloads
+int rpi_display_trace_start(display_handle_t display, const char* path, int flags);
+int rpi_display_trace_stop(display_handle_t display);
+
+// Frame batching: drawing calls between begin and end run under one lock
+// taken by begin_frame. Refresh, rotation and frame waits are rejected
+// until the frame is ended.
+int rpi_display_begin_frame(display_handle_t display);
+int rpi_display_end_frame(display_handle_t display);
 
 // Drawing functions
 int rpi_display_clear(display_handle_t display, uint16_t color);
@@ -77,12 +203,117 @@ uint16_t rpi_display_get_pixel(display_handle_t display, int x, int y);
 int rpi_display_fill_rect(display_handle_t display, int x, int y, int width, int height, uint16_t color);
 int rpi_display_draw_line(display_handle_t display, int x0, int y0, int x1, int y1, uint16_t color);
 int rpi_display_draw_circle(display_handle_t display, int x, int y, int radius, uint16_t color);
+int rpi_display_fill_circle(display_handle_t display, int x, int y, int radius, uint16_t color);
+int rpi_display_fill_ellipse(display_handle_t display, int x, int y, int rx, int ry, uint16_t color);
+int rpi_display_fill_round_rect(display_handle_t display, int x, int y, int width, int height, int radius, uint16_t color);
+int rpi_display_fill_triangle(display_handle_t display, int x0, int y0, int x1, int y1, int x2, int y2, uint16_t color);
+// Text is 8x8 cells, one per byte, read as Latin-1; '\n' starts a new line
 int rpi_display_draw_text(display_handle_t display, int x, int y, const char* text, uint16_t color);
+int rpi_display_draw_text_opaque(display_handle_t display, int x, int y, const char* text, uint16_t fg, uint16_t bg);
+
+// PSF1/PSF2 console fonts (unpacked, e.g. from /usr/share/consolefonts)
+// and BDF files. PSF glyphs stay in a shared read-only mapping. Loading a
+// file twice returns the same font; free it once per load.
+font_handle_t rpi_display_load_font(const char* path);
+void rpi_display_free_font(font_handle_t font);
+
+// Anti-aliased fonts. create_font copies 4 or 8 bpp coverage glyphs (rows
+// padded to whole bytes, leftmost pixel in the high bits); glyph i draws
+// code point first_codepoint + i. smooth_font derives a 4 bpp font at
+// 1/factor the size of a bitmap font (NULL for the built-in one). Text in
+// either blends into the framebuffer; free both like loaded fonts.
+font_handle_t rpi_display_create_font(int width, int height, int bpp, uint32_t first_codepoint,
+                                      uint32_t glyph_count, const uint8_t* glyphs);
+font_handle_t rpi_display_smooth_font(font_handle_t font, int factor);
+int rpi_display_get_font_size(font_handle_t font, int* width, int* height);
+
+// UTF-8 text in a loaded font, or the built-in one when font is NULL
+int rpi_display_draw_text_font(display_handle_t display, font_handle_t font, int x, int y, const char* text,
+                               uint16_t color);
+int rpi_display_draw_text_font_opaque(display_handle_t display, font_handle_t font, int x, int y,
+                                      const char* text, uint16_t fg, uint16_t bg);
 
 // Buffer operations
 int rpi_display_copy_buffer(display_handle_t display, const uint16_t* buffer, int x, int y, int width, int height);
+int rpi_display_copy_buffer_rgb888(display_handle_t display, const uint8_t* buffer, int x, int y, int width, int height);
+int rpi_display_copy_buffer_argb8888(display_handle_t display, const uint32_t* buffer, int x, int y, int width, int height);
+// Alpha-blended blits, sources packed like copy_buffer. Alpha 0 leaves the
+// framebuffer untouched and 255 matches an opaque copy.
+int rpi_display_blit_rgb565a8(display_handle_t display, const uint16_t* pixels, const uint8_t* alpha,
+                              int x, int y, int width, int height);
+int rpi_display_blit_argb8888(display_handle_t display, const uint32_t* pixels, int x, int y, int width, int height);
+int rpi_display_copy_rect(display_handle_t display, int src_x, int src_y, int width, int height,
+                          int dst_x, int dst_y);  // Within the framebuffer, overlap allowed
 int rpi_display_refresh(display_handle_t display);
 int rpi_display_refresh_rect(display_handle_t display, int x, int y, int width, int height);
+int rpi_display_set_damage_cost(display_handle_t display, uint32_t setup_cost_bytes);
+
+// Offscreen surfaces come from a size-class pool: destroying one keeps its
+// block for the next surface of a similar size, so widgets can be created
+// and dropped in a UI loop without touching malloc. Rows are cache-line
+// aligned. Contents start out black.
+surface_handle_t rpi_surface_create(int width, int height);
+void rpi_surface_destroy(surface_handle_t surface);
+int rpi_surface_get_size(surface_handle_t surface, int* width, int* height);
+uint16_t* rpi_surface_get_pixels(surface_handle_t surface, int* stride);  // Stride in pixels
+int rpi_surface_get_pool_stats(surface_pool_stats_t* stats);
+void rpi_surface_pool_trim(void);  // Free cached blocks that can go back to the system
+
+// Point every drawing call on the display, text and blits included, at a
+// surface instead of the screen; NULL goes back to the screen. Drawing
+// into a surface marks nothing dirty on screen; a layer's surface
+// damages its layer instead. The target is per display, so set it inside
+// a frame when other threads draw too, and reset it before destroying the
+// surface.
+int rpi_display_set_target(display_handle_t display, surface_handle_t surface);
+
+// Copy part of a surface to (dst_x, dst_y) on the current target, the
+// screen or another surface. The rect is clipped to both.
+int rpi_display_blit_surface(display_handle_t display, surface_handle_t surface, int src_x, int src_y,
+                             int width, int height, int dst_x, int dst_y);
+
+// Layers are z-ordered surfaces composited into the screen by
+// rpi_display_refresh and rpi_display_refresh_async. Drawing into a
+// layer's surface, set as the target, damages that layer only; moving,
+// hiding or restacking a layer damages its old and new footprints. Each
+// refresh recomposites just the damaged rects, bottom layer up, and skips
+// whatever lies under an opaque layer covering the rect. Screen areas no
+// layer covers show the background color. Drawing straight to the screen
+// still works but is overwritten wherever layers get recomposited.
+layer_handle_t rpi_display_create_layer(display_handle_t display, int x, int y, int width, int height,
+                                        int z, layer_mode_t mode);  // Keyed layers start out transparent
+void rpi_display_destroy_layer(display_handle_t display, layer_handle_t layer);
+surface_handle_t rpi_layer_get_surface(layer_handle_t layer);  // Owned by the layer
+int rpi_display_move_layer(display_handle_t display, layer_handle_t layer, int x, int y);
+int rpi_display_set_layer_visible(display_handle_t display, layer_handle_t layer, bool visible);
+int rpi_display_set_layer_opacity(display_handle_t display, layer_handle_t layer, uint8_t opacity);
+int rpi_display_set_layer_key(display_handle_t display, layer_handle_t layer, uint16_t key);
+int rpi_display_set_layer_z(display_handle_t display, layer_handle_t layer, int z);  // Goes above equal z
+int rpi_display_set_layer_background(display_handle_t display, uint16_t color);
+// Damage part of a layer written through rpi_surface_get_pixels
+int rpi_display_damage_layer(display_handle_t display, layer_handle_t layer, int x, int y, int width, int height);
+
+// Sprites work like a hardware cursor: they are blended over the screen
+// while it is flushed and never land in the framebuffer, so nothing needs
+// repainting under them. Moving one only sends its old and new rects.
+// Up to four per display, later ones on top; alpha may be NULL for an
+// opaque sprite. The image is copied and the sprite starts out hidden.
+sprite_handle_t rpi_display_create_sprite(display_handle_t display, const uint16_t* pixels, const uint8_t* alpha,
+                                          int width, int height, int hot_x, int hot_y);
+void rpi_display_destroy_sprite(display_handle_t display, sprite_handle_t sprite);
+int rpi_display_move_sprite(display_handle_t display, sprite_handle_t sprite, int x, int y);  // Hot spot to (x, y)
+int rpi_display_set_sprite_visible(display_handle_t display, sprite_handle_t sprite, bool visible);
+
+// Move rows top..top+height-1 up by dy (down if negative) and fill the rows
+// uncovered. Portrait rotations scroll on the panel with VSCRSADD, so the
+// next refresh only sends the uncovered rows and anything drawn since.
+int rpi_display_scroll_region(display_handle_t display, int top, int height, int dy, uint16_t fill);
+
+// Asynchronous refresh. The damaged region is snapshotted and flushed by a
+// background thread; the returned fence completes once it is on the panel.
+// Buffers swap and the same frame goes out as with rpi_display_refresh.
+int rpi_display_refresh_async(display_handle_t display, uint64_t* fence);
+int rpi_display_wait_frame(display_handle_t display, uint64_t fence, int timeout_ms);
 
 // Touch API
 int rpi_touch_init(display_handle_t display, const touch_config_t* config);
@@ -91,6 +322,23 @@ touch_point_t rpi_touch_read(display_handle_t display);
 bool rpi_touch_is_pressed(display_handle_t display);
 int rpi_touch_calibrate(display_handle_t display);
 int rpi_touch_set_config(display_handle_t display, const touch_config_t* config);
+int rpi_touch_get_stats(display_handle_t display, touch_stats_t* stats);
+void rpi_touch_reset_stats(display_handle_t display);
+
+// Take up to max queued events without blocking; returns how many were
+// written or a negative error. Lock-free against the touch thread, but
+// only one thread may poll a display at a time.
+int rpi_touch_poll_events(display_handle_t display, touch_event_t* events, int max);
+
+// An eventfd that is readable while events are queued, for the caller's
+// own poll or epoll loop. Drain it with rpi_touch_poll_events rather than
+// reading it; it stays owned by the display.
+int rpi_touch_get_fd(display_handle_t display);
+
+// Block until events are queued (RPI_DISPLAY_OK) or timeout_ms passes
+// (RPI_DISPLAY_ERROR_TIMEOUT, also returned when a signal arrives).
+// A negative timeout waits forever.
+int rpi_touch_wait(display_handle_t display, int timeout_ms);
 
 // Utility functions
 uint16_t rgb_to_rgb565(uint8_t r, uint8_t g, uint8_t b);
@@ -0,0 +1,68 @@
+#ifndef FONT_H
+#define FONT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+struct font_file;
+
+// Bitmap font: glyph_count cells of width x height pixels. Each glyph row
+// is padded to row_bytes whole bytes with the most significant bit as the
+// leftmost pixel, the layout PSF and BDF fonts use. Anti-aliased fonts
+// store coverage instead: 4 bpp packs two pixels per byte, high nibble
+// leftmost, and 8 bpp is one byte per pixel. Zero coverage is background,
+// the largest value solid foreground.
+typedef struct font {
+    const char* name;
+    uint32_t id;             // Glyph cache key, never reused while the process runs
+    int width;
+    int height;
+    int row_bytes;
+    int bpp;                 // 1, or 4 and 8 for coverage glyphs
+    uint32_t glyph_count;
+    uint32_t default_glyph;  // Drawn for indices past glyph_count
+    const uint8_t* glyphs;   // glyph_count * height * row_bytes
+    struct font_file* file;  // Backing file, NULL for the built-in font
+} font_t;
+
+#define FONT_BUILTIN_ID  1
+
+// 8x8 font covering all 256 byte values: ASCII, box drawing and block
+// elements in 0x7F-0x9F, Latin-1 in 0xA0-0xFF
+extern const font_t font_builtin_8x8;
+
+static inline const uint8_t* font_glyph(const font_t* font, uint32_t glyph) {
+    if (glyph >= font->glyph_count) glyph = font->default_glyph;
+    return font->glyphs + (uint32_t)glyph * font->height * font->row_bytes;
+}
+
+// PSF1, PSF2 and BDF files. PSF glyphs are used in place from a read-only
+// shared mapping, so every display and process drawing with the font
+// shares one copy in the page cache. Loading a file that is already open
+// returns the same font with one more reference.
+font_t* font_load(const char* path);
+void font_release(font_t* font);
+
+// Coverage font from glyph_count cells laid out as above; the data is
+// copied. Glyph i draws code point first_codepoint + i, or code point i
+// when first_codepoint is 0.
+font_t* font_create(int width, int height, int bpp, uint32_t first_codepoint, uint32_t glyph_count,
+                    const uint8_t* glyphs);
+
+// 4 bpp anti-aliased copy of a bitmap font at 1/factor the size, e.g. a
+// 16x32 console font smoothed down to 8x16. Shares the source's code
+// point table and holds a reference to it.
+font_t* font_smooth(const font_t* source, int factor);
+
+// Build the code point table on first use. Call before a run of
+// font_lookup on the font; lookups themselves take no lock.
+void font_prepare(const font_t* font);
+
+// Glyph for a Unicode code point, or the font's replacement glyph
+uint32_t font_lookup(const font_t* font, uint32_t codepoint);
+
+// Decode one UTF-8 sequence and advance past it. Malformed input yields
+// U+FFFD; a NUL is never consumed as part of a sequence.
+uint32_t font_utf8_next(const char** text);
+
+#endif // FONT_H
@@ -3,17 +3,24 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <pthread.h>
 #include <linux/spi/spidev.h>
+#include "efficient_rpi_display.h"
+#include "pixel_kernels.h"
 
 // ILI9486L Commands
+#define ILI9486L_SWRESET    0x01  // Software Reset
 #define ILI9486L_SLPOUT     0x11  // Sleep Out
 #define ILI9486L_DISPON     0x29  // Display On
 #define ILI9486L_CASET      0x2A  // Column Address Set
 #define ILI9486L_PASET      0x2B  // Page Address Set
 #define ILI9486L_RAMWR      0x2C  // Memory Write
 #define ILI9486L_RAMRD      0x2E  // Memory Read
+#define ILI9486L_VSCRDEF    0x33  // Vertical Scrolling Definition
 #define ILI9486L_MADCTL     0x36  // Memory Access Control
+#define ILI9486L_VSCRSADD   0x37  // Vertical Scrolling Start Address
 #define ILI9486L_PIXFMT     0x3A  // Interface Pixel Format
+#define ILI9486L_RAMWRC     0x3C  // Memory Write Continue
 #define ILI9486L_FRMCTR1    0xB1  // Frame Rate Control (Normal Mode)
 #define ILI9486L_DFUNCTR    0xB6  // Display Function Control
 #define ILI9486L_PWCTR1     0xC0  // Power Control 1
@@ -37,29 +44,123 @@
 #define GPIO_CS    8   // Chip Select pin
 #define GPIO_LED   18  // LED Backlight pin
 
+// GPIO character device
+#define GPIO_CHIP_DEVICE   "/dev/gpiochip0"
+#define GPIO_CONSUMER      "efficient-rpi-display"
+
+// System calls per GPIO update for each backend
+#define GPIO_SYSFS_SYSCALLS    3  // open + write + close
+#define GPIO_CHARDEV_SYSCALLS  1  // GPIO_V2_LINE_SET_VALUES_IOCTL
+
 // SPI settings
 #define SPI_DEVICE         "/dev/spidev0.0"
 #define SPI_MODE           SPI_MODE_0
 #define SPI_BITS_PER_WORD  8
+#define SPI_PIXEL_BITS     16  // One RGB565 pixel per word, shifted out MSB first
 #define SPI_MAX_SPEED_HZ   80000000
+#define SPI_BUFSIZ_PARAM   "/sys/module/spidev/parameters/bufsiz"
+#define SPI_DEFAULT_BUFSIZ 4096  // spidev default transfer limit
 
 // DMA settings
 #define DMA_CHANNEL        5
 #define DMA_BUFFER_SIZE    (320 * 480 * 2)  // Full screen buffer
 
-// Display context structure
+// Damage tracking
+#define DAMAGE_MAX_RECTS           16
+#define DAMAGE_DEFAULT_SETUP_COST  384  // Bytes of pixel data one window setup is worth
+#define SHADOW_CHUNK_PIXELS        32   // Compare granularity (one cache line)
+
+typedef struct {
+    int16_t x;
+    int16_t y;
+    int16_t width;
+    int16_t height;
+} damage_rect_t;
+
+// Bounded set of rectangles flushed with one window setup each
+typedef struct {
+    damage_rect_t rects[DAMAGE_MAX_RECTS];
+    int count;
+} damage_region_t;
+
+// SPI batch settings
+#define SPI_BATCH_MAX_SEGMENTS  32
+#define SPI_BATCH_SCRATCH_SIZE  256
+
+// One DC-qualified piece of an SPI batch
+typedef struct {
+    const uint8_t* data;
+    uint32_t length;
+    uint8_t dc;          // 0 = command, 1 = data
+    uint8_t bits;        // Bits per word for this segment
+    bool cs_change;      // Deassert CS after this segment
+} spi_segment_t;
+
+// Command stream queued for submission. Segments with the same DC level
+// go out as one SPI_IOC_MESSAGE(N); the message is split wherever DC flips.
+typedef struct {
+    spi_segment_t segments[SPI_BATCH_MAX_SEGMENTS];
+    int count;
+    uint8_t scratch[SPI_BATCH_SCRATCH_SIZE];  // Copies of command bytes and parameters
+    uint32_t scratch_used;
+} spi_batch_t;
+
+// Transmit worker that clocks out one stripe while the next is converted
 typedef struct {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    bool running;
+    bool busy;               // A stripe is in flight
+    const uint8_t* pending;  // Stripe waiting for the worker
+    uint32_t pending_length;
+    int error;
+} spi_stream_t;
+
+struct ili9486l_ctx;
+struct spi_trace;
+
+// Bus underneath the driver: an SPI device plus the DC/RST/LED lines.
+// message() sends one chip-select-held SPI message at the DC level last
+// set through write_line(GPIO_DC). open() returns an RPI_DISPLAY_* code.
+typedef struct {
+    const char* name;
+    int (*open)(struct ili9486l_ctx* ctx, const display_config_t* config);
+    void (*close)(struct ili9486l_ctx* ctx);
+    int (*message)(struct ili9486l_ctx* ctx, struct spi_ioc_transfer* transfers, int count);
+    int (*write_line)(struct ili9486l_ctx* ctx, int pin, int value);
+    uint64_t (*bus_time_ns)(struct ili9486l_ctx* ctx);          // Optional modelled bus clock
+    int (*read_frame)(struct ili9486l_ctx* ctx, uint16_t* pixels);  // Optional panel readback
+} ili9486l_transport_t;
+
+extern const ili9486l_transport_t spidev_transport;
+
+// Display context structure
+typedef struct ili9486l_ctx {
+    // Transport
+    const ili9486l_transport_t* transport;
+    void* transport_data;
+    struct spi_trace* trace;  // Records bus traffic while set
+    
     // SPI interface
     int spi_fd;
     struct spi_ioc_transfer spi_tr;
     uint8_t* tx_buffer;
     uint8_t* rx_buffer;
+    spi_batch_t batch;
+    spi_stream_t stream;
+    uint32_t stripe_size;    // Bytes per streamed stripe, bounded by spidev bufsiz
+    bool stream_enabled;     // Transmit worker is running
+    bool zero_copy;          // Controller takes 16-bit words, pixels need no staging
+    const pixel_kernels_t* kernels;  // Pixel loops for the running CPU
     
-    // GPIO interface
+    // GPIO interface (line request fds when using the character device)
+    gpio_backend_t gpio_backend;
     int gpio_fd_dc;
     int gpio_fd_rst;
     int gpio_fd_cs;
     int gpio_fd_led;
+    int8_t dc_state;
     
     // DMA interface
     int dma_fd;
@@ -83,13 +184,34 @@ typedef struct {
     uint32_t frame_count;
     uint64_t last_refresh_time;
     uint32_t refresh_rate;
+    display_stats_t stats;
+    uint64_t frame_start_spi_ioctls;
+    uint64_t frame_start_gpio_syscalls;
+    uint64_t frame_start_spi_bytes;
+    uint64_t frame_start_time;
+    uint64_t frame_start_bus_ns;
+    uint32_t frame_rects;
+    
+    // Last programmed CASET/PASET window (-1 = unknown)
+    int16_t window_x0;
+    int16_t window_y0;
+    int16_t window_x1;
+    int16_t window_y1;
     
     // Dirty rectangle tracking
     bool dirty_rect_enabled;
-    int16_t dirty_x_min;
-    int16_t dirty_y_min;
-    int16_t dirty_x_max;
-    int16_t dirty_y_max;
+    damage_region_t damage;
+    uint32_t damage_setup_cost;  // Merge rects when the extra bytes cost less than this
+    
+    // Shadow frame: copy of what is on the panel
+    uint16_t* shadow;
+    bool shadow_valid;
+    
+    // Hardware vertical scroll area in logical rows (height 0 = none).
+    // Area row i lives in GRAM page top + (i + offset) % height.
+    uint16_t scroll_top;
+    uint16_t scroll_height;
+    uint16_t scroll_offset;
     
 } ili9486l_ctx_t;
 
@@ -104,6 +226,12 @@ int ili9486l_write_data(ili9486l_ctx_t* ctx, const uint8_t* data, uint32_t lengt
 int ili9486l_write_command(ili9486l_ctx_t* ctx, uint8_t command);
 int ili9486l_refresh_display(ili9486l_ctx_t* ctx);
 int ili9486l_refresh_rect(ili9486l_ctx_t* ctx, int x, int y, int width, int height);
+int ili9486l_refresh_rect_from(ili9486l_ctx_t* ctx, const uint16_t* source, int x, int y, int width, int height);
+int ili9486l_refresh_region_from(ili9486l_ctx_t* ctx, const uint16_t* source, const damage_region_t* region);
+int ili9486l_read_frame(ili9486l_ctx_t* ctx, uint16_t* pixels);
+int ili9486l_scroll_region(ili9486l_ctx_t* ctx, int top, int height, int dy);
+int ili9486l_trace_start(ili9486l_ctx_t* ctx, const char* path, int flags);
+void ili9486l_trace_stop(ili9486l_ctx_t* ctx);
 
 // GPIO helpers
 int gpio_export(int pin);
@@ -112,6 +240,13 @@ int gpio_set_direction(int pin, const char* direction);
 int gpio_set_value(int pin, int value);
 int gpio_get_value(int pin);
 
+// GPIO character device helpers
+int gpio_request_line(int pin, const char* direction, const char* edge, int value);
+void gpio_release_line(int* line_fd);
+int gpio_line_set_value(int line_fd, int value);
+int gpio_line_get_value(int line_fd);
+int gpio_line_read_events(int line_fd);
+
 // DMA helpers
 int dma_init(ili9486l_ctx_t* ctx);
 void dma_destroy(ili9486l_ctx_t* ctx);
@@ -122,9 +257,22 @@ int spi_init(ili9486l_ctx_t* ctx);
 void spi_destroy(ili9486l_ctx_t* ctx);
 int spi_transfer(ili9486l_ctx_t* ctx, const uint8_t* tx_data, uint8_t* rx_data, uint32_t length);
 
+// Batched SPI transport. Parameters are copied; data payloads are referenced
+// and must stay valid until spi_batch_submit() returns.
+int spi_batch_command(ili9486l_ctx_t* ctx, uint8_t command, const uint8_t* params, uint32_t length);
+int spi_batch_data(ili9486l_ctx_t* ctx, const uint8_t* data, uint32_t length);
+int spi_batch_pixels(ili9486l_ctx_t* ctx, const uint16_t* pixels, uint32_t count);
+int spi_batch_submit(ili9486l_ctx_t* ctx);
+
+// Striped pixel streaming
+uint32_t spi_get_bufsiz(void);
+int spi_stream_start(ili9486l_ctx_t* ctx);
+void spi_stream_stop(ili9486l_ctx_t* ctx);
+
 // Performance helpers
 void mark_dirty_rect(ili9486l_ctx_t* ctx, int x, int y, int width, int height);
 void clear_dirty_rect(ili9486l_ctx_t* ctx);
 bool has_dirty_rect(ili9486l_ctx_t* ctx);
+void damage_region_add(damage_region_t* region, int x, int y, int width, int height, uint32_t setup_cost);
 
 #endif // ILI9486L_DRIVER_H 
\ No newline at end of file
@@ -0,0 +1,71 @@
+#ifndef PIXEL_KERNELS_H
+#define PIXEL_KERNELS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Instruction sets a kernel table can be built for
+typedef enum {
+    PIXEL_ISA_SCALAR = 0,
+    PIXEL_ISA_SSE2,
+    PIXEL_ISA_AVX2,
+    PIXEL_ISA_NEON,
+    PIXEL_ISA_COUNT
+} pixel_isa_t;
+
+// Hot pixel loops. Pointers need no particular alignment.
+typedef struct {
+    pixel_isa_t isa;
+    const char* name;
+
+    // Store value into count consecutive pixels
+    void (*fill16)(uint16_t* dst, uint16_t value, size_t count);
+
+    // Copy count RGB565 pixels into panel (big-endian) byte order
+    void (*swap16_copy)(uint8_t* dst, const uint16_t* src, size_t count);
+
+    // Pack 24-bit R,G,B byte triples into RGB565
+    void (*rgb888_to_rgb565)(uint16_t* dst, const uint8_t* src, size_t count);
+
+    // Pack 0xAARRGGBB words into RGB565, alpha is ignored
+    void (*argb8888_to_rgb565)(uint16_t* dst, const uint32_t* src, size_t count);
+
+    // Blend src over dst with per-pixel 8-bit alpha
+    void (*blend_a8)(uint16_t* dst, const uint16_t* src, const uint8_t* alpha, size_t count);
+
+    // Blend 0xAARRGGBB words over dst using their own alpha
+    void (*blend_argb8888)(uint16_t* dst, const uint32_t* src, size_t count);
+
+    // Blend one color over dst with per-pixel 8-bit coverage
+    void (*blend_color_a8)(uint16_t* dst, uint16_t color, const uint8_t* alpha, size_t count);
+} pixel_kernels_t;
+
+// Blends are fixed point on the 5/6/5 channels: alpha 0..255 is widened to
+// a' = a + (a >> 7), 0..256, and each channel becomes
+// (src * a' + dst * (256 - a')) >> 8. Alpha 0 and 255 are exact and every
+// table produces the same bits as pixel_blend565.
+static inline uint16_t pixel_blend565(uint16_t dst, uint16_t src, uint32_t alpha) {
+    uint32_t a = alpha + (alpha >> 7);
+    uint32_t ia = 256 - a;
+    uint32_t r = ((src >> 11) * a + (dst >> 11) * ia) >> 8;
+    uint32_t g = (((src >> 5) & 0x3F) * a + ((dst >> 5) & 0x3F) * ia) >> 8;
+    uint32_t b = ((src & 0x1F) * a + (dst & 0x1F) * ia) >> 8;
+    return (uint16_t)(r << 11 | g << 5 | b);
+}
+
+// Best table for the running CPU, chosen once on first use
+const pixel_kernels_t* pixel_kernels_get(void);
+
+// Table for a specific ISA, or NULL if it was not built in or the CPU lacks it
+const pixel_kernels_t* pixel_kernels_for_isa(pixel_isa_t isa);
+
+// Rect helpers on top of the active table; strides are in pixels
+void pixel_fill_rect(uint16_t* dst, uint32_t stride, int width, int height, uint16_t color);
+void pixel_copy_rect(uint16_t* dst, uint32_t dst_stride, const uint16_t* src, uint32_t src_stride,
+                     int width, int height);
+void pixel_blend_rect_a8(uint16_t* dst, uint32_t dst_stride, const uint16_t* src, uint32_t src_stride,
+                         const uint8_t* alpha, uint32_t alpha_stride, int width, int height);
+void pixel_blend_rect_argb8888(uint16_t* dst, uint32_t dst_stride, const uint32_t* src, uint32_t src_stride,
+                               int width, int height);
+
+#endif // PIXEL_KERNELS_H
@@ -0,0 +1,40 @@
+#ifndef RASTER_H
+#define RASTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// RGB565 pixel buffer a primitive draws into; stride is in pixels
+typedef struct {
+    uint16_t* pixels;
+    int width;
+    int height;
+    int stride;
+} raster_target_t;
+
+// Inclusive box of the pixels a primitive touched, empty while x1 < x0
+typedef struct {
+    int x0, y0;
+    int x1, y1;
+} raster_bounds_t;
+
+void raster_bounds_init(raster_bounds_t* bounds);
+
+// Every primitive clips against the target once and writes horizontal or
+// vertical runs with the fill kernel; bounds grows to cover what was drawn.
+void raster_hspan(const raster_target_t* target, int x0, int x1, int y, uint16_t color, raster_bounds_t* bounds);
+void raster_vspan(const raster_target_t* target, int x, int y0, int y1, uint16_t color, raster_bounds_t* bounds);
+void raster_line(const raster_target_t* target, int x0, int y0, int x1, int y1, uint16_t color,
+                 raster_bounds_t* bounds);
+void raster_circle(const raster_target_t* target, int cx, int cy, int radius, uint16_t color,
+                   raster_bounds_t* bounds);
+void raster_fill_circle(const raster_target_t* target, int cx, int cy, int radius, uint16_t color,
+                        raster_bounds_t* bounds);
+void raster_fill_ellipse(const raster_target_t* target, int cx, int cy, int rx, int ry, uint16_t color,
+                         raster_bounds_t* bounds);
+void raster_fill_round_rect(const raster_target_t* target, int x, int y, int width, int height, int radius,
+                            uint16_t color, raster_bounds_t* bounds);
+void raster_fill_triangle(const raster_target_t* target, int x0, int y0, int x1, int y1, int x2, int y2,
+                          uint16_t color, raster_bounds_t* bounds);
+
+#endif // RASTER_H
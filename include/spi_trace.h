@@ -0,0 +1,73 @@
+#ifndef SPI_TRACE_H
+#define SPI_TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "ili9486l_driver.h"
+
+// Trace file layout, all multi-byte fixed fields little-endian:
+//
+//   header   "ILTR", u16 version, u16 flags, u32 spi_speed, u32 reserved
+//   record   u8 tag, varint ns since the previous record, then
+//     LINE     u8 pin, u8 value
+//     MESSAGE  varint count, then per transfer:
+//              u8 bits, u8 encoding (bit 7 = cs_change), varint speed_hz,
+//              varint length, payload
+//
+// Payloads are stored in wire order (16-bit words MSB first) so a trace
+// replays the same on any host. RAW payloads are length bytes, RLE
+// payloads are a varint size followed by (varint run, u8 hi, u8 lo)
+// pairs, ELIDED payloads are absent and replay as zeros.
+#define SPI_TRACE_MAGIC    "ILTR"
+#define SPI_TRACE_VERSION  1
+
+#define SPI_TRACE_TAG_LINE     1
+#define SPI_TRACE_TAG_MESSAGE  2
+
+#define SPI_TRACE_PAYLOAD_RAW     0
+#define SPI_TRACE_PAYLOAD_ELIDED  1
+#define SPI_TRACE_PAYLOAD_RLE     2
+#define SPI_TRACE_CS_CHANGE       0x80
+
+#define SPI_TRACE_ELIDE_MIN_BYTES  16       // Commands and parameters are always kept
+#define SPI_TRACE_MAX_TRANSFERS    256      // Per message, on replay
+#define SPI_TRACE_MAX_LENGTH       (1 << 24)
+
+// Replay flags
+#define SPI_TRACE_REPLAY_REALTIME  0x01  // Keep the recorded gaps between records
+
+typedef struct spi_trace {
+    FILE* file;
+    int flags;               // RPI_DISPLAY_TRACE_* recording options
+    uint64_t last_ns;
+    uint8_t* scratch;        // Payload encoding buffer
+    uint32_t scratch_size;
+    uint64_t records;
+    uint64_t bytes;          // Payload bytes seen on the bus
+    uint64_t bytes_written;  // Payload bytes that reached the file
+} spi_trace_t;
+
+typedef struct {
+    uint32_t spi_speed;      // From the trace header
+    uint64_t records;
+    uint64_t messages;
+    uint64_t transfers;
+    uint64_t line_writes;
+    uint64_t bytes;
+    uint64_t bytes_elided;
+    uint64_t trace_ns;       // Span of the recording
+    uint64_t replay_ns;      // Wall time of the replay
+} spi_trace_stats_t;
+
+// Recording
+spi_trace_t* spi_trace_open(const char* path, uint32_t spi_speed, int flags);
+void spi_trace_close(spi_trace_t* trace);
+int spi_trace_line(spi_trace_t* trace, int pin, int value);
+int spi_trace_message(spi_trace_t* trace, const struct spi_ioc_transfer* transfers, int count);
+
+// Feed a trace through the transport already opened on ctx
+int spi_trace_replay(ili9486l_ctx_t* ctx, const char* path, int flags, spi_trace_stats_t* stats);
+
+#endif // SPI_TRACE_H
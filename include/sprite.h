@@ -0,0 +1,52 @@
+#ifndef SPRITE_H
+#define SPRITE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "efficient_rpi_display.h"
+#include "raster.h"
+
+#define SPRITE_MAX  4
+
+// Cursor-like image kept out of the framebuffer. It is blended into the
+// flush source just before a refresh and the pixels it covered are put
+// back straight after, so drawing never has to work around it.
+typedef struct sprite {
+    uint16_t* pixels;
+    uint8_t* alpha;          // NULL for opaque sprites
+    uint16_t* save;          // Pixels under the sprite while it is applied
+    int width, height;
+    int hot_x, hot_y;        // Point of the sprite placed at (x, y)
+    int x, y;
+    bool visible;
+    int saved_x, saved_y;    // Screen rect held in save, saved_width 0 if none
+    int saved_width, saved_height;
+} sprite_t;
+
+// Sprites of one display, later ones on top
+typedef struct {
+    sprite_t* sprites[SPRITE_MAX];
+    int count;
+} sprite_set_t;
+
+// Copies the image; alpha may be NULL. Sprites start out hidden.
+sprite_t* sprite_create(const uint16_t* pixels, const uint8_t* alpha, int width, int height,
+                        int hot_x, int hot_y);
+void sprite_destroy(sprite_t* sprite);
+
+int sprite_set_add(sprite_set_t* set, sprite_t* sprite);
+void sprite_set_remove(sprite_set_t* set, sprite_t* sprite);
+
+// Screen rect a visible sprite covers, clipped to the screen. False if
+// it is hidden or entirely off screen.
+bool sprite_screen_rect(const sprite_t* sprite, int screen_width, int screen_height,
+                        int* x, int* y, int* width, int* height);
+
+// Blend the visible sprites into target, bottom first. With save set the
+// covered pixels are kept for sprite_set_restore, which must follow
+// before anything else touches target.
+void sprite_set_apply(sprite_set_t* set, const raster_target_t* target, bool save);
+void sprite_set_restore(sprite_set_t* set, const raster_target_t* target);
+
+#endif // SPRITE_H
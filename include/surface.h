@@ -0,0 +1,47 @@
+#ifndef SURFACE_H
+#define SURFACE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "efficient_rpi_display.h"
+#include "raster.h"
+
+// Rows start on a cache line: pixels are aligned to one and the stride
+// is rounded up to a whole number of them
+#define SURFACE_ALIGN           64
+#define SURFACE_STRIDE_PIXELS   (SURFACE_ALIGN / 2)
+#define SURFACE_MAX_SIDE        4096
+
+// Pool size classes: 1 KiB, then four steps per power of two up to 2 MiB
+// (1.25, 1.5, 1.75, 2 KiB, 2.5 KiB, ...), so at most 25% of a block is
+// slack. Bigger surfaces bypass the pool.
+#define SURFACE_POOL_MIN_SHIFT  10
+#define SURFACE_POOL_MAX_SHIFT  21
+#define SURFACE_POOL_STEPS      4
+#define SURFACE_POOL_CLASSES    ((SURFACE_POOL_MAX_SHIFT - SURFACE_POOL_MIN_SHIFT) * SURFACE_POOL_STEPS + 1)
+
+// Blocks up to this size are carved from shared arenas rather than
+// allocated one by one; arena blocks are recycled but never returned
+#define SURFACE_ARENA_SIZE       (256 * 1024)
+#define SURFACE_ARENA_MAX_BLOCK  (32 * 1024)
+
+// Offscreen RGB565 pixels. The header lives at the start of its pool
+// block with the pixels following on the next cache line.
+typedef struct surface {
+    raster_target_t target;
+    size_t block_size;       // Pool block holding header and pixels
+    int size_class;          // -1 when allocated outside the pool
+    struct layer* layer;     // Compositor layer drawing damages, NULL if none
+} surface_t;
+
+// Contents start out black. Process-wide, shared by every display.
+surface_t* surface_create(int width, int height);
+void surface_destroy(surface_t* surface);
+
+void surface_pool_get_stats(surface_pool_stats_t* stats);
+
+// Give cached blocks that did not come from an arena back to the system
+void surface_pool_trim(void);
+
+#endif // SURFACE_H
@@ -0,0 +1,49 @@
+#ifndef TEXT_RENDER_H
+#define TEXT_RENDER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "font.h"
+#include "raster.h"
+
+// Set-associative cache of glyph cells expanded to RGB565 for one
+// (font, glyph, fg, bg) combination, so opaque text is a row copy per
+// scan line of each cell. 512 cells, 64 KiB for the built-in font.
+#define GLYPH_CACHE_SET_BITS  7
+#define GLYPH_CACHE_SETS      (1 << GLYPH_CACHE_SET_BITS)
+#define GLYPH_CACHE_WAYS      4
+
+typedef struct {
+    uint32_t font_id;        // 0 while the entry is empty
+    uint32_t glyph;
+    uint32_t colors;         // fg << 16 | bg
+    uint32_t slot;           // Cell in the pixel store
+} glyph_cache_entry_t;
+
+// Each set keeps its ways in most-recently-used order
+typedef struct {
+    glyph_cache_entry_t entries[GLYPH_CACHE_SETS * GLYPH_CACHE_WAYS];
+    uint16_t* pixels;        // cell_pixels per slot
+    int cell_pixels;         // Grows with the largest cell seen, which flushes the cache
+    uint64_t hits;
+    uint64_t misses;
+} glyph_cache_t;
+
+void glyph_cache_init(glyph_cache_t* cache);
+void glyph_cache_destroy(glyph_cache_t* cache);
+
+// Expanded cell, width * height pixels; NULL if the store cannot grow
+const uint16_t* glyph_cache_get(glyph_cache_t* cache, const font_t* font, uint32_t glyph,
+                                uint16_t fg, uint16_t bg);
+
+// Draw one glyph cell with its top-left corner at (x, y), clipped to the
+// target. Transparent glyphs only touch set pixels; opaque glyphs fill the
+// whole cell from the cache, or bit by bit if it is out of memory.
+// Coverage fonts blend the color over the target, or fg over bg.
+void text_draw_glyph(const raster_target_t* target, const font_t* font, uint32_t glyph,
+                     int x, int y, uint16_t color);
+void text_draw_glyph_opaque(const raster_target_t* target, glyph_cache_t* cache, const font_t* font,
+                            uint32_t glyph, int x, int y, uint16_t fg, uint16_t bg);
+
+#endif // TEXT_RENDER_H
@@ -0,0 +1,61 @@
+#ifndef VIRTUAL_PANEL_H
+#define VIRTUAL_PANEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "ili9486l_driver.h"
+
+// Modelled gap between SPI messages: chip-select turnaround plus the
+// kernel round trip a spidev ioctl costs on a Pi
+#define VIRTUAL_PANEL_MESSAGE_GAP_NS  2000
+
+// Software model of an ILI9486 on the 4-wire SPI bus. It decodes the
+// command stream the driver sends into 320x480 GRAM, honouring the
+// address window, MADCTL and vertical scrolling, and clocks a virtual
+// bus so transfer cost can be measured without hardware.
+typedef struct {
+    uint16_t gram[DISPLAY_HEIGHT][DISPLAY_WIDTH];  // Native portrait order
+    
+    // Bus state
+    int dc;                 // Last DC level, 0 = command
+    uint8_t command;        // Command the following data belongs to
+    uint8_t params[8];
+    uint32_t param_count;
+    bool pixel_half;        // High byte of a pixel is pending
+    uint8_t pixel_high;
+    
+    // Controller registers
+    uint16_t col_start, col_end;
+    uint16_t page_start, page_end;
+    uint16_t col, page;     // RAMWR cursor
+    uint8_t madctl;
+    uint16_t scroll_tfa, scroll_vsa, scroll_bfa;
+    uint16_t scroll_start;
+    bool backlight;
+    
+    // Accounting
+    uint32_t spi_speed;
+    uint64_t bus_ns;
+    uint64_t messages;
+    uint64_t bytes;
+    uint64_t commands;
+    uint64_t pixels;
+} virtual_panel_t;
+
+virtual_panel_t* virtual_panel_create(uint32_t spi_speed);
+void virtual_panel_destroy(virtual_panel_t* panel);
+void virtual_panel_reset(virtual_panel_t* panel);
+
+// Feed bytes at the current DC level, as the panel would sample them
+void virtual_panel_set_dc(virtual_panel_t* panel, int dc);
+void virtual_panel_write(virtual_panel_t* panel, const uint8_t* data, size_t length);
+
+// What the glass shows, in the logical orientation MADCTL selects.
+// pixels holds width * height entries for that orientation.
+void virtual_panel_read_frame(const virtual_panel_t* panel, uint16_t* pixels);
+
+extern const ili9486l_transport_t virtual_panel_transport;
+
+#endif // VIRTUAL_PANEL_H
@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stdatomic.h>
 #include <pthread.h>
 #include "efficient_rpi_display.h"
 
@@ -16,6 +17,7 @@
 #define XPT2046_TEMP1       0x70  // Temperature 1
 #define XPT2046_VBAT        0x20  // Battery voltage
 #define XPT2046_VAUX        0x60  // Auxiliary voltage
+#define XPT2046_MODE_8BIT   0x08  // 8-bit conversion instead of 12
 
 // Touch GPIO pins
 #define GPIO_TOUCH_CS   7   // Touch chip select
@@ -25,9 +27,22 @@
 #define TOUCH_SPI_DEVICE     "/dev/spidev0.1"
 #define TOUCH_SPI_MODE       SPI_MODE_0
 #define TOUCH_SPI_SPEED      2000000  // 2MHz for touch controller
-#define TOUCH_SAMPLE_COUNT   5        // Number of samples for averaging
+#define TOUCH_SAMPLE_COUNT   3        // Samples per report while they agree
+#define TOUCH_OVERSAMPLE_COUNT 9      // Samples per report when they do not
+#define TOUCH_MAX_SAMPLES    16       // Upper bound for touch_config_t.samples
+#define TOUCH_SPREAD_THRESHOLD 24     // Raw X or Y spread that calls for more samples
 #define TOUCH_PRESSURE_THRESHOLD 400  // Minimum pressure for valid touch
 #define TOUCH_DEBOUNCE_TIME  50       // Debounce time in milliseconds
+#define TOUCH_REPORT_RATE    125      // Reports per second while pressed
+#define TOUCH_REPORT_RATE_MAX 1000
+#define TOUCH_RELEASE_REPORTS 2       // Reports without pressure that mean pen-up
+
+// One-euro smoothing of reported positions: the low-pass cutoff rises
+// from MIN_CUTOFF by BETA per raw unit per second of speed, so a still
+// pen is steady and a fast stroke does not lag
+#define TOUCH_FILTER_MIN_CUTOFF    1.0f   // Hz
+#define TOUCH_FILTER_BETA          0.02f
+#define TOUCH_FILTER_SLOPE_CUTOFF  5.0f   // Hz, for the speed estimate
 
 // Calibration constants (default values)
 #define TOUCH_CAL_X_MIN     200
@@ -35,13 +50,38 @@
 #define TOUCH_CAL_Y_MIN     200
 #define TOUCH_CAL_Y_MAX     3900
 
+// Pipelined sampling: every command byte is clocked out while the
+// previous result comes in, 16 clocks per conversion, plus one trailing
+// byte for the last result
+#define XPT2046_CHANNELS     4        // X, Y, Z1, Z2 per sample
+#define XPT2046_MESSAGE_MAX  (TOUCH_MAX_SAMPLES * XPT2046_CHANNELS * 2 + 1)
+
+// Event queue, a power of two. Moves stop being queued while fewer than
+// TOUCH_EVENT_RESERVE slots are free, so an up and the next down still fit.
+#define TOUCH_EVENT_QUEUE    64
+#define TOUCH_EVENT_RESERVE  2
+
+// Sampling thread state. Idle blocks on the PENIRQ edge alone; pressed
+// samples on a timer with PENIRQ masked, until pressure is gone.
+typedef enum {
+    TOUCH_STATE_IDLE,
+    TOUCH_STATE_PRESSED
+} touch_state_t;
+
+// Smoothing state of one axis
+typedef struct {
+    float value;             // Raw units
+    float slope;             // Raw units per second
+} touch_axis_filter_t;
+
 // Touch context structure
 typedef struct {
     // SPI interface
     int spi_fd;
     struct spi_ioc_transfer spi_tr;
     
-    // GPIO interface
+    // GPIO interface (line request fds when using the character device)
+    gpio_backend_t gpio_backend;
     int gpio_fd_cs;
     int gpio_fd_irq;
     
@@ -64,17 +104,42 @@ typedef struct {
     
     // Interrupt handling
     int epoll_fd;
+    int timer_fd;            // Report clock while pressed
+    int stop_fd;             // Wakes the thread for shutdown
     bool interrupt_enabled;
+    touch_state_t state;     // Owned by the touch thread
+    int release_count;       // Consecutive reports without pressure
     
     // Filtering
-    int16_t filter_x[TOUCH_SAMPLE_COUNT];
-    int16_t filter_y[TOUCH_SAMPLE_COUNT];
-    int filter_index;
+    touch_axis_filter_t filter_x;
+    touch_axis_filter_t filter_y;
+    uint64_t filter_time_ns;
     bool filter_initialized;
     
+    // Pipelined sampler, rebuilt when the configuration changes
+    uint8_t sample_tx[XPT2046_MESSAGE_MAX];
+    uint8_t sample_rx[XPT2046_MESSAGE_MAX];
+    int sample_count;        // Taken for every report
+    int sample_max;          // Total when the first ones spread too far
+    int sample_shift;        // Result position within a 16-bit reply
+    int sample_scale;        // Left shift bringing results to 12 bits
+    bool software_cs;
+    
+    // Event queue: the touch thread produces, rpi_touch_poll_events
+    // consumes. Indices run freely and are masked on access.
+    touch_event_t events[TOUCH_EVENT_QUEUE];
+    _Atomic uint32_t event_head;   // Next slot to write, owned by the touch thread
+    _Atomic uint32_t event_tail;   // Next slot to read, owned by the consumer
+    touch_event_t pending_move;    // Latest move held back by a full queue
+    bool move_pending;
+    int event_fd;                  // eventfd, readable while events are queued
+    
     // Performance tracking
     uint32_t touch_count;
     uint64_t last_touch_time;
+    touch_stats_t stats;
+    uint64_t rate_start_ns;  // Start of the current report-rate window
+    uint32_t rate_reports;
     
 } xpt2046_ctx_t;
 
@@ -93,12 +158,24 @@ int xpt2046_read_raw_y(xpt2046_ctx_t* ctx);
 int xpt2046_read_pressure(xpt2046_ctx_t* ctx);
 int xpt2046_read_channel(xpt2046_ctx_t* ctx, uint8_t channel);
 
+// Convert count samples (up to TOUCH_MAX_SAMPLES) with one SPI message.
+// Samples below the pressure threshold are dropped; returns how many are
+// left in x, y and pressure (which may be NULL), or -1 on SPI failure.
+int xpt2046_read_samples(xpt2046_ctx_t* ctx, int count, int16_t* x, int16_t* y, int16_t* pressure);
+void xpt2046_get_stats(xpt2046_ctx_t* ctx, touch_stats_t* stats);
+void xpt2046_reset_stats(xpt2046_ctx_t* ctx);
+
+// Copy out up to max queued events without locking; single consumer
+int xpt2046_poll_events(xpt2046_ctx_t* ctx, touch_event_t* events, int max);
+int xpt2046_wait_events(xpt2046_ctx_t* ctx, int timeout_ms);
+
 // Calibration functions
 void xpt2046_apply_calibration(xpt2046_ctx_t* ctx, int16_t raw_x, int16_t raw_y, int16_t* screen_x, int16_t* screen_y);
 void xpt2046_set_calibration(xpt2046_ctx_t* ctx, const touch_config_t* config);
 
 // Filtering functions
-void xpt2046_filter_touch(xpt2046_ctx_t* ctx, int16_t raw_x, int16_t raw_y, int16_t* filtered_x, int16_t* filtered_y);
+void xpt2046_filter_touch(xpt2046_ctx_t* ctx, int16_t raw_x, int16_t raw_y, uint64_t now_ns,
+                          int16_t* filtered_x, int16_t* filtered_y);
 void xpt2046_reset_filter(xpt2046_ctx_t* ctx);
 
 // Interrupt handling
@@ -0,0 +1,301 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "compositor.h"
+#include "pixel_kernels.h"
+
+// Static helper functions
+static void add_footprint(compositor_t* comp, const layer_t* layer);
+static void add_screen_rect(compositor_t* comp, damage_region_t* region, int x, int y, int width, int height);
+static void insert_layer(compositor_t* comp, layer_t* layer);
+static void remove_layer(compositor_t* comp, layer_t* layer);
+static bool covers(const layer_t* layer, int x, int y, int width, int height);
+static void compose_rect(compositor_t* comp, const raster_target_t* screen, int x, int y, int width, int height);
+static void compose_layer(const layer_t* layer, const raster_target_t* screen, int x, int y, int width, int height);
+
+void compositor_init(compositor_t* comp, uint32_t setup_cost) {
+    memset(comp, 0, sizeof(*comp));
+    comp->setup_cost = setup_cost;
+}
+
+void compositor_destroy(compositor_t* comp) {
+    for (int i = 0; i < comp->count; i++) {
+        surface_destroy(comp->layers[i]->surface);
+        free(comp->layers[i]);
+    }
+    
+    comp->count = 0;
+}
+
+layer_t* compositor_create_layer(compositor_t* comp, int x, int y, int width, int height, int z,
+                                 layer_mode_t mode) {
+    if (comp->count == COMPOSITOR_MAX_LAYERS) {
+        printf("Warning: Compositor is full (%d layers)\n", COMPOSITOR_MAX_LAYERS);
+        return NULL;
+    }
+    
+    layer_t* layer = calloc(1, sizeof(layer_t));
+    if (!layer) {
+        perror("Failed to allocate layer");
+        return NULL;
+    }
+    
+    layer->surface = surface_create(width, height);
+    if (!layer->surface) {
+        free(layer);
+        return NULL;
+    }
+    
+    layer->surface->layer = layer;
+    layer->x = x;
+    layer->y = y;
+    layer->z = z;
+    layer->mode = mode;
+    layer->visible = true;
+    layer->opacity = 255;
+    layer->key = RPI_LAYER_DEFAULT_KEY;
+    
+    // Keyed layers start out see-through rather than black
+    if (mode == LAYER_KEYED) {
+        const raster_target_t* target = &layer->surface->target;
+        pixel_fill_rect(target->pixels, target->stride, target->width, target->height, layer->key);
+    }
+    
+    insert_layer(comp, layer);
+    add_footprint(comp, layer);
+    
+    return layer;
+}
+
+void compositor_destroy_layer(compositor_t* comp, layer_t* layer) {
+    add_footprint(comp, layer);
+    remove_layer(comp, layer);
+    
+    surface_destroy(layer->surface);
+    free(layer);
+}
+
+void compositor_move_layer(compositor_t* comp, layer_t* layer, int x, int y) {
+    if (layer->x == x && layer->y == y) return;
+    
+    add_footprint(comp, layer);
+    layer->x = x;
+    layer->y = y;
+    add_footprint(comp, layer);
+}
+
+void compositor_set_visible(compositor_t* comp, layer_t* layer, bool visible) {
+    if (layer->visible == visible) return;
+    
+    // Either way the footprint changes; add it while the layer is visible
+    if (layer->visible) add_footprint(comp, layer);
+    layer->visible = visible;
+    if (layer->visible) add_footprint(comp, layer);
+}
+
+void compositor_set_opacity(compositor_t* comp, layer_t* layer, uint8_t opacity) {
+    if (layer->opacity == opacity) return;
+    
+    layer->opacity = opacity;
+    add_footprint(comp, layer);
+}
+
+void compositor_set_key(compositor_t* comp, layer_t* layer, uint16_t key) {
+    if (layer->key == key) return;
+    
+    layer->key = key;
+    if (layer->mode == LAYER_KEYED) add_footprint(comp, layer);
+}
+
+void compositor_set_z(compositor_t* comp, layer_t* layer, int z) {
+    if (layer->z == z) return;
+    
+    remove_layer(comp, layer);
+    layer->z = z;
+    insert_layer(comp, layer);
+    add_footprint(comp, layer);
+}
+
+void compositor_set_background(compositor_t* comp, uint16_t color) {
+    if (comp->background == color) return;
+    
+    // Only the uncovered parts show it, but finding them costs more than
+    // one recompose of the screen
+    comp->background = color;
+    add_screen_rect(comp, &comp->pending, 0, 0, comp->width, comp->height);
+}
+
+void compositor_damage_layer(compositor_t* comp, layer_t* layer, int x, int y, int width, int height) {
+    const raster_target_t* target = &layer->surface->target;
+    
+    if (x < 0) { width += x; x = 0; }
+    if (y < 0) { height += y; y = 0; }
+    if (x + width > target->width) width = target->width - x;
+    if (y + height > target->height) height = target->height - y;
+    
+    damage_region_add(&layer->damage, x, y, width, height, comp->setup_cost);
+}
+
+uint64_t compositor_compose(compositor_t* comp, const raster_target_t* screen, bool swapped,
+                            damage_region_t* composed) {
+    damage_region_t region = comp->pending;
+    
+    comp->pending.count = 0;
+    
+    // First compose, or the screen was rotated: everything is stale
+    if (screen->width != comp->width || screen->height != comp->height) {
+        comp->width = screen->width;
+        comp->height = screen->height;
+        region.count = 0;
+        add_screen_rect(comp, &region, 0, 0, comp->width, comp->height);
+    }
+    
+    for (int i = 0; i < comp->count; i++) {
+        layer_t* layer = comp->layers[i];
+        
+        if (layer->visible) {
+            for (int r = 0; r < layer->damage.count; r++) {
+                const damage_rect_t* rect = &layer->damage.rects[r];
+                add_screen_rect(comp, &region, layer->x + rect->x, layer->y + rect->y, rect->width, rect->height);
+            }
+        }
+        
+        layer->damage.count = 0;
+    }
+    
+    damage_region_t current = region;
+    
+    if (swapped) {
+        for (int i = 0; i < comp->previous.count; i++) {
+            const damage_rect_t* rect = &comp->previous.rects[i];
+            damage_region_add(&region, rect->x, rect->y, rect->width, rect->height, comp->setup_cost);
+        }
+    }
+    
+    comp->previous = current;
+    
+    uint64_t pixels = 0;
+    
+    for (int i = 0; i < region.count; i++) {
+        const damage_rect_t* rect = &region.rects[i];
+        
+        compose_rect(comp, screen, rect->x, rect->y, rect->width, rect->height);
+        damage_region_add(composed, rect->x, rect->y, rect->width, rect->height, comp->setup_cost);
+        pixels += (uint64_t)rect->width * rect->height;
+    }
+    
+    return pixels;
+}
+
+// Queue the screen area a visible layer covers
+static void add_footprint(compositor_t* comp, const layer_t* layer) {
+    if (!layer->visible) return;
+    
+    add_screen_rect(comp, &comp->pending, layer->x, layer->y,
+                    layer->surface->target.width, layer->surface->target.height);
+}
+
+// Screen rects are clipped before they go in, so they fit damage_rect_t
+static void add_screen_rect(compositor_t* comp, damage_region_t* region, int x, int y, int width, int height) {
+    if (x < 0) { width += x; x = 0; }
+    if (y < 0) { height += y; y = 0; }
+    if (x + width > comp->width) width = comp->width - x;
+    if (y + height > comp->height) height = comp->height - y;
+    
+    damage_region_add(region, x, y, width, height, comp->setup_cost);
+}
+
+static void insert_layer(compositor_t* comp, layer_t* layer) {
+    int pos = comp->count;
+    
+    while (pos > 0 && comp->layers[pos - 1]->z > layer->z) {
+        comp->layers[pos] = comp->layers[pos - 1];
+        pos--;
+    }
+    
+    comp->layers[pos] = layer;
+    comp->count++;
+}
+
+static void remove_layer(compositor_t* comp, layer_t* layer) {
+    for (int i = 0; i < comp->count; i++) {
+        if (comp->layers[i] == layer) {
+            memmove(&comp->layers[i], &comp->layers[i + 1], (comp->count - i - 1) * sizeof(layer_t*));
+            comp->count--;
+            return;
+        }
+    }
+}
+
+// True if the layer hides everything below it inside the rect
+static bool covers(const layer_t* layer, int x, int y, int width, int height) {
+    return layer->visible && layer->mode == LAYER_OPAQUE && layer->opacity == 255 &&
+           layer->x <= x && layer->y <= y &&
+           layer->x + layer->surface->target.width >= x + width &&
+           layer->y + layer->surface->target.height >= y + height;
+}
+
+static void compose_rect(compositor_t* comp, const raster_target_t* screen, int x, int y, int width, int height) {
+    // Start from the topmost layer that hides the rest, if any
+    int first = comp->count - 1;
+    while (first >= 0 && !covers(comp->layers[first], x, y, width, height)) {
+        first--;
+    }
+    
+    if (first < 0) {
+        pixel_fill_rect(&screen->pixels[y * screen->stride + x], screen->stride, width, height, comp->background);
+        first = 0;
+    }
+    
+    for (int i = first; i < comp->count; i++) {
+        const layer_t* layer = comp->layers[i];
+        if (!layer->visible || layer->opacity == 0) continue;
+        
+        // Intersect with the layer's footprint
+        int x0 = x > layer->x ? x : layer->x;
+        int y0 = y > layer->y ? y : layer->y;
+        int x1 = x + width < layer->x + layer->surface->target.width ?
+                 x + width : layer->x + layer->surface->target.width;
+        int y1 = y + height < layer->y + layer->surface->target.height ?
+                 y + height : layer->y + layer->surface->target.height;
+        
+        if (x1 > x0 && y1 > y0) {
+            compose_layer(layer, screen, x0, y0, x1 - x0, y1 - y0);
+        }
+    }
+}
+
+// Draw the part of a layer over screen rect (x, y), already inside its footprint
+static void compose_layer(const layer_t* layer, const raster_target_t* screen, int x, int y, int width, int height) {
+    const raster_target_t* src = &layer->surface->target;
+    const uint16_t* in = &src->pixels[(y - layer->y) * src->stride + (x - layer->x)];
+    uint16_t* out = &screen->pixels[y * screen->stride + x];
+    
+    if (layer->mode == LAYER_OPAQUE && layer->opacity == 255) {
+        pixel_copy_rect(out, screen->stride, in, src->stride, width, height);
+        return;
+    }
+    
+    const pixel_kernels_t* kernels = pixel_kernels_get();
+    uint8_t alpha[COMPOSITOR_SPAN];
+    
+    if (layer->mode == LAYER_OPAQUE) {
+        memset(alpha, layer->opacity, sizeof(alpha));
+    }
+    
+    for (int row = 0; row < height; row++) {
+        for (int col = 0; col < width; col += COMPOSITOR_SPAN) {
+            int count = width - col < COMPOSITOR_SPAN ? width - col : COMPOSITOR_SPAN;
+            const uint16_t* span = &in[row * src->stride + col];
+            
+            if (layer->mode == LAYER_KEYED) {
+                for (int i = 0; i < count; i++) {
+                    alpha[i] = span[i] == layer->key ? 0 : layer->opacity;
+                }
+            }
+            
+            kernels->blend_a8(&out[row * screen->stride + col], span, alpha, count);
+        }
+    }
+}
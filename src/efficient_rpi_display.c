@@ -3,82 +3,121 @@
 #include <string.h>
 #include <unistd.h>
 #include <math.h>
+#include <time.h>
+#include <errno.h>
 #include <pthread.h>
 
 #include "efficient_rpi_display.h"
 #include "display_context.h"
 #include "ili9486l_driver.h"
 #include "xpt2046_touch.h"
+#include "pixel_kernels.h"
+#include "raster.h"
+#include "font.h"
+#include "text_render.h"
+#include "surface.h"
+#include "compositor.h"
+#include "sprite.h"
 
-// Font data for text rendering (8x8 bitmap font)
-static const uint8_t font_8x8[128][8] = {
-    // ASCII 32-127 (basic printable characters)
-    // This is a simplified font - in a real implementation, you'd include a complete font
-    [32] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // Space
-    [33] = {0x18, 0x3C, 0x3C, 0x18, 0x18, 0x00, 0x18, 0x00}, // !
-    [34] = {0x36, 0x36, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // "
-    [35] = {0x36, 0x36, 0x7F, 0x36, 0x7F, 0x36, 0x36, 0x00}, // #
-    [36] = {0x0C, 0x3E, 0x03, 0x1E, 0x30, 0x1F, 0x0C, 0x00}, // $
-    [37] = {0x00, 0x63, 0x33, 0x18, 0x0C, 0x66, 0x63, 0x00}, // %
-    [38] = {0x1C, 0x36, 0x1C, 0x6E, 0x3B, 0x33, 0x6E, 0x00}, // &
-    [39] = {0x06, 0x06, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00}, // '
-    [40] = {0x18, 0x0C, 0x06, 0x06, 0x06, 0x0C, 0x18, 0x00}, // (
-    [41] = {0x06, 0x0C, 0x18, 0x18, 0x18, 0x0C, 0x06, 0x00}, // )
-    [42] = {0x00, 0x66, 0x3C, 0xFF, 0x3C, 0x66, 0x00, 0x00}, // *
-    [43] = {0x00, 0x0C, 0x0C, 0x3F, 0x0C, 0x0C, 0x00, 0x00}, // +
-    [44] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x06, 0x00}, // ,
-    [45] = {0x00, 0x00, 0x00, 0x3F, 0x00, 0x00, 0x00, 0x00}, // -
-    [46] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x00}, // .
-    [47] = {0x60, 0x30, 0x18, 0x0C, 0x06, 0x03, 0x01, 0x00}, // /
-    [48] = {0x3E, 0x63, 0x73, 0x7B, 0x6F, 0x67, 0x3E, 0x00}, // 0
-    [49] = {0x0C, 0x0E, 0x0C, 0x0C, 0x0C, 0x0C, 0x3F, 0x00}, // 1
-    [50] = {0x1E, 0x33, 0x30, 0x1C, 0x06, 0x33, 0x3F, 0x00}, // 2
-    [51] = {0x1E, 0x33, 0x30, 0x1C, 0x30, 0x33, 0x1E, 0x00}, // 3
-    [52] = {0x38, 0x3C, 0x36, 0x33, 0x7F, 0x30, 0x78, 0x00}, // 4
-    [53] = {0x3F, 0x03, 0x1F, 0x30, 0x30, 0x33, 0x1E, 0x00}, // 5
-    [54] = {0x1C, 0x06, 0x03, 0x1F, 0x33, 0x33, 0x1E, 0x00}, // 6
-    [55] = {0x3F, 0x33, 0x30, 0x18, 0x0C, 0x0C, 0x0C, 0x00}, // 7
-    [56] = {0x1E, 0x33, 0x33, 0x1E, 0x33, 0x33, 0x1E, 0x00}, // 8
-    [57] = {0x1E, 0x33, 0x33, 0x3E, 0x30, 0x18, 0x0E, 0x00}, // 9
-    [58] = {0x00, 0x0C, 0x0C, 0x00, 0x00, 0x0C, 0x0C, 0x00}, // :
-    [59] = {0x00, 0x0C, 0x0C, 0x00, 0x00, 0x0C, 0x06, 0x00}, // ;
-    [60] = {0x18, 0x0C, 0x06, 0x03, 0x06, 0x0C, 0x18, 0x00}, // <
-    [61] = {0x00, 0x00, 0x3F, 0x00, 0x00, 0x3F, 0x00, 0x00}, // =
-    [62] = {0x06, 0x0C, 0x18, 0x30, 0x18, 0x0C, 0x06, 0x00}, // >
-    [63] = {0x1E, 0x33, 0x30, 0x18, 0x0C, 0x00, 0x0C, 0x00}, // ?
-    [64] = {0x3E, 0x63, 0x7B, 0x7B, 0x7B, 0x03, 0x1E, 0x00}, // @
-    [65] = {0x0C, 0x1E, 0x33, 0x33, 0x3F, 0x33, 0x33, 0x00}, // A
-    [66] = {0x3F, 0x66, 0x66, 0x3E, 0x66, 0x66, 0x3F, 0x00}, // B
-    [67] = {0x3C, 0x66, 0x03, 0x03, 0x03, 0x66, 0x3C, 0x00}, // C
-    [68] = {0x1F, 0x36, 0x66, 0x66, 0x66, 0x36, 0x1F, 0x00}, // D
-    [69] = {0x7F, 0x46, 0x16, 0x1E, 0x16, 0x46, 0x7F, 0x00}, // E
-    [70] = {0x7F, 0x46, 0x16, 0x1E, 0x16, 0x06, 0x0F, 0x00}, // F
-    [71] = {0x3C, 0x66, 0x03, 0x03, 0x73, 0x66, 0x7C, 0x00}, // G
-    [72] = {0x33, 0x33, 0x33, 0x3F, 0x33, 0x33, 0x33, 0x00}, // H
-    [73] = {0x1E, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00}, // I
-    [74] = {0x78, 0x30, 0x30, 0x30, 0x33, 0x33, 0x1E, 0x00}, // J
-    [75] = {0x67, 0x66, 0x36, 0x1E, 0x36, 0x66, 0x67, 0x00}, // K
-    [76] = {0x0F, 0x06, 0x06, 0x06, 0x46, 0x66, 0x7F, 0x00}, // L
-    [77] = {0x63, 0x77, 0x7F, 0x7F, 0x6B, 0x63, 0x63, 0x00}, // M
-    [78] = {0x63, 0x67, 0x6F, 0x7B, 0x73, 0x63, 0x63, 0x00}, // N
-    [79] = {0x1C, 0x36, 0x63, 0x63, 0x63, 0x36, 0x1C, 0x00}, // O
-    [80] = {0x3F, 0x66, 0x66, 0x3E, 0x06, 0x06, 0x0F, 0x00}, // P
-    [81] = {0x1E, 0x33, 0x33, 0x33, 0x3B, 0x1E, 0x38, 0x00}, // Q
-    [82] = {0x3F, 0x66, 0x66, 0x3E, 0x36, 0x66, 0x67, 0x00}, // R
-    [83] = {0x1E, 0x33, 0x07, 0x0E, 0x38, 0x33, 0x1E, 0x00}, // S
-    [84] = {0x3F, 0x2D, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00}, // T
-    [85] = {0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x3F, 0x00}, // U
-    [86] = {0x33, 0x33, 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x00}, // V
-    [87] = {0x63, 0x63, 0x63, 0x6B, 0x7F, 0x77, 0x63, 0x00}, // W
-    [88] = {0x63, 0x63, 0x36, 0x1C, 0x1C, 0x36, 0x63, 0x00}, // X
-    [89] = {0x33, 0x33, 0x33, 0x1E, 0x0C, 0x0C, 0x1E, 0x00}, // Y
-    [90] = {0x7F, 0x63, 0x31, 0x18, 0x4C, 0x66, 0x7F, 0x00}, // Z
-    // Add more characters as needed...
-};
+// Context whose frame this thread holds open (rpi_display_begin_frame)
+static __thread rpi_display_ctx_t* frame_ctx;
 
 // Internal helper functions
-static void draw_character(display_handle_t display, int x, int y, char c, uint16_t color);
+static bool frame_open(rpi_display_ctx_t* ctx);
+static void context_lock(rpi_display_ctx_t* ctx);
+static void context_unlock(rpi_display_ctx_t* ctx);
+static void mark_dirty(rpi_display_ctx_t* ctx, int x, int y, int width, int height);
+static void mark_dirty_clipped(rpi_display_ctx_t* ctx, int x0, int y0, int x1, int y1);
+static void mark_dirty_bounds(rpi_display_ctx_t* ctx, const raster_bounds_t* bounds);
+static void screen_target(rpi_display_ctx_t* ctx, raster_target_t* target);
+static void draw_target(rpi_display_ctx_t* ctx, raster_target_t* target);
+static bool clip_to_target(const raster_target_t* target, int* x, int* y, int* width, int* height,
+                           int* skip_x, int* skip_y);
+static void compose_layers(rpi_display_ctx_t* ctx, bool swapped);
+static void mark_sprite(rpi_display_ctx_t* ctx, const sprite_t* sprite);
+static void mark_dirty_bounds(rpi_display_ctx_t* ctx, const raster_bounds_t* bounds) {
+    if (bounds->x1 < bounds->x0) return;
+    
+    mark_dirty(ctx, bounds->x0, bounds->y0, bounds->x1 - bounds->x0 + 1, bounds->y1 - bounds->y0 + 1);
+}
+
+// Recomposite damaged layers into the screen buffer ahead of a flush.
+// Does nothing until the first layer is created.
+static void compose_layers(rpi_display_ctx_t* ctx, bool swapped) {
+    compositor_t* comp = &ctx->compositor;
+    if (comp->count == 0 && comp->width == 0) return;
+    
+    raster_target_t screen;
+    damage_region_t composed = { .count = 0 };
+    
+    screen_target(ctx, &screen);
+    uint64_t pixels = compositor_compose(comp, &screen, swapped, &composed);
+    
+    for (int i = 0; i < composed.count; i++) {
+        const damage_rect_t* rect = &composed.rects[i];
+        mark_dirty_rect(&ctx->display, rect->x, rect->y, rect->width, rect->height);
+    }
+    
+    ctx->display.stats.pixels_composed += pixels;
+    ctx->display.stats.last_frame_pixels_composed = pixels;
+}
+
+// Damage the screen rect a visible sprite covers
+static void mark_sprite(rpi_display_ctx_t* ctx, const sprite_t* sprite) {
+    int x, y, width, height;
+    
+    if (sprite_screen_rect(sprite, ctx->display.width, ctx->display.height, &x, &y, &width, &height)) {
+        mark_dirty_rect(&ctx->display, x, y, width, height);
+    }
+}
+
+// The buffer the panel is refreshed from
+static void screen_target(rpi_display_ctx_t* ctx, raster_target_t* target) {
+    target->pixels = ctx->display.double_buffer_enabled ? 
+                     ctx->display.backbuffer : ctx->display.framebuffer;
+    target->width = ctx->display.width;
+    target->height = ctx->display.height;
+    target->stride = ctx->display.width;
+}
+
+// The buffer drawing calls write to: the screen or a surface
+static void draw_target(rpi_display_ctx_t* ctx, raster_target_t* target) {
+    if (ctx->target) {
+        *target = ctx->target->target;
+        return;
+    }
+    
+    screen_target(ctx, target);
+}
+
+// Clip a width x height rect at (x, y) to the target. skip_x and skip_y
+// get how far into the source the visible part starts. False if nothing
+// is left.
+static bool clip_to_target(const raster_target_t* target, int* x, int* y, int* width, int* height,
+                           int* skip_x, int* skip_y) {
+    *skip_x = *x < 0 ? -*x : 0;
+    *skip_y = *y < 0 ? -*y : 0;
+    *width -= *skip_x;
+    *height -= *skip_y;
+    *x += *skip_x;
+    *y += *skip_y;
+    
+    if (*x + *width > target->width) *width = target->width - *x;
+    if (*y + *height > target->height) *height = target->height - *y;
+    
+    return *width > 0 && *height > 0;
+}
+
+static void draw_text(rpi_display_ctx_t* ctx, const font_t* font, bool utf8, int x, int y, const char* text,
+                      uint16_t fg, uint16_t bg, bool opaque);
+static int blend_buffer(display_handle_t display, const void* pixels, const uint8_t* alpha,
+                        int x, int y, int width, int height);
 static void swap_buffers(rpi_display_ctx_t* ctx);
+static void copy_region(uint16_t* dst, const uint16_t* src, int stride, const damage_region_t* region);
+static void free_staging(rpi_display_ctx_t* ctx);
+static int async_flush_start(rpi_display_ctx_t* ctx);
+static void async_flush_stop(rpi_display_ctx_t* ctx);
+static void* flush_thread_main(void* arg);
 
 // Display API implementation
 display_handle_t rpi_display_init(const display_config_t* config) {
@@ -88,6 +127,7 @@ display_handle_t rpi_display_init(const display_config_t* config) {
     }
     
     memset(ctx, 0, sizeof(*ctx));
+    glyph_cache_init(&ctx->glyph_cache);
     
     // Initialize default configuration if none provided
     if (config) {
@@ -100,21 +140,49 @@ display_handle_t rpi_display_init(const display_config_t* config) {
         ctx->config.enable_dma = true;
         ctx->config.enable_double_buffer = true;
         ctx->config.refresh_rate = 60;
+        ctx->config.gpio_backend = GPIO_BACKEND_AUTO;
     }
     
-    // Initialize mutex
+    // Initialize mutexes
     if (pthread_mutex_init(&ctx->context_mutex, NULL) != 0) {
         free(ctx);
         return NULL;
     }
     
+    if (pthread_mutex_init(&ctx->transport_mutex, NULL) != 0) {
+        pthread_mutex_destroy(&ctx->context_mutex);
+        free(ctx);
+        return NULL;
+    }
+    
     // Initialize display driver
     if (ili9486l_init(&ctx->display, &ctx->config) != RPI_DISPLAY_OK) {
+        pthread_mutex_destroy(&ctx->transport_mutex);
         pthread_mutex_destroy(&ctx->context_mutex);
         free(ctx);
         return NULL;
     }
     
+    compositor_init(&ctx->compositor, ctx->display.damage_setup_cost);
+    
+    // RPI_DISPLAY_TRACE=<file> records the session for offline replay
+    const char* trace_path = getenv("RPI_DISPLAY_TRACE");
+    if (trace_path && ili9486l_trace_start(&ctx->display, trace_path, RPI_DISPLAY_TRACE_COMPRESS) != RPI_DISPLAY_OK) {
+        printf("Warning: Could not record SPI trace to %s\n", trace_path);
+    }
+    
+    // Start the flush thread if asynchronous refresh was requested
+    if (ctx->config.enable_async_flush && async_flush_start(ctx) < 0) {
+        printf("Warning: Async flush unavailable, refreshing synchronously\n");
+    }
+    
+    // The virtual panel has no touch controller behind it
+    if (ctx->config.transport == DISPLAY_TRANSPORT_VIRTUAL) {
+        ctx->touch_enabled = false;
+        ctx->initialized = true;
+        return (display_handle_t)ctx;
+    }
+    
     // Initialize touch driver
     touch_config_t touch_config = {
         .cal_x_min = TOUCH_CAL_X_MIN,
@@ -123,7 +191,8 @@ display_handle_t rpi_display_init(const display_config_t* config) {
         .cal_y_max = TOUCH_CAL_Y_MAX,
         .swap_xy = false,
         .invert_x = false,
-        .invert_y = false
+        .invert_y = false,
+        .gpio_backend = ctx->config.gpio_backend
     };
     
     if (xpt2046_init(&ctx->touch, &touch_config) == RPI_DISPLAY_OK) {
@@ -143,16 +212,32 @@ void rpi_display_destroy(display_handle_t display) {
     
     rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
     
+    // Release a frame this thread left open
+    if (frame_open(ctx)) {
+        rpi_display_end_frame(display);
+    }
+    
     if (ctx->initialized) {
         // Destroy touch driver
         if (ctx->touch_enabled) {
             xpt2046_destroy(&ctx->touch);
         }
         
+        // Drain queued frames before the driver goes away
+        async_flush_stop(ctx);
+        
         // Destroy display driver
         ili9486l_destroy(&ctx->display);
         
-        // Destroy mutex
+        glyph_cache_destroy(&ctx->glyph_cache);
+        compositor_destroy(&ctx->compositor);
+        
+        for (int i = 0; i < ctx->sprites.count; i++) {
+            sprite_destroy(ctx->sprites.sprites[i]);
+        }
+        
+        // Destroy mutexes
+        pthread_mutex_destroy(&ctx->transport_mutex);
         pthread_mutex_destroy(&ctx->context_mutex);
         
         ctx->initialized = false;
@@ -166,9 +251,16 @@ int rpi_display_set_rotation(display_handle_t display, display_rotation_t rotati
     
     rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
     
+    if (frame_open(ctx)) return RPI_DISPLAY_ERROR_INVALID;
+    
+    // Queued snapshots use the current stride
+    rpi_display_wait_frame(display, 0, -1);
+    
     pthread_mutex_lock(&ctx->context_mutex);
+    pthread_mutex_lock(&ctx->transport_mutex);
     int result = ili9486l_set_rotation(&ctx->display, rotation);
     ctx->config.rotation = rotation;
+    pthread_mutex_unlock(&ctx->transport_mutex);
     pthread_mutex_unlock(&ctx->context_mutex);
     
     return result;
@@ -188,26 +280,120 @@ int rpi_display_get_height(display_handle_t display) {
     return ctx->display.height;
 }
 
+gpio_backend_t rpi_display_get_gpio_backend(display_handle_t display) {
+    if (!display) return GPIO_BACKEND_AUTO;
+    
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    return ctx->display.gpio_backend;
+}
+
+int rpi_display_get_stats(display_handle_t display, display_stats_t* stats) {
+    if (!display || !stats) return RPI_DISPLAY_ERROR_INVALID;
+    
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    
+    context_lock(ctx);
+    pthread_mutex_lock(&ctx->transport_mutex);
+    *stats = ctx->display.stats;
+    pthread_mutex_unlock(&ctx->transport_mutex);
+    context_unlock(ctx);
+    
+    return RPI_DISPLAY_OK;
+}
+
+void rpi_display_reset_stats(display_handle_t display) {
+    if (!display) return;
+    
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    
+    context_lock(ctx);
+    pthread_mutex_lock(&ctx->transport_mutex);
+    memset(&ctx->display.stats, 0, sizeof(ctx->display.stats));
+    pthread_mutex_unlock(&ctx->transport_mutex);
+    context_unlock(ctx);
+}
+
+int rpi_display_read_panel(display_handle_t display, uint16_t* buffer) {
+    if (!display || !buffer) return RPI_DISPLAY_ERROR_INVALID;
+    
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    
+    pthread_mutex_lock(&ctx->transport_mutex);
+    int result = ili9486l_read_frame(&ctx->display, buffer);
+    pthread_mutex_unlock(&ctx->transport_mutex);
+    
+    return result;
+}
+
+int rpi_display_trace_start(display_handle_t display, const char* path, int flags) {
+    if (!display || !path) return RPI_DISPLAY_ERROR_INVALID;
+    
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    
+    pthread_mutex_lock(&ctx->transport_mutex);
+    int result = ili9486l_trace_start(&ctx->display, path, flags);
+    pthread_mutex_unlock(&ctx->transport_mutex);
+    
+    return result;
+}
+
+int rpi_display_trace_stop(display_handle_t display) {
+    if (!display) return RPI_DISPLAY_ERROR_INVALID;
+    
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    
+    pthread_mutex_lock(&ctx->transport_mutex);
+    ili9486l_trace_stop(&ctx->display);
+    pthread_mutex_unlock(&ctx->transport_mutex);
+    
+    return RPI_DISPLAY_OK;
+}
+
+// Frame batching
+int rpi_display_begin_frame(display_handle_t display) {
+    if (!display) return RPI_DISPLAY_ERROR_INVALID;
+    
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    
+    // Frames don't nest, and a thread holds at most one at a time
+    if (frame_ctx) return RPI_DISPLAY_ERROR_INVALID;
+    
+    pthread_mutex_lock(&ctx->context_mutex);
+    frame_ctx = ctx;
+    
+    return RPI_DISPLAY_OK;
+}
+
+int rpi_display_end_frame(display_handle_t display) {
+    if (!display) return RPI_DISPLAY_ERROR_INVALID;
+    
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    
+    if (frame_ctx != ctx) return RPI_DISPLAY_ERROR_INVALID;
+    
+    frame_ctx = NULL;
+    pthread_mutex_unlock(&ctx->context_mutex);
+    
+    return RPI_DISPLAY_OK;
+}
+
 // Drawing functions
 int rpi_display_clear(display_handle_t display, uint16_t color) {
     if (!display) return RPI_DISPLAY_ERROR_INVALID;
     
     rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
     
-    pthread_mutex_lock(&ctx->context_mutex);
+    raster_target_t target;
     
-    uint16_t* buffer = ctx->display.double_buffer_enabled ? 
-                      ctx->display.backbuffer : ctx->display.framebuffer;
+    context_lock(ctx);
     
-    uint32_t pixel_count = ctx->display.width * ctx->display.height;
-    for (uint32_t i = 0; i < pixel_count; i++) {
-        buffer[i] = color;
-    }
+    draw_target(ctx, &target);
+    pixel_fill_rect(target.pixels, target.stride, target.width, target.height, color);
     
     // Mark entire screen as dirty
-    mark_dirty_rect(&ctx->display, 0, 0, ctx->display.width, ctx->display.height);
+    mark_dirty(ctx, 0, 0, target.width, target.height);
     
-    pthread_mutex_unlock(&ctx->context_mutex);
+    context_unlock(ctx);
     
     return RPI_DISPLAY_OK;
 }
@@ -216,22 +402,23 @@ int rpi_display_set_pixel(display_handle_t display, int x, int y, uint16_t color
     if (!display) return RPI_DISPLAY_ERROR_INVALID;
     
     rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    raster_target_t target;
     
-    if (x < 0 || x >= ctx->display.width || y < 0 || y >= ctx->display.height) {
-        return RPI_DISPLAY_ERROR_INVALID;
-    }
+    context_lock(ctx);
     
-    pthread_mutex_lock(&ctx->context_mutex);
+    draw_target(ctx, &target);
     
-    uint16_t* buffer = ctx->display.double_buffer_enabled ? 
-                      ctx->display.backbuffer : ctx->display.framebuffer;
+    if (x < 0 || x >= target.width || y < 0 || y >= target.height) {
+        context_unlock(ctx);
+        return RPI_DISPLAY_ERROR_INVALID;
+    }
     
-    buffer[y * ctx->display.width + x] = color;
+    target.pixels[y * target.stride + x] = color;
     
     // Mark pixel as dirty
-    mark_dirty_rect(&ctx->display, x, y, 1, 1);
+    mark_dirty(ctx, x, y, 1, 1);
     
-    pthread_mutex_unlock(&ctx->context_mutex);
+    context_unlock(ctx);
     
     return RPI_DISPLAY_OK;
 }
@@ -240,19 +427,18 @@ uint16_t rpi_display_get_pixel(display_handle_t display, int x, int y) {
     if (!display) return 0;
     
     rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    raster_target_t target;
+    uint16_t pixel = 0;
     
-    if (x < 0 || x >= ctx->display.width || y < 0 || y >= ctx->display.height) {
-        return 0;
-    }
-    
-    pthread_mutex_lock(&ctx->context_mutex);
+    context_lock(ctx);
     
-    uint16_t* buffer = ctx->display.double_buffer_enabled ? 
-                      ctx->display.backbuffer : ctx->display.framebuffer;
+    draw_target(ctx, &target);
     
-    uint16_t pixel = buffer[y * ctx->display.width + x];
+    if (x >= 0 && x < target.width && y >= 0 && y < target.height) {
+        pixel = target.pixels[y * target.stride + x];
+    }
     
-    pthread_mutex_unlock(&ctx->context_mutex);
+    context_unlock(ctx);
     
     return pixel;
 }
@@ -261,30 +447,22 @@ int rpi_display_fill_rect(display_handle_t display, int x, int y, int width, int
     if (!display) return RPI_DISPLAY_ERROR_INVALID;
     
     rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    raster_target_t target;
+    int skip_x, skip_y;
     
-    // Clip rectangle to display bounds
-    if (x < 0) { width += x; x = 0; }
-    if (y < 0) { height += y; y = 0; }
-    if (x + width > ctx->display.width) width = ctx->display.width - x;
-    if (y + height > ctx->display.height) height = ctx->display.height - y;
+    context_lock(ctx);
     
-    if (width <= 0 || height <= 0) return RPI_DISPLAY_OK;
+    draw_target(ctx, &target);
     
-    pthread_mutex_lock(&ctx->context_mutex);
-    
-    uint16_t* buffer = ctx->display.double_buffer_enabled ? 
-                      ctx->display.backbuffer : ctx->display.framebuffer;
-    
-    for (int row = 0; row < height; row++) {
-        for (int col = 0; col < width; col++) {
-            buffer[(y + row) * ctx->display.width + (x + col)] = color;
-        }
+    // Clip rectangle to target bounds
+    if (clip_to_target(&target, &x, &y, &width, &height, &skip_x, &skip_y)) {
+        pixel_fill_rect(&target.pixels[y * target.stride + x], target.stride, width, height, color);
+        
+        // Mark rectangle as dirty
+        mark_dirty(ctx, x, y, width, height);
     }
     
-    // Mark rectangle as dirty
-    mark_dirty_rect(&ctx->display, x, y, width, height);
-    
-    pthread_mutex_unlock(&ctx->context_mutex);
+    context_unlock(ctx);
     
     return RPI_DISPLAY_OK;
 }
@@ -292,30 +470,18 @@ int rpi_display_fill_rect(display_handle_t display, int x, int y, int width, int
 int rpi_display_draw_line(display_handle_t display, int x0, int y0, int x1, int y1, uint16_t color) {
     if (!display) return RPI_DISPLAY_ERROR_INVALID;
     
-    // Bresenham's line algorithm
-    int dx = abs(x1 - x0);
-    int dy = abs(y1 - y0);
-    int sx = x0 < x1 ? 1 : -1;
-    int sy = y0 < y1 ? 1 : -1;
-    int err = dx - dy;
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    raster_target_t target;
+    raster_bounds_t bounds;
     
-    int x = x0, y = y0;
+    context_lock(ctx);
     
-    while (true) {
-        rpi_display_set_pixel(display, x, y, color);
-        
-        if (x == x1 && y == y1) break;
-        
-        int e2 = 2 * err;
-        if (e2 > -dy) {
-            err -= dy;
-            x += sx;
-        }
-        if (e2 < dx) {
-            err += dx;
-            y += sy;
-        }
-    }
+    draw_target(ctx, &target);
+    raster_bounds_init(&bounds);
+    raster_line(&target, x0, y0, x1, y1, color, &bounds);
+    mark_dirty_bounds(ctx, &bounds);
+    
+    context_unlock(ctx);
     
     return RPI_DISPLAY_OK;
 }
@@ -323,200 +489,965 @@ int rpi_display_draw_line(display_handle_t display, int x0, int y0, int x1, int
 int rpi_display_draw_circle(display_handle_t display, int x, int y, int radius, uint16_t color) {
     if (!display) return RPI_DISPLAY_ERROR_INVALID;
     
-    // Midpoint circle algorithm
-    int xx = 0;
-    int yy = radius;
-    int d = 3 - 2 * radius;
-    
-    while (yy >= xx) {
-        // Draw 8 symmetric points
-        rpi_display_set_pixel(display, x + xx, y + yy, color);
-        rpi_display_set_pixel(display, x - xx, y + yy, color);
-        rpi_display_set_pixel(display, x + xx, y - yy, color);
-        rpi_display_set_pixel(display, x - xx, y - yy, color);
-        rpi_display_set_pixel(display, x + yy, y + xx, color);
-        rpi_display_set_pixel(display, x - yy, y + xx, color);
-        rpi_display_set_pixel(display, x + yy, y - xx, color);
-        rpi_display_set_pixel(display, x - yy, y - xx, color);
-        
-        xx++;
-        if (d > 0) {
-            yy--;
-            d = d + 4 * (xx - yy) + 10;
-        } else {
-            d = d + 4 * xx + 6;
-        }
-    }
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    raster_target_t target;
+    raster_bounds_t bounds;
     
-    return RPI_DISPLAY_OK;
-}
-
-int rpi_display_draw_text(display_handle_t display, int x, int y, const char* text, uint16_t color) {
-    if (!display || !text) return RPI_DISPLAY_ERROR_INVALID;
+    context_lock(ctx);
     
-    int start_x = x;
+    draw_target(ctx, &target);
+    raster_bounds_init(&bounds);
+    raster_circle(&target, x, y, radius, color, &bounds);
+    mark_dirty_bounds(ctx, &bounds);
     
-    while (*text) {
-        if (*text == '\n') {
-            x = start_x;
-            y += 8;
-        } else {
-            draw_character(display, x, y, *text, color);
-            x += 8;
-        }
-        text++;
-    }
+    context_unlock(ctx);
     
     return RPI_DISPLAY_OK;
 }
 
-int rpi_display_copy_buffer(display_handle_t display, const uint16_t* buffer, int x, int y, int width, int height) {
-    if (!display || !buffer) return RPI_DISPLAY_ERROR_INVALID;
+int rpi_display_fill_circle(display_handle_t display, int x, int y, int radius, uint16_t color) {
+    if (!display) return RPI_DISPLAY_ERROR_INVALID;
     
     rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    raster_target_t target;
+    raster_bounds_t bounds;
     
-    // Clip rectangle to display bounds
-    if (x < 0) { width += x; buffer += -x; x = 0; }
-    if (y < 0) { height += y; buffer += -y * width; y = 0; }
-    if (x + width > ctx->display.width) width = ctx->display.width - x;
-    if (y + height > ctx->display.height) height = ctx->display.height - y;
+    context_lock(ctx);
     
-    if (width <= 0 || height <= 0) return RPI_DISPLAY_OK;
+    draw_target(ctx, &target);
+    raster_bounds_init(&bounds);
+    raster_fill_circle(&target, x, y, radius, color, &bounds);
+    mark_dirty_bounds(ctx, &bounds);
     
-    pthread_mutex_lock(&ctx->context_mutex);
+    context_unlock(ctx);
     
-    uint16_t* target_buffer = ctx->display.double_buffer_enabled ? 
-                             ctx->display.backbuffer : ctx->display.framebuffer;
+    return RPI_DISPLAY_OK;
+}
+
+int rpi_display_fill_ellipse(display_handle_t display, int x, int y, int rx, int ry, uint16_t color) {
+    if (!display) return RPI_DISPLAY_ERROR_INVALID;
     
-    for (int row = 0; row < height; row++) {
-        memcpy(&target_buffer[(y + row) * ctx->display.width + x],
-               &buffer[row * width], width * sizeof(uint16_t));
-    }
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    raster_target_t target;
+    raster_bounds_t bounds;
     
-    // Mark rectangle as dirty
-    mark_dirty_rect(&ctx->display, x, y, width, height);
+    context_lock(ctx);
     
-    pthread_mutex_unlock(&ctx->context_mutex);
+    draw_target(ctx, &target);
+    raster_bounds_init(&bounds);
+    raster_fill_ellipse(&target, x, y, rx, ry, color, &bounds);
+    mark_dirty_bounds(ctx, &bounds);
+    
+    context_unlock(ctx);
     
     return RPI_DISPLAY_OK;
 }
 
-int rpi_display_refresh(display_handle_t display) {
+int rpi_display_fill_round_rect(display_handle_t display, int x, int y, int width, int height, int radius, uint16_t color) {
     if (!display) return RPI_DISPLAY_ERROR_INVALID;
     
     rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    raster_target_t target;
+    raster_bounds_t bounds;
     
-    pthread_mutex_lock(&ctx->context_mutex);
-    
-    // Swap buffers if double buffering is enabled
-    if (ctx->display.double_buffer_enabled) {
-        swap_buffers(ctx);
-    }
+    context_lock(ctx);
     
-    int result = ili9486l_refresh_display(&ctx->display);
+    draw_target(ctx, &target);
+    raster_bounds_init(&bounds);
+    raster_fill_round_rect(&target, x, y, width, height, radius, color, &bounds);
+    mark_dirty_bounds(ctx, &bounds);
     
-    pthread_mutex_unlock(&ctx->context_mutex);
+    context_unlock(ctx);
     
-    return result;
+    return RPI_DISPLAY_OK;
 }
 
-int rpi_display_refresh_rect(display_handle_t display, int x, int y, int width, int height) {
+int rpi_display_fill_triangle(display_handle_t display, int x0, int y0, int x1, int y1, int x2, int y2, uint16_t color) {
     if (!display) return RPI_DISPLAY_ERROR_INVALID;
     
     rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    raster_target_t target;
+    raster_bounds_t bounds;
     
-    pthread_mutex_lock(&ctx->context_mutex);
+    context_lock(ctx);
     
-    int result = ili9486l_refresh_rect(&ctx->display, x, y, width, height);
+    draw_target(ctx, &target);
+    raster_bounds_init(&bounds);
+    raster_fill_triangle(&target, x0, y0, x1, y1, x2, y2, color, &bounds);
+    mark_dirty_bounds(ctx, &bounds);
     
-    pthread_mutex_unlock(&ctx->context_mutex);
+    context_unlock(ctx);
     
-    return result;
+    return RPI_DISPLAY_OK;
 }
 
-// Touch API implementation
-int rpi_touch_init(display_handle_t display, const touch_config_t* config) {
-    if (!display) return RPI_DISPLAY_ERROR_INVALID;
+int rpi_display_draw_text(display_handle_t display, int x, int y, const char* text, uint16_t color) {
+    if (!display || !text) return RPI_DISPLAY_ERROR_INVALID;
     
     rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
     
-    if (ctx->touch_enabled) {
-        return RPI_DISPLAY_OK; // Already initialized
-    }
-    
-    if (xpt2046_init(&ctx->touch, config) == RPI_DISPLAY_OK) {
-        ctx->touch_enabled = true;
-        xpt2046_start_interrupt_thread(&ctx->touch);
-        return RPI_DISPLAY_OK;
-    }
+    context_lock(ctx);
+    draw_text(ctx, &font_builtin_8x8, false, x, y, text, color, 0, false);
+    context_unlock(ctx);
     
-    return RPI_DISPLAY_ERROR_INIT;
+    return RPI_DISPLAY_OK;
 }
 
-void rpi_touch_destroy(display_handle_t display) {
-    if (!display) return;
+int rpi_display_draw_text_opaque(display_handle_t display, int x, int y, const char* text,
+                                 uint16_t fg, uint16_t bg) {
+    if (!display || !text) return RPI_DISPLAY_ERROR_INVALID;
     
     rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
     
-    if (ctx->touch_enabled) {
-        xpt2046_destroy(&ctx->touch);
-        ctx->touch_enabled = false;
-    }
+    context_lock(ctx);
+    draw_text(ctx, &font_builtin_8x8, false, x, y, text, fg, bg, true);
+    context_unlock(ctx);
+    
+    return RPI_DISPLAY_OK;
 }
 
-touch_point_t rpi_touch_read(display_handle_t display) {
-    touch_point_t point = {0};
+font_handle_t rpi_display_load_font(const char* path) {
+    if (!path) return NULL;
     
-    if (!display) return point;
-    
-    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    return font_load(path);
+}
+
+font_handle_t rpi_display_create_font(int width, int height, int bpp, uint32_t first_codepoint,
+                                      uint32_t glyph_count, const uint8_t* glyphs) {
+    return font_create(width, height, bpp, first_codepoint, glyph_count, glyphs);
+}
+
+font_handle_t rpi_display_smooth_font(font_handle_t font, int factor) {
+    return font_smooth(font ? font : &font_builtin_8x8, factor);
+}
+
+void rpi_display_free_font(font_handle_t font) {
+    if (font) font_release(font);
+}
+
+int rpi_display_get_font_size(font_handle_t font, int* width, int* height) {
+    const font_t* f = font ? font : &font_builtin_8x8;
     
-    if (ctx->touch_enabled) {
-        point = xpt2046_read_touch(&ctx->touch);
-    }
+    if (width) *width = f->width;
+    if (height) *height = f->height;
     
-    return point;
+    return RPI_DISPLAY_OK;
 }
 
-bool rpi_touch_is_pressed(display_handle_t display) {
-    if (!display) return false;
+int rpi_display_draw_text_font(display_handle_t display, font_handle_t font, int x, int y, const char* text,
+                               uint16_t color) {
+    if (!display || !text) return RPI_DISPLAY_ERROR_INVALID;
     
     rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
     
-    if (ctx->touch_enabled) {
-        return xpt2046_is_touched(&ctx->touch);
-    }
+    context_lock(ctx);
+    draw_text(ctx, font ? font : &font_builtin_8x8, true, x, y, text, color, 0, false);
+    context_unlock(ctx);
     
-    return false;
+    return RPI_DISPLAY_OK;
 }
 
-int rpi_touch_calibrate(display_handle_t display) {
-    if (!display) return RPI_DISPLAY_ERROR_INVALID;
+int rpi_display_draw_text_font_opaque(display_handle_t display, font_handle_t font, int x, int y,
+                                      const char* text, uint16_t fg, uint16_t bg) {
+    if (!display || !text) return RPI_DISPLAY_ERROR_INVALID;
     
     rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
     
-    if (ctx->touch_enabled) {
-        return xpt2046_calibrate(&ctx->touch);
-    }
+    context_lock(ctx);
+    draw_text(ctx, font ? font : &font_builtin_8x8, true, x, y, text, fg, bg, true);
+    context_unlock(ctx);
     
-    return RPI_DISPLAY_ERROR_INIT;
+    return RPI_DISPLAY_OK;
 }
 
-int rpi_touch_set_config(display_handle_t display, const touch_config_t* config) {
-    if (!display || !config) return RPI_DISPLAY_ERROR_INVALID;
+int rpi_display_copy_buffer(display_handle_t display, const uint16_t* buffer, int x, int y, int width, int height) {
+    if (!display || !buffer) return RPI_DISPLAY_ERROR_INVALID;
     
     rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    raster_target_t target;
+    int skip_x, skip_y;
     
-    if (ctx->touch_enabled) {
-        xpt2046_set_calibration(&ctx->touch, config);
-        return RPI_DISPLAY_OK;
+    // Source rows keep their original stride when clipped
+    int stride = width;
+    
+    context_lock(ctx);
+    
+    draw_target(ctx, &target);
+    
+    // Clip rectangle to target bounds
+    if (clip_to_target(&target, &x, &y, &width, &height, &skip_x, &skip_y)) {
+        pixel_copy_rect(&target.pixels[y * target.stride + x], target.stride,
+                        &buffer[skip_y * stride + skip_x], stride, width, height);
+        
+        // Mark rectangle as dirty
+        mark_dirty(ctx, x, y, width, height);
     }
     
-    return RPI_DISPLAY_ERROR_INIT;
+    context_unlock(ctx);
+    
+    return RPI_DISPLAY_OK;
 }
 
-// Utility functions
-uint16_t rgb_to_rgb565(uint8_t r, uint8_t g, uint8_t b) {
+int rpi_display_copy_rect(display_handle_t display, int src_x, int src_y, int width, int height,
+                          int dst_x, int dst_y) {
+    if (!display) return RPI_DISPLAY_ERROR_INVALID;
+    
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    raster_target_t target;
+    int skip_x, skip_y;
+    
+    context_lock(ctx);
+    
+    draw_target(ctx, &target);
+    
+    // Clip the source, then the destination, moving the other edge along
+    if (clip_to_target(&target, &src_x, &src_y, &width, &height, &skip_x, &skip_y)) {
+        dst_x += skip_x;
+        dst_y += skip_y;
+        
+        if (clip_to_target(&target, &dst_x, &dst_y, &width, &height, &skip_x, &skip_y) &&
+            (src_x + skip_x != dst_x || src_y + skip_y != dst_y)) {
+            src_x += skip_x;
+            src_y += skip_y;
+            
+            // Row order and memmove make overlapping moves safe
+            pixel_copy_rect(&target.pixels[dst_y * target.stride + dst_x], target.stride,
+                            &target.pixels[src_y * target.stride + src_x], target.stride, width, height);
+            
+            mark_dirty(ctx, dst_x, dst_y, width, height);
+        }
+    }
+    
+    context_unlock(ctx);
+    
+    return RPI_DISPLAY_OK;
+}
+
+// Shared body of the 24/32-bit blits: clip, then convert row by row
+static int copy_buffer_converted(display_handle_t display, const void* buffer, int bytes_per_pixel,
+                                 int x, int y, int width, int height) {
+    if (!display || !buffer) return RPI_DISPLAY_ERROR_INVALID;
+    
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    const pixel_kernels_t* kernels = pixel_kernels_get();
+    raster_target_t target;
+    int skip_x, skip_y;
+    int stride = width * bytes_per_pixel;
+    
+    context_lock(ctx);
+    
+    draw_target(ctx, &target);
+    
+    // Clip rectangle to target bounds
+    if (!clip_to_target(&target, &x, &y, &width, &height, &skip_x, &skip_y)) {
+        context_unlock(ctx);
+        return RPI_DISPLAY_OK;
+    }
+    
+    const uint8_t* src = (const uint8_t*)buffer + skip_y * stride + skip_x * bytes_per_pixel;
+    
+    for (int row = 0; row < height; row++) {
+        uint16_t* dst = &target.pixels[(y + row) * target.stride + x];
+        
+        if (bytes_per_pixel == 3) {
+            kernels->rgb888_to_rgb565(dst, &src[row * stride], width);
+        } else {
+            kernels->argb8888_to_rgb565(dst, (const uint32_t*)&src[row * stride], width);
+        }
+    }
+    
+    // Mark rectangle as dirty
+    mark_dirty(ctx, x, y, width, height);
+    
+    context_unlock(ctx);
+    
+    return RPI_DISPLAY_OK;
+}
+
+int rpi_display_copy_buffer_rgb888(display_handle_t display, const uint8_t* buffer, int x, int y, int width, int height) {
+    return copy_buffer_converted(display, buffer, 3, x, y, width, height);
+}
+
+int rpi_display_copy_buffer_argb8888(display_handle_t display, const uint32_t* buffer, int x, int y, int width, int height) {
+    return copy_buffer_converted(display, buffer, 4, x, y, width, height);
+}
+
+int rpi_display_blit_rgb565a8(display_handle_t display, const uint16_t* pixels, const uint8_t* alpha,
+                              int x, int y, int width, int height) {
+    if (!alpha) return RPI_DISPLAY_ERROR_INVALID;
+    return blend_buffer(display, pixels, alpha, x, y, width, height);
+}
+
+int rpi_display_blit_argb8888(display_handle_t display, const uint32_t* pixels, int x, int y, int width, int height) {
+    return blend_buffer(display, pixels, NULL, x, y, width, height);
+}
+
+surface_handle_t rpi_surface_create(int width, int height) {
+    return surface_create(width, height);
+}
+
+void rpi_surface_destroy(surface_handle_t surface) {
+    surface_destroy(surface);
+}
+
+int rpi_surface_get_size(surface_handle_t surface, int* width, int* height) {
+    if (!surface) return RPI_DISPLAY_ERROR_INVALID;
+    
+    if (width) *width = surface->target.width;
+    if (height) *height = surface->target.height;
+    
+    return RPI_DISPLAY_OK;
+}
+
+uint16_t* rpi_surface_get_pixels(surface_handle_t surface, int* stride) {
+    if (!surface) return NULL;
+    
+    if (stride) *stride = surface->target.stride;
+    
+    return surface->target.pixels;
+}
+
+int rpi_surface_get_pool_stats(surface_pool_stats_t* stats) {
+    if (!stats) return RPI_DISPLAY_ERROR_INVALID;
+    
+    surface_pool_get_stats(stats);
+    
+    return RPI_DISPLAY_OK;
+}
+
+void rpi_surface_pool_trim(void) {
+    surface_pool_trim();
+}
+
+int rpi_display_set_target(display_handle_t display, surface_handle_t surface) {
+    if (!display) return RPI_DISPLAY_ERROR_INVALID;
+    
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    
+    context_lock(ctx);
+    ctx->target = surface;
+    context_unlock(ctx);
+    
+    return RPI_DISPLAY_OK;
+}
+
+int rpi_display_blit_surface(display_handle_t display, surface_handle_t surface, int src_x, int src_y,
+                             int width, int height, int dst_x, int dst_y) {
+    if (!display || !surface) return RPI_DISPLAY_ERROR_INVALID;
+    
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    const raster_target_t* source = &surface->target;
+    raster_target_t target;
+    int skip_x, skip_y;
+    
+    context_lock(ctx);
+    
+    draw_target(ctx, &target);
+    
+    // Clip to the source surface, then to the target, moving the other corner along
+    if (clip_to_target(source, &src_x, &src_y, &width, &height, &skip_x, &skip_y)) {
+        dst_x += skip_x;
+        dst_y += skip_y;
+        
+        if (clip_to_target(&target, &dst_x, &dst_y, &width, &height, &skip_x, &skip_y)) {
+            src_x += skip_x;
+            src_y += skip_y;
+            
+            // Blitting a surface onto itself is an overlapping move, which the copy allows
+            pixel_copy_rect(&target.pixels[dst_y * target.stride + dst_x], target.stride,
+                            &source->pixels[src_y * source->stride + src_x], source->stride, width, height);
+            
+            mark_dirty(ctx, dst_x, dst_y, width, height);
+        }
+    }
+    
+    context_unlock(ctx);
+    
+    return RPI_DISPLAY_OK;
+}
+
+layer_handle_t rpi_display_create_layer(display_handle_t display, int x, int y, int width, int height,
+                                        int z, layer_mode_t mode) {
+    if (!display) return NULL;
+    
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    
+    context_lock(ctx);
+    layer_t* layer = compositor_create_layer(&ctx->compositor, x, y, width, height, z, mode);
+    context_unlock(ctx);
+    
+    return layer;
+}
+
+void rpi_display_destroy_layer(display_handle_t display, layer_handle_t layer) {
+    if (!display || !layer) return;
+    
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    
+    context_lock(ctx);
+    
+    if (ctx->target == layer->surface) {
+        ctx->target = NULL;
+    }
+    
+    compositor_destroy_layer(&ctx->compositor, layer);
+    context_unlock(ctx);
+}
+
+surface_handle_t rpi_layer_get_surface(layer_handle_t layer) {
+    return layer ? layer->surface : NULL;
+}
+
+int rpi_display_move_layer(display_handle_t display, layer_handle_t layer, int x, int y) {
+    if (!display || !layer) return RPI_DISPLAY_ERROR_INVALID;
+    
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    
+    context_lock(ctx);
+    compositor_move_layer(&ctx->compositor, layer, x, y);
+    context_unlock(ctx);
+    
+    return RPI_DISPLAY_OK;
+}
+
+int rpi_display_set_layer_visible(display_handle_t display, layer_handle_t layer, bool visible) {
+    if (!display || !layer) return RPI_DISPLAY_ERROR_INVALID;
+    
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    
+    context_lock(ctx);
+    compositor_set_visible(&ctx->compositor, layer, visible);
+    context_unlock(ctx);
+    
+    return RPI_DISPLAY_OK;
+}
+
+int rpi_display_set_layer_opacity(display_handle_t display, layer_handle_t layer, uint8_t opacity) {
+    if (!display || !layer) return RPI_DISPLAY_ERROR_INVALID;
+    
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    
+    context_lock(ctx);
+    compositor_set_opacity(&ctx->compositor, layer, opacity);
+    context_unlock(ctx);
+    
+    return RPI_DISPLAY_OK;
+}
+
+int rpi_display_set_layer_key(display_handle_t display, layer_handle_t layer, uint16_t key) {
+    if (!display || !layer) return RPI_DISPLAY_ERROR_INVALID;
+    
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    
+    context_lock(ctx);
+    compositor_set_key(&ctx->compositor, layer, key);
+    context_unlock(ctx);
+    
+    return RPI_DISPLAY_OK;
+}
+
+int rpi_display_set_layer_z(display_handle_t display, layer_handle_t layer, int z) {
+    if (!display || !layer) return RPI_DISPLAY_ERROR_INVALID;
+    
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    
+    context_lock(ctx);
+    compositor_set_z(&ctx->compositor, layer, z);
+    context_unlock(ctx);
+    
+    return RPI_DISPLAY_OK;
+}
+
+int rpi_display_set_layer_background(display_handle_t display, uint16_t color) {
+    if (!display) return RPI_DISPLAY_ERROR_INVALID;
+    
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    
+    context_lock(ctx);
+    compositor_set_background(&ctx->compositor, color);
+    context_unlock(ctx);
+    
+    return RPI_DISPLAY_OK;
+}
+
+int rpi_display_damage_layer(display_handle_t display, layer_handle_t layer, int x, int y, int width, int height) {
+    if (!display || !layer) return RPI_DISPLAY_ERROR_INVALID;
+    
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    
+    context_lock(ctx);
+    compositor_damage_layer(&ctx->compositor, layer, x, y, width, height);
+    context_unlock(ctx);
+    
+    return RPI_DISPLAY_OK;
+}
+
+sprite_handle_t rpi_display_create_sprite(display_handle_t display, const uint16_t* pixels, const uint8_t* alpha,
+                                          int width, int height, int hot_x, int hot_y) {
+    if (!display) return NULL;
+    
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    sprite_t* sprite = sprite_create(pixels, alpha, width, height, hot_x, hot_y);
+    if (!sprite) return NULL;
+    
+    context_lock(ctx);
+    int result = sprite_set_add(&ctx->sprites, sprite);
+    context_unlock(ctx);
+    
+    if (result != RPI_DISPLAY_OK) {
+        sprite_destroy(sprite);
+        return NULL;
+    }
+    
+    return sprite;
+}
+
+void rpi_display_destroy_sprite(display_handle_t display, sprite_handle_t sprite) {
+    if (!display || !sprite) return;
+    
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    
+    context_lock(ctx);
+    mark_sprite(ctx, sprite);
+    sprite_set_remove(&ctx->sprites, sprite);
+    context_unlock(ctx);
+    
+    sprite_destroy(sprite);
+}
+
+int rpi_display_move_sprite(display_handle_t display, sprite_handle_t sprite, int x, int y) {
+    if (!display || !sprite) return RPI_DISPLAY_ERROR_INVALID;
+    
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    
+    context_lock(ctx);
+    
+    if (sprite->x != x || sprite->y != y) {
+        mark_sprite(ctx, sprite);
+        sprite->x = x;
+        sprite->y = y;
+        mark_sprite(ctx, sprite);
+    }
+    
+    context_unlock(ctx);
+    
+    return RPI_DISPLAY_OK;
+}
+
+int rpi_display_set_sprite_visible(display_handle_t display, sprite_handle_t sprite, bool visible) {
+    if (!display || !sprite) return RPI_DISPLAY_ERROR_INVALID;
+    
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    
+    context_lock(ctx);
+    
+    // Marked while visible, whichever way it goes
+    if (sprite->visible != visible) {
+        mark_sprite(ctx, sprite);
+        sprite->visible = visible;
+        mark_sprite(ctx, sprite);
+    }
+    
+    context_unlock(ctx);
+    
+    return RPI_DISPLAY_OK;
+}
+
+int rpi_display_refresh(display_handle_t display) {
+    if (!display) return RPI_DISPLAY_ERROR_INVALID;
+    
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    
+    if (frame_open(ctx)) return RPI_DISPLAY_ERROR_INVALID;
+    
+    if (ctx->async_enabled) {
+        // Keep ordering with frames already queued on the flush thread
+        uint64_t fence;
+        int result = rpi_display_refresh_async(display, &fence);
+        if (result != RPI_DISPLAY_OK) return result;
+        return rpi_display_wait_frame(display, fence, -1);
+    }
+    
+    pthread_mutex_lock(&ctx->context_mutex);
+    pthread_mutex_lock(&ctx->transport_mutex);
+    
+    // Swap buffers if double buffering is enabled
+    if (ctx->display.double_buffer_enabled) {
+        swap_buffers(ctx);
+    }
+    
+    // Layers go into the buffer about to be flushed, which after a swap
+    // last had them composed two refreshes ago
+    compose_layers(ctx, ctx->display.double_buffer_enabled);
+    
+    // Sprites go on top for the flush only
+    raster_target_t screen;
+    screen_target(ctx, &screen);
+    sprite_set_apply(&ctx->sprites, &screen, true);
+    
+    int result = ili9486l_refresh_display(&ctx->display);
+    
+    sprite_set_restore(&ctx->sprites, &screen);
+    
+    pthread_mutex_unlock(&ctx->transport_mutex);
+    pthread_mutex_unlock(&ctx->context_mutex);
+    
+    return result;
+}
+
+int rpi_display_refresh_rect(display_handle_t display, int x, int y, int width, int height) {
+    if (!display) return RPI_DISPLAY_ERROR_INVALID;
+    
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    
+    if (frame_open(ctx)) return RPI_DISPLAY_ERROR_INVALID;
+    
+    // Don't overtake frames already queued on the flush thread
+    rpi_display_wait_frame(display, 0, -1);
+    
+    pthread_mutex_lock(&ctx->context_mutex);
+    pthread_mutex_lock(&ctx->transport_mutex);
+    
+    raster_target_t screen;
+    screen_target(ctx, &screen);
+    sprite_set_apply(&ctx->sprites, &screen, true);
+    
+    int result = ili9486l_refresh_rect(&ctx->display, x, y, width, height);
+    
+    sprite_set_restore(&ctx->sprites, &screen);
+    
+    pthread_mutex_unlock(&ctx->transport_mutex);
+    pthread_mutex_unlock(&ctx->context_mutex);
+    
+    return result;
+}
+
+int rpi_display_set_damage_cost(display_handle_t display, uint32_t setup_cost_bytes) {
+    if (!display) return RPI_DISPLAY_ERROR_INVALID;
+    
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    
+    context_lock(ctx);
+    ctx->display.damage_setup_cost = setup_cost_bytes;
+    ctx->compositor.setup_cost = setup_cost_bytes;
+    context_unlock(ctx);
+    
+    return RPI_DISPLAY_OK;
+}
+
+int rpi_display_scroll_region(display_handle_t display, int top, int height, int dy, uint16_t fill) {
+    if (!display) return RPI_DISPLAY_ERROR_INVALID;
+    
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    
+    if (frame_open(ctx)) return RPI_DISPLAY_ERROR_INVALID;
+    
+    // Queued snapshots were taken against the current GRAM mapping
+    rpi_display_wait_frame(display, 0, -1);
+    
+    pthread_mutex_lock(&ctx->context_mutex);
+    pthread_mutex_lock(&ctx->transport_mutex);
+    
+    int result = ili9486l_scroll_region(&ctx->display, top, height, dy);
+    
+    // Rows moved outside the damage, so both snapshots start over
+    ctx->staging_stale = 2;
+    
+    if (result == RPI_DISPLAY_OK && dy != 0) {
+        // Clear the rows the move uncovered; the driver already marked them
+        raster_target_t target;
+        int count = dy > 0 ? dy : -dy;
+        
+        if (count > height) count = height;
+        screen_target(ctx, &target);
+        pixel_fill_rect(&target.pixels[(dy > 0 ? top + height - count : top) * target.stride],
+                        target.stride, target.width, count, fill);
+    }
+    
+    pthread_mutex_unlock(&ctx->transport_mutex);
+    pthread_mutex_unlock(&ctx->context_mutex);
+    
+    return result;
+}
+
+int rpi_display_refresh_async(display_handle_t display, uint64_t* fence) {
+    if (!display) return RPI_DISPLAY_ERROR_INVALID;
+    
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    
+    if (frame_open(ctx)) return RPI_DISPLAY_ERROR_INVALID;
+    
+    if (!ctx->async_enabled) {
+        // Synchronous mode: the frame is complete on return
+        if (fence) *fence = 0;
+        return rpi_display_refresh(display);
+    }
+    
+    // Producers serialize here, so the slot found free below stays ours
+    // while the snapshot is copied without holding flush_mutex
+    pthread_mutex_lock(&ctx->context_mutex);
+    pthread_mutex_lock(&ctx->flush_mutex);
+    
+    // Both staging buffers busy: wait for the flush thread to free one
+    while (ctx->job_count == 2 && ctx->flush_running) {
+        pthread_cond_wait(&ctx->flush_cond, &ctx->flush_mutex);
+    }
+    
+    bool running = ctx->flush_running;
+    int slot = (ctx->job_head + ctx->job_count) % 2;
+    pthread_mutex_unlock(&ctx->flush_mutex);
+    
+    if (!running) {
+        pthread_mutex_unlock(&ctx->context_mutex);
+        return RPI_DISPLAY_ERROR_INIT;
+    }
+    
+    uint16_t* staging = ctx->staging[slot];
+    flush_job_t* job = &ctx->jobs[slot];
+    ili9486l_ctx_t* dev = &ctx->display;
+    
+    // Swap and compose exactly as the synchronous path does, so both
+    // modes put the same buffer on the panel
+    if (dev->double_buffer_enabled) {
+        swap_buffers(ctx);
+    }
+    
+    compose_layers(ctx, dev->double_buffer_enabled);
+    
+    // Sprites are blended into the source just for the copy, so they only
+    // reach the snapshot inside the damaged rects
+    raster_target_t screen;
+    screen_target(ctx, &screen);
+    sprite_set_apply(&ctx->sprites, &screen, true);
+    
+    // An empty region means full screen, matching the synchronous path
+    job->region = dev->damage;
+    clear_dirty_rect(dev);
+    
+    // Each staging buffer is kept a whole copy of its source, since the
+    // shadow diff can merge rows into rects reaching past the damage. The
+    // other buffer took the previous frame, so its damage is copied too.
+    // With double buffering both alternate together, so each staging
+    // buffer keeps following the same source buffer.
+    const damage_region_t* previous = &ctx->jobs[1 - slot].region;
+    
+    if (job->region.count == 0 || previous->count == 0 || ctx->staging_stale > 0) {
+        memcpy(staging, screen.pixels, dev->width * dev->height * sizeof(uint16_t));
+        if (ctx->staging_stale > 0) ctx->staging_stale--;
+    } else {
+        copy_region(staging, screen.pixels, dev->width, &job->region);
+        copy_region(staging, screen.pixels, dev->width, previous);
+    }
+    
+    sprite_set_restore(&ctx->sprites, &screen);
+    
+    pthread_mutex_lock(&ctx->flush_mutex);
+    
+    job->buffer = staging;
+    job->seq = ++ctx->submitted_seq;
+    ctx->job_count++;
+    
+    if (fence) *fence = job->seq;
+    
+    pthread_cond_broadcast(&ctx->flush_cond);
+    pthread_mutex_unlock(&ctx->flush_mutex);
+    pthread_mutex_unlock(&ctx->context_mutex);
+    
+    return RPI_DISPLAY_OK;
+}
+
+int rpi_display_wait_frame(display_handle_t display, uint64_t fence, int timeout_ms) {
+    if (!display) return RPI_DISPLAY_ERROR_INVALID;
+    
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    
+    if (frame_open(ctx)) return RPI_DISPLAY_ERROR_INVALID;
+    
+    if (!ctx->async_enabled) {
+        return RPI_DISPLAY_OK;
+    }
+    
+    struct timespec deadline;
+    if (timeout_ms >= 0) {
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += timeout_ms / 1000;
+        deadline.tv_nsec += (timeout_ms % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+    }
+    
+    int result = RPI_DISPLAY_OK;
+    
+    pthread_mutex_lock(&ctx->flush_mutex);
+    
+    // Fence 0 waits for everything submitted so far
+    if (fence == 0) {
+        fence = ctx->submitted_seq;
+    }
+    
+    while (ctx->completed_seq < fence) {
+        if (timeout_ms < 0) {
+            pthread_cond_wait(&ctx->flush_cond, &ctx->flush_mutex);
+        } else if (pthread_cond_timedwait(&ctx->flush_cond, &ctx->flush_mutex, &deadline) == ETIMEDOUT) {
+            result = RPI_DISPLAY_ERROR_TIMEOUT;
+            break;
+        }
+    }
+    
+    if (result == RPI_DISPLAY_OK && ctx->flush_error != RPI_DISPLAY_OK) {
+        result = ctx->flush_error;
+        ctx->flush_error = RPI_DISPLAY_OK;
+    }
+    
+    pthread_mutex_unlock(&ctx->flush_mutex);
+    
+    return result;
+}
+
+// Touch API implementation
+int rpi_touch_init(display_handle_t display, const touch_config_t* config) {
+    if (!display) return RPI_DISPLAY_ERROR_INVALID;
+    
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    
+    if (ctx->touch_enabled) {
+        return RPI_DISPLAY_OK; // Already initialized
+    }
+    
+    if (xpt2046_init(&ctx->touch, config) == RPI_DISPLAY_OK) {
+        ctx->touch_enabled = true;
+        xpt2046_start_interrupt_thread(&ctx->touch);
+        return RPI_DISPLAY_OK;
+    }
+    
+    return RPI_DISPLAY_ERROR_INIT;
+}
+
+void rpi_touch_destroy(display_handle_t display) {
+    if (!display) return;
+    
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    
+    if (ctx->touch_enabled) {
+        xpt2046_destroy(&ctx->touch);
+        ctx->touch_enabled = false;
+    }
+}
+
+touch_point_t rpi_touch_read(display_handle_t display) {
+    touch_point_t point = {0};
+    
+    if (!display) return point;
+    
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    
+    if (ctx->touch_enabled) {
+        point = xpt2046_read_touch(&ctx->touch);
+    }
+    
+    return point;
+}
+
+bool rpi_touch_is_pressed(display_handle_t display) {
+    if (!display) return false;
+    
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    
+    if (ctx->touch_enabled) {
+        return xpt2046_is_touched(&ctx->touch);
+    }
+    
+    return false;
+}
+
+int rpi_touch_calibrate(display_handle_t display) {
+    if (!display) return RPI_DISPLAY_ERROR_INVALID;
+    
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    
+    if (ctx->touch_enabled) {
+        return xpt2046_calibrate(&ctx->touch);
+    }
+    
+    return RPI_DISPLAY_ERROR_INIT;
+}
+
+int rpi_touch_set_config(display_handle_t display, const touch_config_t* config) {
+    if (!display || !config) return RPI_DISPLAY_ERROR_INVALID;
+    
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    
+    if (ctx->touch_enabled) {
+        xpt2046_set_calibration(&ctx->touch, config);
+        return RPI_DISPLAY_OK;
+    }
+    
+    return RPI_DISPLAY_ERROR_INIT;
+}
+
+int rpi_touch_get_stats(display_handle_t display, touch_stats_t* stats) {
+    if (!display || !stats) return RPI_DISPLAY_ERROR_INVALID;
+    
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    
+    if (ctx->touch_enabled) {
+        xpt2046_get_stats(&ctx->touch, stats);
+        return RPI_DISPLAY_OK;
+    }
+    
+    return RPI_DISPLAY_ERROR_INIT;
+}
+
+void rpi_touch_reset_stats(display_handle_t display) {
+    if (!display) return;
+    
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    
+    if (ctx->touch_enabled) {
+        xpt2046_reset_stats(&ctx->touch);
+    }
+}
+
+int rpi_touch_poll_events(display_handle_t display, touch_event_t* events, int max) {
+    if (!display || !events || max < 0) return RPI_DISPLAY_ERROR_INVALID;
+    
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    
+    if (ctx->touch_enabled) {
+        return xpt2046_poll_events(&ctx->touch, events, max);
+    }
+    
+    return RPI_DISPLAY_ERROR_INIT;
+}
+
+int rpi_touch_get_fd(display_handle_t display) {
+    if (!display) return RPI_DISPLAY_ERROR_INVALID;
+    
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    
+    if (ctx->touch_enabled) {
+        return ctx->touch.event_fd;
+    }
+    
+    return RPI_DISPLAY_ERROR_INIT;
+}
+
+int rpi_touch_wait(display_handle_t display, int timeout_ms) {
+    if (!display) return RPI_DISPLAY_ERROR_INVALID;
+    
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    
+    if (ctx->touch_enabled) {
+        return xpt2046_wait_events(&ctx->touch, timeout_ms);
+    }
+    
+    return RPI_DISPLAY_ERROR_INIT;
+}
+
+// Utility functions
+uint16_t rgb_to_rgb565(uint8_t r, uint8_t g, uint8_t b) {
     return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
 }
 
@@ -527,23 +1458,244 @@ void rgb565_to_rgb(uint16_t color, uint8_t* r, uint8_t* g, uint8_t* b) {
 }
 
 // Internal helper functions
-static void draw_character(display_handle_t display, int x, int y, char c, uint16_t color) {
-    if (c < 32 || c > 127) c = 32; // Default to space for unsupported characters
+static bool frame_open(rpi_display_ctx_t* ctx) {
+    return frame_ctx == ctx;
+}
+
+// Inside an open frame the calling thread already holds context_mutex
+static void context_lock(rpi_display_ctx_t* ctx) {
+    if (frame_ctx != ctx) {
+        pthread_mutex_lock(&ctx->context_mutex);
+    }
+}
+
+static void context_unlock(rpi_display_ctx_t* ctx) {
+    if (frame_ctx != ctx) {
+        pthread_mutex_unlock(&ctx->context_mutex);
+    }
+}
+
+// Damage only means something for the screen; surfaces are redrawn whole
+// wherever they are blitted
+static void mark_dirty(rpi_display_ctx_t* ctx, int x, int y, int width, int height) {
+    if (!ctx->target) {
+        mark_dirty_rect(&ctx->display, x, y, width, height);
+    } else if (ctx->target->layer) {
+        compositor_damage_layer(&ctx->compositor, ctx->target->layer, x, y, width, height);
+    }
+}
+
+// Mark the inclusive box (x0,y0)-(x1,y1) dirty after clipping it to the screen
+static void mark_dirty_clipped(rpi_display_ctx_t* ctx, int x0, int y0, int x1, int y1) {
+    raster_target_t target;
+    draw_target(ctx, &target);
+    
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 >= target.width) x1 = target.width - 1;
+    if (y1 >= target.height) y1 = target.height - 1;
+    
+    if (x1 < x0 || y1 < y0) return;
+    
+    mark_dirty(ctx, x0, y0, x1 - x0 + 1, y1 - y0 + 1);
+}
+
+// Text is UTF-8 looked up in the font's Unicode table, or raw bytes used
+// as glyph indices (Latin-1 in the built-in font)
+static void draw_text(rpi_display_ctx_t* ctx, const font_t* font, bool utf8, int x, int y, const char* text,
+                      uint16_t fg, uint16_t bg, bool opaque) {
+    raster_target_t target;
+    int start_x = x;
+    int start_y = y;
+    int max_x = x;
+    
+    draw_target(ctx, &target);
     
-    const uint8_t* char_data = font_8x8[(int)c];
+    if (utf8) font_prepare(font);
     
-    for (int row = 0; row < 8; row++) {
-        uint8_t line = char_data[row];
-        for (int col = 0; col < 8; col++) {
-            if (line & (0x80 >> col)) {
-                rpi_display_set_pixel(display, x + col, y + row, color);
-            }
+    while (*text) {
+        if (*text == '\n') {
+            x = start_x;
+            y += font->height;
+            text++;
+            continue;
+        }
+        
+        uint32_t glyph = utf8 ? font_lookup(font, font_utf8_next(&text)) : (uint8_t)*text++;
+        if (opaque) {
+            text_draw_glyph_opaque(&target, &ctx->glyph_cache, font, glyph, x, y, fg, bg);
+        } else {
+            text_draw_glyph(&target, font, glyph, x, y, fg);
         }
+        
+        x += font->width;
+        if (x > max_x) max_x = x;
+    }
+    
+    // One damage rect covering every line of the string
+    if (max_x > start_x) {
+        mark_dirty_clipped(ctx, start_x, start_y, max_x - 1, y + font->height - 1);
+    }
+}
+
+// Shared body of the alpha blits: RGB565 with a separate alpha plane, or
+// ARGB8888 when alpha is NULL
+static int blend_buffer(display_handle_t display, const void* pixels, const uint8_t* alpha,
+                        int x, int y, int width, int height) {
+    if (!display || !pixels) return RPI_DISPLAY_ERROR_INVALID;
+    
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)display;
+    raster_target_t target;
+    int skip_x, skip_y;
+    int stride = width;
+    
+    context_lock(ctx);
+    
+    draw_target(ctx, &target);
+    
+    if (!clip_to_target(&target, &x, &y, &width, &height, &skip_x, &skip_y)) {
+        context_unlock(ctx);
+        return RPI_DISPLAY_OK;
+    }
+    
+    uint16_t* dst = &target.pixels[y * target.stride + x];
+    int offset = skip_y * stride + skip_x;
+    
+    if (alpha) {
+        pixel_blend_rect_a8(dst, target.stride, (const uint16_t*)pixels + offset, stride,
+                            alpha + offset, stride, width, height);
+    } else {
+        pixel_blend_rect_argb8888(dst, target.stride, (const uint32_t*)pixels + offset, stride,
+                                  width, height);
     }
+    
+    mark_dirty(ctx, x, y, width, height);
+    
+    context_unlock(ctx);
+    
+    return RPI_DISPLAY_OK;
 }
 
 static void swap_buffers(rpi_display_ctx_t* ctx) {
     uint16_t* temp = ctx->display.framebuffer;
     ctx->display.framebuffer = ctx->display.backbuffer;
     ctx->display.backbuffer = temp;
-} 
\ No newline at end of file
+} 
+
+// Asynchronous flushing
+static void copy_region(uint16_t* dst, const uint16_t* src, int stride, const damage_region_t* region) {
+    for (int i = 0; i < region->count; i++) {
+        const damage_rect_t* rect = &region->rects[i];
+        uint32_t offset = rect->y * stride + rect->x;
+        
+        pixel_copy_rect(&dst[offset], stride, &src[offset], stride, rect->width, rect->height);
+    }
+}
+
+static void free_staging(rpi_display_ctx_t* ctx) {
+    for (int i = 0; i < 2; i++) {
+        free(ctx->staging[i]);
+        ctx->staging[i] = NULL;
+    }
+}
+
+static int async_flush_start(rpi_display_ctx_t* ctx) {
+    pthread_condattr_t attr;
+    
+    ctx->staging[0] = malloc(ctx->display.fb_size);
+    ctx->staging[1] = malloc(ctx->display.fb_size);
+    if (!ctx->staging[0] || !ctx->staging[1]) {
+        free_staging(ctx);
+        return -1;
+    }
+    
+    if (pthread_mutex_init(&ctx->flush_mutex, NULL) != 0) {
+        free_staging(ctx);
+        return -1;
+    }
+    
+    // Frame waits are measured on the monotonic clock
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    int result = pthread_cond_init(&ctx->flush_cond, &attr);
+    pthread_condattr_destroy(&attr);
+    
+    if (result != 0) {
+        pthread_mutex_destroy(&ctx->flush_mutex);
+        free_staging(ctx);
+        return -1;
+    }
+    
+    ctx->staging_stale = 2;
+    ctx->job_head = 0;
+    ctx->job_count = 0;
+    ctx->submitted_seq = 0;
+    ctx->completed_seq = 0;
+    ctx->flush_error = RPI_DISPLAY_OK;
+    ctx->flush_running = true;
+    
+    if (pthread_create(&ctx->flush_thread, NULL, flush_thread_main, ctx) != 0) {
+        perror("Failed to create flush thread");
+        ctx->flush_running = false;
+        pthread_cond_destroy(&ctx->flush_cond);
+        pthread_mutex_destroy(&ctx->flush_mutex);
+        free_staging(ctx);
+        return -1;
+    }
+    
+    ctx->async_enabled = true;
+    return 0;
+}
+
+static void async_flush_stop(rpi_display_ctx_t* ctx) {
+    if (!ctx->async_enabled) return;
+    
+    // The thread exits once the queue is drained
+    pthread_mutex_lock(&ctx->flush_mutex);
+    ctx->flush_running = false;
+    pthread_cond_broadcast(&ctx->flush_cond);
+    pthread_mutex_unlock(&ctx->flush_mutex);
+    
+    pthread_join(ctx->flush_thread, NULL);
+    ctx->async_enabled = false;
+    
+    pthread_cond_destroy(&ctx->flush_cond);
+    pthread_mutex_destroy(&ctx->flush_mutex);
+    free_staging(ctx);
+}
+
+static void* flush_thread_main(void* arg) {
+    rpi_display_ctx_t* ctx = (rpi_display_ctx_t*)arg;
+    
+    while (true) {
+        pthread_mutex_lock(&ctx->flush_mutex);
+        while (ctx->flush_running && ctx->job_count == 0) {
+            pthread_cond_wait(&ctx->flush_cond, &ctx->flush_mutex);
+        }
+        
+        if (ctx->job_count == 0) {
+            pthread_mutex_unlock(&ctx->flush_mutex);
+            break;
+        }
+        
+        flush_job_t job = ctx->jobs[ctx->job_head];
+        pthread_mutex_unlock(&ctx->flush_mutex);
+        
+        // The staging buffer is ours until the job is retired
+        pthread_mutex_lock(&ctx->transport_mutex);
+        int result = ili9486l_refresh_region_from(&ctx->display, job.buffer, &job.region);
+        pthread_mutex_unlock(&ctx->transport_mutex);
+        
+        pthread_mutex_lock(&ctx->flush_mutex);
+        ctx->job_head = (ctx->job_head + 1) % 2;
+        ctx->job_count--;
+        ctx->completed_seq = job.seq;
+        if (result != RPI_DISPLAY_OK) {
+            ctx->flush_error = result;
+        }
+        pthread_cond_broadcast(&ctx->flush_cond);
+        pthread_mutex_unlock(&ctx->flush_mutex);
+    }
+    
+    return NULL;
+}
@@ -0,0 +1,1012 @@
+// dev_t, ino_t, strdup and O_CLOEXEC are POSIX, hidden under -std=c11
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "font.h"
+
+// PSF1: u8 magic[2], u8 mode, u8 charsize; 8 pixels wide
+#define PSF1_MAGIC0       0x36
+#define PSF1_MAGIC1       0x04
+#define PSF1_MODE512      0x01
+#define PSF1_MODEHASTAB   0x02
+#define PSF1_MODEHASSEQ   0x04
+#define PSF1_SEPARATOR    0xFFFF
+#define PSF1_STARTSEQ     0xFFFE
+
+// PSF2: u32 magic, version, headersize, flags, length, charsize, height, width
+#define PSF2_MAGIC              0x864AB572u
+#define PSF2_HEADER_SIZE        32
+#define PSF2_HAS_UNICODE_TABLE  0x01
+#define PSF2_SEPARATOR          0xFF
+#define PSF2_STARTSEQ           0xFE
+
+#define FONT_MAX_CELL     255      // Pixels per side
+#define FONT_NO_GLYPH     UINT32_MAX
+
+typedef enum {
+    FONT_FORMAT_PSF1,
+    FONT_FORMAT_PSF2,
+    FONT_FORMAT_BDF,
+    FONT_FORMAT_MEMORY,      // Coverage glyphs handed in by the caller
+    FONT_FORMAT_SMOOTHED     // Downsampled from another font
+} font_format_t;
+
+typedef struct {
+    uint32_t codepoint;
+    uint32_t glyph;
+} font_pair_t;
+
+struct font_file {
+    font_t font;
+    font_format_t format;
+    dev_t dev;
+    ino_t ino;
+    int refs;
+    
+    // PSF glyphs and Unicode table point into the mapping
+    void* map;
+    size_t map_size;
+    const uint8_t* table;
+    size_t table_size;
+    
+    // BDF is text, so its glyphs are rasterized to the heap at load; memory
+    // and smoothed fonts keep theirs there too
+    uint8_t* bitmap;
+    int32_t* encodings;      // Per glyph, -1 if unencoded
+    int32_t default_char;    // DEFAULT_CHAR, -1 if absent
+    uint32_t first_codepoint;  // Memory fonts map a contiguous range
+    const font_t* source;    // Smoothed fonts look code points up here
+    
+    // Code point lookup, built on first use under lock
+    pthread_mutex_t lock;
+    bool prepared;
+    bool identity;           // No table: code point == glyph index
+    uint32_t direct[256];
+    font_pair_t* pairs;      // Sorted by code point
+    uint32_t pair_count;
+    uint32_t missing;        // Glyph for unmapped code points
+    
+    struct font_file* next;
+};
+
+// Static helper functions
+static int load_psf1(struct font_file* file, const uint8_t* data, size_t size);
+static int load_psf2(struct font_file* file, const uint8_t* data, size_t size);
+static int load_bdf(struct font_file* file, const uint8_t* data, size_t size);
+static uint32_t read_le32(const uint8_t* p);
+static bool next_line(const uint8_t** p, const uint8_t* end, char* line, size_t line_size);
+static int hex_digit(char c);
+static int add_pair(struct font_file* file, uint32_t* capacity, uint32_t codepoint, uint32_t glyph);
+static int compare_pairs(const void* a, const void* b);
+static void build_table(struct font_file* file);
+static uint32_t table_lookup(const struct font_file* file, uint32_t codepoint);
+static uint32_t builtin_lookup(uint32_t codepoint);
+static int utf8_decode(const uint8_t* s, size_t avail, uint32_t* codepoint);
+static struct font_file* new_file(const char* name, font_format_t format);
+static void free_file(struct font_file* file);
+
+// Fonts open in this process, shared by every display
+static pthread_mutex_t registry_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct font_file* registry;
+static uint32_t next_font_id = FONT_BUILTIN_ID + 1;
+
+// Bitmaps, MSB leftmost. Control codes are blank; 0x80-0x9F, which are
+// C1 controls in Latin-1, hold box drawing and block glyphs instead.
+static const uint8_t builtin_8x8_glyphs[256][8] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0x00
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0x01
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0x02
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0x03
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0x04
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0x05
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0x06
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0x07
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0x08
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0x09
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0x0A
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0x0B
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0x0C
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0x0D
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0x0E
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0x0F
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0x10
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0x11
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0x12
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0x13
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0x14
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0x15
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0x16
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0x17
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0x18
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0x19
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0x1A
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0x1B
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0x1C
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0x1D
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0x1E
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0x1F
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0x20 Space
+    {0x18, 0x3C, 0x3C, 0x18, 0x18, 0x00, 0x18, 0x00}, // 0x21 !
+    {0x6C, 0x6C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0x22 "
+    {0x6C, 0x6C, 0xFE, 0x6C, 0xFE, 0x6C, 0x6C, 0x00}, // 0x23 #
+    {0x30, 0x7C, 0xC0, 0x78, 0x0C, 0xF8, 0x30, 0x00}, // 0x24 $
+    {0x00, 0xC6, 0xCC, 0x18, 0x30, 0x66, 0xC6, 0x00}, // 0x25 %
+    {0x38, 0x6C, 0x38, 0x76, 0xDC, 0xCC, 0x76, 0x00}, // 0x26 &
+    {0x60, 0x60, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0x27 '
+    {0x18, 0x30, 0x60, 0x60, 0x60, 0x30, 0x18, 0x00}, // 0x28 (
+    {0x60, 0x30, 0x18, 0x18, 0x18, 0x30, 0x60, 0x00}, // 0x29 )
+    {0x00, 0x66, 0x3C, 0xFF, 0x3C, 0x66, 0x00, 0x00}, // 0x2A *
+    {0x00, 0x30, 0x30, 0xFC, 0x30, 0x30, 0x00, 0x00}, // 0x2B +
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x30, 0x60, 0x00}, // 0x2C ,
+    {0x00, 0x00, 0x00, 0xFC, 0x00, 0x00, 0x00, 0x00}, // 0x2D -
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x30, 0x30, 0x00}, // 0x2E .
+    {0x06, 0x0C, 0x18, 0x30, 0x60, 0xC0, 0x80, 0x00}, // 0x2F /
+    {0x7C, 0xC6, 0xCE, 0xDE, 0xF6, 0xE6, 0x7C, 0x00}, // 0x30 0
+    {0x30, 0x70, 0x30, 0x30, 0x30, 0x30, 0xFC, 0x00}, // 0x31 1
+    {0x78, 0xCC, 0x0C, 0x38, 0x60, 0xCC, 0xFC, 0x00}, // 0x32 2
+    {0x78, 0xCC, 0x0C, 0x38, 0x0C, 0xCC, 0x78, 0x00}, // 0x33 3
+    {0x1C, 0x3C, 0x6C, 0xCC, 0xFE, 0x0C, 0x1E, 0x00}, // 0x34 4
+    {0xFC, 0xC0, 0xF8, 0x0C, 0x0C, 0xCC, 0x78, 0x00}, // 0x35 5
+    {0x38, 0x60, 0xC0, 0xF8, 0xCC, 0xCC, 0x78, 0x00}, // 0x36 6
+    {0xFC, 0xCC, 0x0C, 0x18, 0x30, 0x30, 0x30, 0x00}, // 0x37 7
+    {0x78, 0xCC, 0xCC, 0x78, 0xCC, 0xCC, 0x78, 0x00}, // 0x38 8
+    {0x78, 0xCC, 0xCC, 0x7C, 0x0C, 0x18, 0x70, 0x00}, // 0x39 9
+    {0x00, 0x30, 0x30, 0x00, 0x00, 0x30, 0x30, 0x00}, // 0x3A :
+    {0x00, 0x30, 0x30, 0x00, 0x00, 0x30, 0x60, 0x00}, // 0x3B ;
+    {0x18, 0x30, 0x60, 0xC0, 0x60, 0x30, 0x18, 0x00}, // 0x3C <
+    {0x00, 0x00, 0xFC, 0x00, 0x00, 0xFC, 0x00, 0x00}, // 0x3D =
+    {0x60, 0x30, 0x18, 0x0C, 0x18, 0x30, 0x60, 0x00}, // 0x3E >
+    {0x78, 0xCC, 0x0C, 0x18, 0x30, 0x00, 0x30, 0x00}, // 0x3F ?
+    {0x7C, 0xC6, 0xDE, 0xDE, 0xDE, 0xC0, 0x78, 0x00}, // 0x40 @
+    {0x30, 0x78, 0xCC, 0xCC, 0xFC, 0xCC, 0xCC, 0x00}, // 0x41 A
+    {0xFC, 0x66, 0x66, 0x7C, 0x66, 0x66, 0xFC, 0x00}, // 0x42 B
+    {0x3C, 0x66, 0xC0, 0xC0, 0xC0, 0x66, 0x3C, 0x00}, // 0x43 C
+    {0xF8, 0x6C, 0x66, 0x66, 0x66, 0x6C, 0xF8, 0x00}, // 0x44 D
+    {0xFE, 0x62, 0x68, 0x78, 0x68, 0x62, 0xFE, 0x00}, // 0x45 E
+    {0xFE, 0x62, 0x68, 0x78, 0x68, 0x60, 0xF0, 0x00}, // 0x46 F
+    {0x3C, 0x66, 0xC0, 0xC0, 0xCE, 0x66, 0x3E, 0x00}, // 0x47 G
+    {0xCC, 0xCC, 0xCC, 0xFC, 0xCC, 0xCC, 0xCC, 0x00}, // 0x48 H
+    {0x78, 0x30, 0x30, 0x30, 0x30, 0x30, 0x78, 0x00}, // 0x49 I
+    {0x1E, 0x0C, 0x0C, 0x0C, 0xCC, 0xCC, 0x78, 0x00}, // 0x4A J
+    {0xE6, 0x66, 0x6C, 0x78, 0x6C, 0x66, 0xE6, 0x00}, // 0x4B K
+    {0xF0, 0x60, 0x60, 0x60, 0x62, 0x66, 0xFE, 0x00}, // 0x4C L
+    {0xC6, 0xEE, 0xFE, 0xFE, 0xD6, 0xC6, 0xC6, 0x00}, // 0x4D M
+    {0xC6, 0xE6, 0xF6, 0xDE, 0xCE, 0xC6, 0xC6, 0x00}, // 0x4E N
+    {0x38, 0x6C, 0xC6, 0xC6, 0xC6, 0x6C, 0x38, 0x00}, // 0x4F O
+    {0xFC, 0x66, 0x66, 0x7C, 0x60, 0x60, 0xF0, 0x00}, // 0x50 P
+    {0x78, 0xCC, 0xCC, 0xCC, 0xDC, 0x78, 0x1C, 0x00}, // 0x51 Q
+    {0xFC, 0x66, 0x66, 0x7C, 0x6C, 0x66, 0xE6, 0x00}, // 0x52 R
+    {0x78, 0xCC, 0xE0, 0x70, 0x1C, 0xCC, 0x78, 0x00}, // 0x53 S
+    {0xFC, 0xB4, 0x30, 0x30, 0x30, 0x30, 0x78, 0x00}, // 0x54 T
+    {0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xFC, 0x00}, // 0x55 U
+    {0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0x78, 0x30, 0x00}, // 0x56 V
+    {0xC6, 0xC6, 0xC6, 0xD6, 0xFE, 0xEE, 0xC6, 0x00}, // 0x57 W
+    {0xC6, 0xC6, 0x6C, 0x38, 0x38, 0x6C, 0xC6, 0x00}, // 0x58 X
+    {0xCC, 0xCC, 0xCC, 0x78, 0x30, 0x30, 0x78, 0x00}, // 0x59 Y
+    {0xFE, 0xC6, 0x8C, 0x18, 0x32, 0x66, 0xFE, 0x00}, // 0x5A Z
+    {0x78, 0x60, 0x60, 0x60, 0x60, 0x60, 0x78, 0x00}, // 0x5B [
+    {0xC0, 0x60, 0x30, 0x18, 0x0C, 0x06, 0x02, 0x00}, // 0x5C Backslash
+    {0x78, 0x18, 0x18, 0x18, 0x18, 0x18, 0x78, 0x00}, // 0x5D ]
+    {0x10, 0x38, 0x6C, 0xC6, 0x00, 0x00, 0x00, 0x00}, // 0x5E ^
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF}, // 0x5F _
+    {0x30, 0x30, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0x60 `
+    {0x00, 0x00, 0x78, 0x0C, 0x7C, 0xCC, 0x76, 0x00}, // 0x61 a
+    {0xE0, 0x60, 0x60, 0x7C, 0x66, 0x66, 0xDC, 0x00}, // 0x62 b
+    {0x00, 0x00, 0x78, 0xCC, 0xC0, 0xCC, 0x78, 0x00}, // 0x63 c
+    {0x1C, 0x0C, 0x0C, 0x7C, 0xCC, 0xCC, 0x76, 0x00}, // 0x64 d
+    {0x00, 0x00, 0x78, 0xCC, 0xFC, 0xC0, 0x78, 0x00}, // 0x65 e
+    {0x38, 0x6C, 0x60, 0xF0, 0x60, 0x60, 0xF0, 0x00}, // 0x66 f
+    {0x00, 0x00, 0x76, 0xCC, 0xCC, 0x7C, 0x0C, 0xF8}, // 0x67 g
+    {0xE0, 0x60, 0x6C, 0x76, 0x66, 0x66, 0xE6, 0x00}, // 0x68 h
+    {0x30, 0x00, 0x70, 0x30, 0x30, 0x30, 0x78, 0x00}, // 0x69 i
+    {0x0C, 0x00, 0x0C, 0x0C, 0x0C, 0xCC, 0xCC, 0x78}, // 0x6A j
+    {0xE0, 0x60, 0x66, 0x6C, 0x78, 0x6C, 0xE6, 0x00}, // 0x6B k
+    {0x70, 0x30, 0x30, 0x30, 0x30, 0x30, 0x78, 0x00}, // 0x6C l
+    {0x00, 0x00, 0xCC, 0xFE, 0xFE, 0xD6, 0xC6, 0x00}, // 0x6D m
+    {0x00, 0x00, 0xF8, 0xCC, 0xCC, 0xCC, 0xCC, 0x00}, // 0x6E n
+    {0x00, 0x00, 0x78, 0xCC, 0xCC, 0xCC, 0x78, 0x00}, // 0x6F o
+    {0x00, 0x00, 0xDC, 0x66, 0x66, 0x7C, 0x60, 0xF0}, // 0x70 p
+    {0x00, 0x00, 0x76, 0xCC, 0xCC, 0x7C, 0x0C, 0x1E}, // 0x71 q
+    {0x00, 0x00, 0xDC, 0x76, 0x66, 0x60, 0xF0, 0x00}, // 0x72 r
+    {0x00, 0x00, 0x7C, 0xC0, 0x78, 0x0C, 0xF8, 0x00}, // 0x73 s
+    {0x10, 0x30, 0x7C, 0x30, 0x30, 0x34, 0x18, 0x00}, // 0x74 t
+    {0x00, 0x00, 0xCC, 0xCC, 0xCC, 0xCC, 0x76, 0x00}, // 0x75 u
+    {0x00, 0x00, 0xCC, 0xCC, 0xCC, 0x78, 0x30, 0x00}, // 0x76 v
+    {0x00, 0x00, 0xC6, 0xD6, 0xFE, 0xFE, 0x6C, 0x00}, // 0x77 w
+    {0x00, 0x00, 0xC6, 0x6C, 0x38, 0x6C, 0xC6, 0x00}, // 0x78 x
+    {0x00, 0x00, 0xCC, 0xCC, 0xCC, 0x7C, 0x0C, 0xF8}, // 0x79 y
+    {0x00, 0x00, 0xFC, 0x98, 0x30, 0x64, 0xFC, 0x00}, // 0x7A z
+    {0x1C, 0x30, 0x30, 0xE0, 0x30, 0x30, 0x1C, 0x00}, // 0x7B {
+    {0x18, 0x18, 0x18, 0x00, 0x18, 0x18, 0x18, 0x00}, // 0x7C |
+    {0xE0, 0x30, 0x30, 0x1C, 0x30, 0x30, 0xE0, 0x00}, // 0x7D }
+    {0x76, 0xDC, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0x7E ~
+    {0x10, 0x28, 0x44, 0x82, 0x82, 0x82, 0xFE, 0x00}, // 0x7F ⌂
+    {0x00, 0x00, 0x00, 0xFF, 0x00, 0x00, 0x00, 0x00}, // 0x80 ─
+    {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10}, // 0x81 │
+    {0x00, 0x00, 0x00, 0x1F, 0x10, 0x10, 0x10, 0x10}, // 0x82 ┌
+    {0x00, 0x00, 0x00, 0xF0, 0x10, 0x10, 0x10, 0x10}, // 0x83 ┐
+    {0x10, 0x10, 0x10, 0x1F, 0x00, 0x00, 0x00, 0x00}, // 0x84 └
+    {0x10, 0x10, 0x10, 0xF0, 0x00, 0x00, 0x00, 0x00}, // 0x85 ┘
+    {0x10, 0x10, 0x10, 0x1F, 0x10, 0x10, 0x10, 0x10}, // 0x86 ├
+    {0x10, 0x10, 0x10, 0xF0, 0x10, 0x10, 0x10, 0x10}, // 0x87 ┤
+    {0x00, 0x00, 0x00, 0xFF, 0x10, 0x10, 0x10, 0x10}, // 0x88 ┬
+    {0x10, 0x10, 0x10, 0xFF, 0x00, 0x00, 0x00, 0x00}, // 0x89 ┴
+    {0x10, 0x10, 0x10, 0xFF, 0x10, 0x10, 0x10, 0x10}, // 0x8A ┼
+    {0x00, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0x00, 0x00}, // 0x8B ═
+    {0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28}, // 0x8C ║
+    {0x00, 0x00, 0x3F, 0x20, 0x2F, 0x28, 0x28, 0x28}, // 0x8D ╔
+    {0x00, 0x00, 0xF8, 0x08, 0xE8, 0x28, 0x28, 0x28}, // 0x8E ╗
+    {0x28, 0x28, 0x2F, 0x20, 0x3F, 0x00, 0x00, 0x00}, // 0x8F ╚
+    {0x28, 0x28, 0xE8, 0x08, 0xF8, 0x00, 0x00, 0x00}, // 0x90 ╝
+    {0x28, 0x28, 0x2F, 0x20, 0x2F, 0x28, 0x28, 0x28}, // 0x91 ╠
+    {0x28, 0x28, 0xE8, 0x08, 0xE8, 0x28, 0x28, 0x28}, // 0x92 ╣
+    {0x00, 0x00, 0xFF, 0x00, 0xEF, 0x28, 0x28, 0x28}, // 0x93 ╦
+    {0x28, 0x28, 0xEF, 0x00, 0xFF, 0x00, 0x00, 0x00}, // 0x94 ╩
+    {0x28, 0x28, 0xEF, 0x00, 0xEF, 0x28, 0x28, 0x28}, // 0x95 ╬
+    {0x88, 0x22, 0x88, 0x22, 0x88, 0x22, 0x88, 0x22}, // 0x96 ░
+    {0xAA, 0x55, 0xAA, 0x55, 0xAA, 0x55, 0xAA, 0x55}, // 0x97 ▒
+    {0x77, 0xDD, 0x77, 0xDD, 0x77, 0xDD, 0x77, 0xDD}, // 0x98 ▓
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}, // 0x99 █
+    {0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00}, // 0x9A ▀
+    {0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF}, // 0x9B ▄
+    {0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0}, // 0x9C ▌
+    {0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F}, // 0x9D ▐
+    {0x00, 0x00, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x00}, // 0x9E ■
+    {0x10, 0x38, 0x7C, 0xFE, 0x7C, 0x38, 0x10, 0x00}, // 0x9F ◆
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0xA0 No-break space
+    {0x00, 0x18, 0x00, 0x18, 0x18, 0x3C, 0x3C, 0x18}, // 0xA1 ¡
+    {0x10, 0x3C, 0x60, 0x60, 0x3C, 0x10, 0x00, 0x00}, // 0xA2 ¢
+    {0x38, 0x6C, 0x60, 0xF0, 0x60, 0x64, 0xFC, 0x00}, // 0xA3 £
+    {0x00, 0x82, 0x7C, 0x44, 0x44, 0x7C, 0x82, 0x00}, // 0xA4 ¤
+    {0xCC, 0xCC, 0x78, 0xFC, 0x30, 0xFC, 0x30, 0x00}, // 0xA5 ¥
+    {0x18, 0x18, 0x18, 0x00, 0x18, 0x18, 0x18, 0x00}, // 0xA6 ¦
+    {0x3C, 0x60, 0x38, 0x6C, 0x38, 0x0C, 0x78, 0x00}, // 0xA7 §
+    {0x6C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0xA8 ¨
+    {0x7C, 0x82, 0xBA, 0xA2, 0xBA, 0x82, 0x7C, 0x00}, // 0xA9 ©
+    {0x78, 0x0C, 0x7C, 0xCC, 0x7C, 0x00, 0xFC, 0x00}, // 0xAA ª
+    {0x00, 0x36, 0x6C, 0xD8, 0x6C, 0x36, 0x00, 0x00}, // 0xAB «
+    {0x00, 0x00, 0xFC, 0x0C, 0x0C, 0x00, 0x00, 0x00}, // 0xAC ¬
+    {0x00, 0x00, 0x00, 0xFC, 0x00, 0x00, 0x00, 0x00}, // 0xAD Soft hyphen
+    {0x7C, 0x82, 0xB2, 0xAA, 0xB2, 0xAA, 0x7C, 0x00}, // 0xAE ®
+    {0xFC, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0xAF ¯
+    {0x30, 0x48, 0x48, 0x30, 0x00, 0x00, 0x00, 0x00}, // 0xB0 °
+    {0x30, 0x30, 0xFC, 0x30, 0x30, 0x00, 0xFC, 0x00}, // 0xB1 ±
+    {0x70, 0x08, 0x30, 0x40, 0x78, 0x00, 0x00, 0x00}, // 0xB2 ²
+    {0x70, 0x08, 0x30, 0x08, 0x70, 0x00, 0x00, 0x00}, // 0xB3 ³
+    {0x18, 0x30, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // 0xB4 ´
+    {0x00, 0x00, 0x66, 0x66, 0x66, 0x7C, 0x60, 0xC0}, // 0xB5 µ
+    {0x7E, 0xDA, 0xDA, 0x7A, 0x1A, 0x1A, 0x1A, 0x00}, // 0xB6 ¶
+    {0x00, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x00}, // 0xB7 ·
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x30}, // 0xB8 ¸
+    {0x20, 0x60, 0x20, 0x20, 0x70, 0x00, 0x00, 0x00}, // 0xB9 ¹
+    {0x78, 0xCC, 0xCC, 0xCC, 0x78, 0x00, 0xFC, 0x00}, // 0xBA º
+    {0x00, 0xD8, 0x6C, 0x36, 0x6C, 0xD8, 0x00, 0x00}, // 0xBB »
+    {0x42, 0xC4, 0x48, 0x54, 0x2C, 0x5E, 0x84, 0x00}, // 0xBC ¼
+    {0x42, 0xC4, 0x48, 0x56, 0x22, 0x44, 0x8E, 0x00}, // 0xBD ½
+    {0xC2, 0x44, 0xC8, 0x54, 0xEC, 0x5E, 0x84, 0x00}, // 0xBE ¾
+    {0x00, 0x18, 0x00, 0x18, 0x30, 0x60, 0x66, 0x3C}, // 0xBF ¿
+    {0x20, 0x10, 0x30, 0x78, 0xCC, 0xFC, 0xCC, 0xCC}, // 0xC0 À
+    {0x10, 0x20, 0x30, 0x78, 0xCC, 0xFC, 0xCC, 0xCC}, // 0xC1 Á
+    {0x30, 0x48, 0x30, 0x78, 0xCC, 0xFC, 0xCC, 0xCC}, // 0xC2 Â
+    {0x64, 0x98, 0x30, 0x78, 0xCC, 0xFC, 0xCC, 0xCC}, // 0xC3 Ã
+    {0x48, 0x00, 0x30, 0x78, 0xCC, 0xFC, 0xCC, 0xCC}, // 0xC4 Ä
+    {0x30, 0x30, 0x30, 0x78, 0xCC, 0xFC, 0xCC, 0xCC}, // 0xC5 Å
+    {0x3E, 0x6C, 0xCC, 0xFE, 0xCC, 0xCC, 0xCE, 0x00}, // 0xC6 Æ
+    {0x3C, 0x66, 0xC0, 0xC0, 0x66, 0x3C, 0x10, 0x20}, // 0xC7 Ç
+    {0x20, 0x10, 0xFE, 0x68, 0x78, 0x68, 0x62, 0xFE}, // 0xC8 È
+    {0x10, 0x20, 0xFE, 0x68, 0x78, 0x68, 0x62, 0xFE}, // 0xC9 É
+    {0x30, 0x48, 0xFE, 0x68, 0x78, 0x68, 0x62, 0xFE}, // 0xCA Ê
+    {0x48, 0x00, 0xFE, 0x68, 0x78, 0x68, 0x62, 0xFE}, // 0xCB Ë
+    {0x20, 0x10, 0x78, 0x30, 0x30, 0x30, 0x30, 0x78}, // 0xCC Ì
+    {0x10, 0x20, 0x78, 0x30, 0x30, 0x30, 0x30, 0x78}, // 0xCD Í
+    {0x30, 0x48, 0x78, 0x30, 0x30, 0x30, 0x30, 0x78}, // 0xCE Î
+    {0x48, 0x00, 0x78, 0x30, 0x30, 0x30, 0x30, 0x78}, // 0xCF Ï
+    {0xF8, 0x6C, 0x66, 0xF6, 0x66, 0x6C, 0xF8, 0x00}, // 0xD0 Ð
+    {0x64, 0x98, 0xC6, 0xE6, 0xF6, 0xDE, 0xCE, 0xC6}, // 0xD1 Ñ
+    {0x20, 0x10, 0x38, 0x6C, 0xC6, 0xC6, 0x6C, 0x38}, // 0xD2 Ò
+    {0x10, 0x20, 0x38, 0x6C, 0xC6, 0xC6, 0x6C, 0x38}, // 0xD3 Ó
+    {0x30, 0x48, 0x38, 0x6C, 0xC6, 0xC6, 0x6C, 0x38}, // 0xD4 Ô
+    {0x64, 0x98, 0x38, 0x6C, 0xC6, 0xC6, 0x6C, 0x38}, // 0xD5 Õ
+    {0x48, 0x00, 0x38, 0x6C, 0xC6, 0xC6, 0x6C, 0x38}, // 0xD6 Ö
+    {0x00, 0xC6, 0x6C, 0x38, 0x6C, 0xC6, 0x00, 0x00}, // 0xD7 ×
+    {0x7A, 0xCC, 0xDC, 0xFC, 0xEC, 0xCC, 0xF8, 0x00}, // 0xD8 Ø
+    {0x20, 0x10, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xFC}, // 0xD9 Ù
+    {0x10, 0x20, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xFC}, // 0xDA Ú
+    {0x30, 0x48, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xFC}, // 0xDB Û
+    {0x48, 0x00, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xFC}, // 0xDC Ü
+    {0x10, 0x20, 0xCC, 0xCC, 0x78, 0x30, 0x30, 0x78}, // 0xDD Ý
+    {0xF0, 0x60, 0x7C, 0x66, 0x7C, 0x60, 0xF0, 0x00}, // 0xDE Þ
+    {0x78, 0xCC, 0xCC, 0xD8, 0xCC, 0xCC, 0xD8, 0xC0}, // 0xDF ß
+    {0x20, 0x10, 0x78, 0x0C, 0x7C, 0xCC, 0x76, 0x00}, // 0xE0 à
+    {0x10, 0x20, 0x78, 0x0C, 0x7C, 0xCC, 0x76, 0x00}, // 0xE1 á
+    {0x30, 0x48, 0x78, 0x0C, 0x7C, 0xCC, 0x76, 0x00}, // 0xE2 â
+    {0x64, 0x98, 0x78, 0x0C, 0x7C, 0xCC, 0x76, 0x00}, // 0xE3 ã
+    {0x48, 0x00, 0x78, 0x0C, 0x7C, 0xCC, 0x76, 0x00}, // 0xE4 ä
+    {0x30, 0x30, 0x78, 0x0C, 0x7C, 0xCC, 0x76, 0x00}, // 0xE5 å
+    {0x00, 0x00, 0x6C, 0x1A, 0x7E, 0xD8, 0x6E, 0x00}, // 0xE6 æ
+    {0x00, 0x00, 0x78, 0xCC, 0xC0, 0xCC, 0x78, 0x30}, // 0xE7 ç
+    {0x20, 0x10, 0x78, 0xCC, 0xFC, 0xC0, 0x78, 0x00}, // 0xE8 è
+    {0x10, 0x20, 0x78, 0xCC, 0xFC, 0xC0, 0x78, 0x00}, // 0xE9 é
+    {0x30, 0x48, 0x78, 0xCC, 0xFC, 0xC0, 0x78, 0x00}, // 0xEA ê
+    {0x48, 0x00, 0x78, 0xCC, 0xFC, 0xC0, 0x78, 0x00}, // 0xEB ë
+    {0x20, 0x10, 0x70, 0x30, 0x30, 0x30, 0x78, 0x00}, // 0xEC ì
+    {0x10, 0x20, 0x70, 0x30, 0x30, 0x30, 0x78, 0x00}, // 0xED í
+    {0x30, 0x48, 0x70, 0x30, 0x30, 0x30, 0x78, 0x00}, // 0xEE î
+    {0x48, 0x00, 0x70, 0x30, 0x30, 0x30, 0x78, 0x00}, // 0xEF ï
+    {0x68, 0x30, 0x58, 0x7C, 0xCC, 0xCC, 0x78, 0x00}, // 0xF0 ð
+    {0x64, 0x98, 0xF8, 0xCC, 0xCC, 0xCC, 0xCC, 0x00}, // 0xF1 ñ
+    {0x20, 0x10, 0x78, 0xCC, 0xCC, 0xCC, 0x78, 0x00}, // 0xF2 ò
+    {0x10, 0x20, 0x78, 0xCC, 0xCC, 0xCC, 0x78, 0x00}, // 0xF3 ó
+    {0x30, 0x48, 0x78, 0xCC, 0xCC, 0xCC, 0x78, 0x00}, // 0xF4 ô
+    {0x64, 0x98, 0x78, 0xCC, 0xCC, 0xCC, 0x78, 0x00}, // 0xF5 õ
+    {0x48, 0x00, 0x78, 0xCC, 0xCC, 0xCC, 0x78, 0x00}, // 0xF6 ö
+    {0x00, 0x30, 0x00, 0xFC, 0x00, 0x30, 0x00, 0x00}, // 0xF7 ÷
+    {0x00, 0x02, 0x7C, 0xDC, 0xFC, 0xEC, 0xF8, 0x00}, // 0xF8 ø
+    {0x20, 0x10, 0xCC, 0xCC, 0xCC, 0xCC, 0x76, 0x00}, // 0xF9 ù
+    {0x10, 0x20, 0xCC, 0xCC, 0xCC, 0xCC, 0x76, 0x00}, // 0xFA ú
+    {0x30, 0x48, 0xCC, 0xCC, 0xCC, 0xCC, 0x76, 0x00}, // 0xFB û
+    {0x48, 0x00, 0xCC, 0xCC, 0xCC, 0xCC, 0x76, 0x00}, // 0xFC ü
+    {0x10, 0x20, 0xCC, 0xCC, 0xCC, 0x7C, 0x0C, 0xF8}, // 0xFD ý
+    {0xE0, 0x60, 0x7C, 0x66, 0x66, 0x7C, 0x60, 0xF0}, // 0xFE þ
+    {0x48, 0x00, 0xCC, 0xCC, 0xCC, 0x7C, 0x0C, 0xF8}, // 0xFF ÿ
+};
+
+const font_t font_builtin_8x8 = {
+    .name = "builtin-8x8",
+    .id = FONT_BUILTIN_ID,
+    .width = 8,
+    .height = 8,
+    .row_bytes = 1,
+    .bpp = 1,
+    .glyph_count = 256,
+    .default_glyph = '?',
+    .glyphs = &builtin_8x8_glyphs[0][0],
+};
+
+// Unicode homes of the glyphs outside Latin-1, sorted by code point
+static const font_pair_t builtin_unicode[] = {
+    {0x2302, 0x7F}, {0x2500, 0x80}, {0x2502, 0x81}, {0x250C, 0x82}, {0x2510, 0x83},
+    {0x2514, 0x84}, {0x2518, 0x85}, {0x251C, 0x86}, {0x2524, 0x87}, {0x252C, 0x88},
+    {0x2534, 0x89}, {0x253C, 0x8A}, {0x2550, 0x8B}, {0x2551, 0x8C}, {0x2554, 0x8D},
+    {0x2557, 0x8E}, {0x255A, 0x8F}, {0x255D, 0x90}, {0x2560, 0x91}, {0x2563, 0x92},
+    {0x2566, 0x93}, {0x2569, 0x94}, {0x256C, 0x95}, {0x2580, 0x9A}, {0x2584, 0x9B},
+    {0x2588, 0x99}, {0x258C, 0x9C}, {0x2590, 0x9D}, {0x2591, 0x96}, {0x2592, 0x97},
+    {0x2593, 0x98}, {0x25A0, 0x9E}, {0x25C6, 0x9F},
+};
+
+font_t* font_load(const char* path) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        perror("Failed to open font");
+        return NULL;
+    }
+    
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        perror("Failed to stat font");
+        close(fd);
+        return NULL;
+    }
+    
+    pthread_mutex_lock(&registry_lock);
+    
+    for (struct font_file* file = registry; file; file = file->next) {
+        if (file->dev == st.st_dev && file->ino == st.st_ino) {
+            file->refs++;
+            pthread_mutex_unlock(&registry_lock);
+            close(fd);
+            return &file->font;
+        }
+    }
+    
+    struct font_file* file = calloc(1, sizeof(struct font_file));
+    char* name = strdup(path);
+    void* map = st.st_size > 0 ? mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    
+    if (!file || !name || map == MAP_FAILED) {
+        if (map == MAP_FAILED) {
+            perror("Failed to map font");
+        } else {
+            munmap(map, st.st_size);
+        }
+        free(name);
+        free(file);
+        pthread_mutex_unlock(&registry_lock);
+        return NULL;
+    }
+    
+    file->font.name = name;
+    file->font.bpp = 1;
+    file->map = map;
+    file->map_size = st.st_size;
+    file->dev = st.st_dev;
+    file->ino = st.st_ino;
+    file->default_char = -1;
+    pthread_mutex_init(&file->lock, NULL);
+    
+    const uint8_t* data = map;
+    size_t size = st.st_size;
+    int result;
+    
+    if (size >= 2 && data[0] == PSF1_MAGIC0 && data[1] == PSF1_MAGIC1) {
+        result = load_psf1(file, data, size);
+    } else if (size >= 4 && (data[0] | data[1] << 8 | data[2] << 16 | (uint32_t)data[3] << 24) == PSF2_MAGIC) {
+        result = load_psf2(file, data, size);
+    } else if (size >= 9 && memcmp(data, "STARTFONT", 9) == 0) {
+        result = load_bdf(file, data, size);
+    } else {
+        if (size >= 2 && data[0] == 0x1F && data[1] == 0x8B) {
+            printf("Warning: %s is compressed, unpack it with gunzip first\n", path);
+        } else {
+            printf("Warning: %s is not a PSF or BDF font\n", path);
+        }
+        result = -1;
+    }
+    
+    if (result < 0) {
+        free_file(file);
+        pthread_mutex_unlock(&registry_lock);
+        return NULL;
+    }
+    
+    // BDF glyphs were copied out, the text itself is no longer needed
+    if (file->format == FONT_FORMAT_BDF) {
+        munmap(file->map, file->map_size);
+        file->map = NULL;
+    }
+    
+    file->font.id = next_font_id++;
+    file->font.file = file;
+    file->refs = 1;
+    file->next = registry;
+    registry = file;
+    
+    pthread_mutex_unlock(&registry_lock);
+    
+    return &file->font;
+}
+
+void font_release(font_t* font) {
+    struct font_file* file = font->file;
+    if (!file) return;
+    
+    pthread_mutex_lock(&registry_lock);
+    
+    if (--file->refs > 0) {
+        pthread_mutex_unlock(&registry_lock);
+        return;
+    }
+    
+    for (struct font_file** link = &registry; *link; link = &(*link)->next) {
+        if (*link == file) {
+            *link = file->next;
+            break;
+        }
+    }
+    
+    pthread_mutex_unlock(&registry_lock);
+    
+    free_file(file);
+}
+
+font_t* font_create(int width, int height, int bpp, uint32_t first_codepoint, uint32_t glyph_count,
+                    const uint8_t* glyphs) {
+    if (width <= 0 || height <= 0 || width > FONT_MAX_CELL || height > FONT_MAX_CELL ||
+        (bpp != 1 && bpp != 4 && bpp != 8) || glyph_count == 0 || !glyphs) {
+        return NULL;
+    }
+    
+    int row_bytes = (width * bpp + 7) / 8;
+    size_t size = (size_t)glyph_count * height * row_bytes;
+    struct font_file* file = new_file("memory", FONT_FORMAT_MEMORY);
+    
+    if (!file || !(file->bitmap = malloc(size))) {
+        perror("Failed to allocate font");
+        if (file) free_file(file);
+        return NULL;
+    }
+    
+    memcpy(file->bitmap, glyphs, size);
+    file->first_codepoint = first_codepoint;
+    file->font.width = width;
+    file->font.height = height;
+    file->font.row_bytes = row_bytes;
+    file->font.bpp = bpp;
+    file->font.glyph_count = glyph_count;
+    file->font.glyphs = file->bitmap;
+    
+    return &file->font;
+}
+
+// Each output pixel counts the set bits in a factor x factor block of the
+// source and scales that to a 4-bit coverage. Divisions happen here, once
+// per font, never while drawing.
+font_t* font_smooth(const font_t* source, int factor) {
+    if (!source || source->bpp != 1 || factor < 2 || source->width < factor || source->height < factor) {
+        return NULL;
+    }
+    
+    int width = source->width / factor;
+    int height = source->height / factor;
+    int row_bytes = (width * 4 + 7) / 8;
+    int samples = factor * factor;
+    struct font_file* file = new_file(source->name, FONT_FORMAT_SMOOTHED);
+    
+    if (!file || !(file->bitmap = calloc((size_t)source->glyph_count * height, row_bytes))) {
+        perror("Failed to allocate font");
+        if (file) free_file(file);
+        return NULL;
+    }
+    
+    for (uint32_t glyph = 0; glyph < source->glyph_count; glyph++) {
+        const uint8_t* bits = font_glyph(source, glyph);
+        uint8_t* out = &file->bitmap[(size_t)glyph * height * row_bytes];
+        
+        for (int r = 0; r < height; r++, out += row_bytes) {
+            for (int c = 0; c < width; c++) {
+                int count = 0;
+                
+                for (int sy = r * factor; sy < (r + 1) * factor; sy++) {
+                    const uint8_t* row = &bits[sy * source->row_bytes];
+                    for (int sx = c * factor; sx < (c + 1) * factor; sx++) {
+                        count += (row[sx >> 3] >> (7 - (sx & 7))) & 1;
+                    }
+                }
+                
+                int level = (count * 15 + samples / 2) / samples;
+                out[c >> 1] |= (c & 1) ? level : level << 4;
+            }
+        }
+    }
+    
+    // The source supplies the code point table, so keep it open
+    if (source->file) {
+        pthread_mutex_lock(&registry_lock);
+        source->file->refs++;
+        pthread_mutex_unlock(&registry_lock);
+    }
+    
+    file->source = source;
+    file->font.width = width;
+    file->font.height = height;
+    file->font.row_bytes = row_bytes;
+    file->font.bpp = 4;
+    file->font.glyph_count = source->glyph_count;
+    file->font.default_glyph = source->default_glyph;
+    file->font.glyphs = file->bitmap;
+    
+    return &file->font;
+}
+
+void font_prepare(const font_t* font) {
+    struct font_file* file = font->file;
+    if (file && file->source) {
+        font = file->source;
+        file = font->file;
+    }
+    if (!file) return;
+    
+    pthread_mutex_lock(&file->lock);
+    if (!file->prepared) {
+        build_table(file);
+        file->prepared = true;
+    }
+    pthread_mutex_unlock(&file->lock);
+}
+
+uint32_t font_lookup(const font_t* font, uint32_t codepoint) {
+    const struct font_file* file = font->file;
+    
+    if (file && file->source) {
+        file = file->source->file;
+    }
+    if (!file) return builtin_lookup(codepoint);
+    if (codepoint < 256) return file->direct[codepoint];
+    
+    uint32_t glyph = table_lookup(file, codepoint);
+    return glyph != FONT_NO_GLYPH ? glyph : file->missing;
+}
+
+uint32_t font_utf8_next(const char** text) {
+    uint32_t codepoint;
+    
+    // A NUL fails the continuation test, so this never reads past the string
+    *text += utf8_decode((const uint8_t*)*text, 4, &codepoint);
+    return codepoint;
+}
+
+static int load_psf1(struct font_file* file, const uint8_t* data, size_t size) {
+    if (size < 4) return -1;
+    
+    uint8_t mode = data[2];
+    uint32_t count = (mode & PSF1_MODE512) ? 512 : 256;
+    uint32_t charsize = data[3];
+    
+    if (charsize == 0 || 4 + (size_t)count * charsize > size) {
+        printf("Warning: %s is a truncated PSF1 font\n", file->font.name);
+        return -1;
+    }
+    
+    file->format = FONT_FORMAT_PSF1;
+    file->font.width = 8;
+    file->font.height = charsize;
+    file->font.row_bytes = 1;
+    file->font.glyph_count = count;
+    file->font.glyphs = data + 4;
+    
+    if (mode & (PSF1_MODEHASTAB | PSF1_MODEHASSEQ)) {
+        file->table = data + 4 + (size_t)count * charsize;
+        file->table_size = size - 4 - (size_t)count * charsize;
+    }
+    
+    return 0;
+}
+
+static uint32_t read_le32(const uint8_t* p) {
+    return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static int load_psf2(struct font_file* file, const uint8_t* data, size_t size) {
+    if (size < PSF2_HEADER_SIZE) return -1;
+    
+    uint32_t header_size = read_le32(data + 8);
+    uint32_t flags = read_le32(data + 12);
+    uint32_t count = read_le32(data + 16);
+    uint32_t charsize = read_le32(data + 20);
+    uint32_t height = read_le32(data + 24);
+    uint32_t width = read_le32(data + 28);
+    uint32_t row_bytes = (width + 7) / 8;
+    
+    if (header_size < PSF2_HEADER_SIZE || width == 0 || height == 0 ||
+        width > FONT_MAX_CELL || height > FONT_MAX_CELL || charsize != height * row_bytes ||
+        count == 0 || header_size > size || (size - header_size) / charsize < count) {
+        printf("Warning: %s is a truncated or malformed PSF2 font\n", file->font.name);
+        return -1;
+    }
+    
+    file->format = FONT_FORMAT_PSF2;
+    file->font.width = width;
+    file->font.height = height;
+    file->font.row_bytes = row_bytes;
+    file->font.glyph_count = count;
+    file->font.glyphs = data + header_size;
+    
+    if (flags & PSF2_HAS_UNICODE_TABLE) {
+        file->table = data + header_size + (size_t)count * charsize;
+        file->table_size = size - header_size - (size_t)count * charsize;
+    }
+    
+    return 0;
+}
+
+// Copy the next line of a mapped text file into line, truncating long lines
+static bool next_line(const uint8_t** p, const uint8_t* end, char* line, size_t line_size) {
+    if (*p >= end) return false;
+    
+    size_t n = 0;
+    while (*p < end && **p != '\n') {
+        if (n + 1 < line_size && **p != '\r') line[n++] = **p;
+        (*p)++;
+    }
+    if (*p < end) (*p)++;
+    
+    line[n] = '\0';
+    return true;
+}
+
+static int hex_digit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Each glyph's BBX is placed in the FONTBOUNDINGBOX cell on the shared
+// baseline; DWIDTH is ignored, so proportional fonts draw monospaced.
+static int load_bdf(struct font_file* file, const uint8_t* data, size_t size) {
+    const uint8_t* p = data;
+    const uint8_t* end = data + size;
+    char line[1024];
+    int cell_w = 0, cell_h = 0, cell_x = 0, cell_y = 0;
+    int chars = -1;
+    uint32_t count = 0;
+    
+    // Glyph being parsed
+    int32_t encoding = -1;
+    int w = 0, h = 0, xo = 0, yo = 0;
+    
+    while (next_line(&p, end, line, sizeof(line))) {
+        if (sscanf(line, "FONTBOUNDINGBOX %d %d %d %d", &cell_w, &cell_h, &cell_x, &cell_y) == 4) {
+            // The glyph table is sized from the first box, so it can't change after CHARS
+            if (file->bitmap || cell_w <= 0 || cell_h <= 0 || cell_w > FONT_MAX_CELL || cell_h > FONT_MAX_CELL) break;
+        } else if (sscanf(line, "DEFAULT_CHAR %d", &file->default_char) == 1) {
+            continue;
+        } else if (sscanf(line, "CHARS %d", &chars) == 1) {
+            // A second CHARS line is malformed; keep the glyphs read so far
+            if (chars <= 0 || cell_w <= 0 || file->bitmap) break;
+            
+            int row_bytes = (cell_w + 7) / 8;
+            file->bitmap = calloc((size_t)chars * cell_h * row_bytes, 1);
+            file->encodings = malloc((size_t)chars * sizeof(int32_t));
+            if (!file->bitmap || !file->encodings) {
+                perror("Failed to allocate BDF glyphs");
+                return -1;
+            }
+            
+            file->font.width = cell_w;
+            file->font.height = cell_h;
+            file->font.row_bytes = row_bytes;
+        } else if (strncmp(line, "STARTCHAR", 9) == 0) {
+            encoding = -1;
+            w = h = xo = yo = 0;
+        } else if (sscanf(line, "ENCODING %d", &encoding) == 1) {
+            continue;
+        } else if (sscanf(line, "BBX %d %d %d %d", &w, &h, &xo, &yo) == 4) {
+            continue;
+        } else if (strcmp(line, "BITMAP") == 0) {
+            if (!file->bitmap || count >= (uint32_t)chars) break;
+            
+            uint8_t* glyph = &file->bitmap[(size_t)count * cell_h * file->font.row_bytes];
+            int top = (cell_h + cell_y) - (h + yo);
+            int left = xo - cell_x;
+            
+            for (int r = 0; r < h && next_line(&p, end, line, sizeof(line)); r++) {
+                int y = top + r;
+                if (y < 0 || y >= cell_h) continue;
+                
+                for (int c = 0; c < w; c++) {
+                    int x = left + c;
+                    int digit = hex_digit(line[c / 4]);
+                    if (digit < 0) break;
+                    
+                    if (x >= 0 && x < cell_w && (digit & (8 >> (c % 4)))) {
+                        glyph[y * file->font.row_bytes + x / 8] |= 0x80 >> (x % 8);
+                    }
+                }
+            }
+            
+            file->encodings[count++] = encoding;
+        }
+    }
+    
+    if (count == 0) {
+        printf("Warning: %s has no usable BDF glyphs\n", file->font.name);
+        return -1;
+    }
+    
+    file->format = FONT_FORMAT_BDF;
+    file->font.glyph_count = count;
+    file->font.glyphs = file->bitmap;
+    
+    return 0;
+}
+
+static int add_pair(struct font_file* file, uint32_t* capacity, uint32_t codepoint, uint32_t glyph) {
+    if (file->pair_count == *capacity) {
+        uint32_t grown = *capacity ? *capacity * 2 : 256;
+        font_pair_t* pairs = realloc(file->pairs, grown * sizeof(font_pair_t));
+        if (!pairs) return -1;
+        
+        file->pairs = pairs;
+        *capacity = grown;
+    }
+    
+    file->pairs[file->pair_count].codepoint = codepoint;
+    file->pairs[file->pair_count].glyph = glyph;
+    file->pair_count++;
+    return 0;
+}
+
+static int compare_pairs(const void* a, const void* b) {
+    const font_pair_t* pa = a;
+    const font_pair_t* pb = b;
+    
+    if (pa->codepoint != pb->codepoint) return pa->codepoint < pb->codepoint ? -1 : 1;
+    if (pa->glyph != pb->glyph) return pa->glyph < pb->glyph ? -1 : 1;
+    return 0;
+}
+
+// Collect (code point, glyph) pairs from the font's table. Multi-code-point
+// sequences are skipped; a glyph is only drawn for a single code point.
+static void build_table(struct font_file* file) {
+    uint32_t capacity = 0;
+    int result = 0;
+    
+    if (file->format == FONT_FORMAT_PSF1 && file->table) {
+        uint32_t glyph = 0;
+        bool sequence = false;
+        
+        for (size_t i = 0; i + 1 < file->table_size && glyph < file->font.glyph_count && result == 0; i += 2) {
+            uint16_t value = file->table[i] | file->table[i + 1] << 8;
+            
+            if (value == PSF1_SEPARATOR) {
+                glyph++;
+                sequence = false;
+            } else if (value == PSF1_STARTSEQ) {
+                sequence = true;
+            } else if (!sequence) {
+                result = add_pair(file, &capacity, value, glyph);
+            }
+        }
+    } else if (file->format == FONT_FORMAT_PSF2 && file->table) {
+        uint32_t glyph = 0;
+        bool sequence = false;
+        size_t i = 0;
+        
+        while (i < file->table_size && glyph < file->font.glyph_count && result == 0) {
+            uint8_t byte = file->table[i];
+            
+            if (byte == PSF2_SEPARATOR) {
+                glyph++;
+                sequence = false;
+                i++;
+            } else if (byte == PSF2_STARTSEQ) {
+                sequence = true;
+                i++;
+            } else {
+                uint32_t codepoint;
+                i += utf8_decode(&file->table[i], file->table_size - i, &codepoint);
+                if (!sequence) result = add_pair(file, &capacity, codepoint, glyph);
+            }
+        }
+    } else if (file->format == FONT_FORMAT_BDF) {
+        for (uint32_t glyph = 0; glyph < file->font.glyph_count && result == 0; glyph++) {
+            if (file->encodings[glyph] >= 0) {
+                result = add_pair(file, &capacity, file->encodings[glyph], glyph);
+            }
+        }
+    } else if (file->format == FONT_FORMAT_MEMORY && file->first_codepoint > 0) {
+        for (uint32_t glyph = 0; glyph < file->font.glyph_count && result == 0; glyph++) {
+            result = add_pair(file, &capacity, file->first_codepoint + glyph, glyph);
+        }
+    }
+    
+    // No table, or no memory for one: glyph index is the code point
+    if (file->pair_count == 0 || result < 0) {
+        free(file->pairs);
+        file->pairs = NULL;
+        file->pair_count = 0;
+        file->identity = true;
+    } else {
+        qsort(file->pairs, file->pair_count, sizeof(font_pair_t), compare_pairs);
+    }
+    
+    file->missing = FONT_NO_GLYPH;
+    if (file->default_char >= 0) file->missing = table_lookup(file, file->default_char);
+    if (file->missing == FONT_NO_GLYPH) file->missing = table_lookup(file, 0xFFFD);
+    if (file->missing == FONT_NO_GLYPH) file->missing = table_lookup(file, '?');
+    if (file->missing == FONT_NO_GLYPH) file->missing = 0;
+    
+    for (uint32_t codepoint = 0; codepoint < 256; codepoint++) {
+        uint32_t glyph = table_lookup(file, codepoint);
+        file->direct[codepoint] = glyph != FONT_NO_GLYPH ? glyph : file->missing;
+    }
+}
+
+// Lowest glyph mapped to codepoint, or FONT_NO_GLYPH
+static uint32_t table_lookup(const struct font_file* file, uint32_t codepoint) {
+    if (file->identity) {
+        return codepoint < file->font.glyph_count ? codepoint : FONT_NO_GLYPH;
+    }
+    
+    uint32_t lo = 0;
+    uint32_t hi = file->pair_count;
+    
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (file->pairs[mid].codepoint < codepoint) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    
+    return lo < file->pair_count && file->pairs[lo].codepoint == codepoint ? file->pairs[lo].glyph : FONT_NO_GLYPH;
+}
+
+// Latin-1 maps straight through; C1 controls have no glyph
+static uint32_t builtin_lookup(uint32_t codepoint) {
+    if (codepoint < 0x80 || (codepoint >= 0xA0 && codepoint < 0x100)) {
+        return codepoint;
+    }
+    
+    uint32_t lo = 0;
+    uint32_t hi = sizeof(builtin_unicode) / sizeof(builtin_unicode[0]);
+    
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (builtin_unicode[mid].codepoint == codepoint) return builtin_unicode[mid].glyph;
+        if (builtin_unicode[mid].codepoint < codepoint) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    
+    return font_builtin_8x8.default_glyph;
+}
+
+// Decode one sequence from at most avail bytes; returns the bytes consumed,
+// at least one
+static int utf8_decode(const uint8_t* s, size_t avail, uint32_t* codepoint) {
+    uint32_t value;
+    int extra;
+    
+    if (s[0] < 0x80) {
+        *codepoint = s[0];
+        return 1;
+    } else if (s[0] >= 0xC2 && s[0] <= 0xDF) {
+        value = s[0] & 0x1F;
+        extra = 1;
+    } else if (s[0] >= 0xE0 && s[0] <= 0xEF) {
+        value = s[0] & 0x0F;
+        extra = 2;
+    } else if (s[0] >= 0xF0 && s[0] <= 0xF4) {
+        value = s[0] & 0x07;
+        extra = 3;
+    } else {
+        *codepoint = 0xFFFD;
+        return 1;
+    }
+    
+    for (int i = 1; i <= extra; i++) {
+        if ((size_t)i >= avail || (s[i] & 0xC0) != 0x80) {
+            *codepoint = 0xFFFD;
+            return i;
+        }
+        value = value << 6 | (s[i] & 0x3F);
+    }
+    
+    // Overlong forms, surrogates and values past U+10FFFF
+    if ((extra == 2 && value < 0x800) || (value >= 0xD800 && value <= 0xDFFF) ||
+        (extra == 3 && (value < 0x10000 || value > 0x10FFFF))) {
+        value = 0xFFFD;
+    }
+    
+    *codepoint = value;
+    return extra + 1;
+}
+
+// Heap-backed font outside the registry, with a fresh id
+static struct font_file* new_file(const char* name, font_format_t format) {
+    struct font_file* file = calloc(1, sizeof(struct font_file));
+    if (!file) return NULL;
+    
+    file->font.name = strdup(name);
+    if (!file->font.name) {
+        free(file);
+        return NULL;
+    }
+    
+    file->format = format;
+    file->font.file = file;
+    file->refs = 1;
+    file->default_char = -1;
+    pthread_mutex_init(&file->lock, NULL);
+    
+    pthread_mutex_lock(&registry_lock);
+    file->font.id = next_font_id++;
+    pthread_mutex_unlock(&registry_lock);
+    
+    return file;
+}
+
+static void free_file(struct font_file* file) {
+    if (file->source) font_release((font_t*)file->source);
+    if (file->map) munmap(file->map, file->map_size);
+    pthread_mutex_destroy(&file->lock);
+    free(file->bitmap);
+    free(file->encodings);
+    free(file->pairs);
+    free((char*)file->font.name);
+    free(file);
+}
@@ -8,14 +8,25 @@
 #include <errno.h>
 #include <time.h>
 #include <linux/spi/spidev.h>
+#include <linux/gpio.h>
 
 #include "ili9486l_driver.h"
 #include "efficient_rpi_display.h"
+#include "virtual_panel.h"
+#include "spi_trace.h"
 
 // Static helper functions
-static int write_command_data(ili9486l_ctx_t* ctx, uint8_t cmd, const uint8_t* data, int len);
 static void delay_ms(int ms);
 static uint64_t get_time_ns(void);
+static int gpio_init_lines(ili9486l_ctx_t* ctx, gpio_backend_t backend);
+static void gpio_release_lines(ili9486l_ctx_t* ctx);
+static int gpio_write_line(ili9486l_ctx_t* ctx, int pin, int value);
+static int transport_message(ili9486l_ctx_t* ctx, struct spi_ioc_transfer* transfers, int count);
+static int set_dc(ili9486l_ctx_t* ctx, int value);
+static int queue_rotation(ili9486l_ctx_t* ctx, uint8_t rotation);
+static void shadow_update(ili9486l_ctx_t* ctx, const uint16_t* source, int x, int y, int width, int height);
+static void invalidate_window(ili9486l_ctx_t* ctx);
+static int queue_scroll(ili9486l_ctx_t* ctx);
 
 // GPIO helper functions
 int gpio_export(int pin) {
@@ -126,8 +137,203 @@ int gpio_get_value(int pin) {
     return atoi(value_str);
 }
 
-// SPI helper functions
-int spi_init(ili9486l_ctx_t* ctx) {
+// GPIO character device helper functions
+int gpio_request_line(int pin, const char* direction, const char* edge, int value) {
+    struct gpio_v2_line_request req;
+    int chip_fd;
+    
+    chip_fd = open(GPIO_CHIP_DEVICE, O_RDWR | O_CLOEXEC);
+    if (chip_fd < 0) {
+        perror("Failed to open GPIO chip");
+        return -1;
+    }
+    
+    memset(&req, 0, sizeof(req));
+    req.offsets[0] = pin;
+    req.num_lines = 1;
+    snprintf(req.consumer, sizeof(req.consumer), "%s", GPIO_CONSUMER);
+    
+    if (strcmp(direction, "out") == 0) {
+        req.config.flags = GPIO_V2_LINE_FLAG_OUTPUT;
+        req.config.num_attrs = 1;
+        req.config.attrs[0].attr.id = GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES;
+        req.config.attrs[0].attr.values = value ? 1 : 0;
+        req.config.attrs[0].mask = 1;
+    } else {
+        req.config.flags = GPIO_V2_LINE_FLAG_INPUT;
+        if (edge && strcmp(edge, "falling") == 0) {
+            req.config.flags |= GPIO_V2_LINE_FLAG_EDGE_FALLING;
+        } else if (edge && strcmp(edge, "rising") == 0) {
+            req.config.flags |= GPIO_V2_LINE_FLAG_EDGE_RISING;
+        } else if (edge && strcmp(edge, "both") == 0) {
+            req.config.flags |= GPIO_V2_LINE_FLAG_EDGE_FALLING | GPIO_V2_LINE_FLAG_EDGE_RISING;
+        }
+    }
+    
+    if (ioctl(chip_fd, GPIO_V2_GET_LINE_IOCTL, &req) < 0) {
+        perror("Failed to request GPIO line");
+        close(chip_fd);
+        return -1;
+    }
+    
+    // The line fd stays valid after the chip is closed
+    close(chip_fd);
+    
+    if (edge) {
+        // Edge events are drained without blocking
+        fcntl(req.fd, F_SETFL, fcntl(req.fd, F_GETFL) | O_NONBLOCK);
+    }
+    
+    return req.fd;
+}
+
+void gpio_release_line(int* line_fd) {
+    if (*line_fd >= 0) {
+        close(*line_fd);
+        *line_fd = -1;
+    }
+}
+
+int gpio_line_set_value(int line_fd, int value) {
+    struct gpio_v2_line_values values = {
+        .bits = value ? 1 : 0,
+        .mask = 1,
+    };
+    
+    if (ioctl(line_fd, GPIO_V2_LINE_SET_VALUES_IOCTL, &values) < 0) {
+        perror("Failed to set GPIO line value");
+        return -1;
+    }
+    
+    return 0;
+}
+
+int gpio_line_get_value(int line_fd) {
+    struct gpio_v2_line_values values = {
+        .bits = 0,
+        .mask = 1,
+    };
+    
+    if (ioctl(line_fd, GPIO_V2_LINE_GET_VALUES_IOCTL, &values) < 0) {
+        perror("Failed to get GPIO line value");
+        return -1;
+    }
+    
+    return values.bits & 1;
+}
+
+int gpio_line_read_events(int line_fd) {
+    struct gpio_v2_line_event events[16];
+    int count = 0;
+    
+    // Drain all pending edge events
+    while (true) {
+        ssize_t len = read(line_fd, events, sizeof(events));
+        if (len < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            perror("Failed to read GPIO line events");
+            return -1;
+        }
+        if (len == 0) break;
+        count += len / sizeof(events[0]);
+    }
+    
+    return count;
+}
+
+// Display GPIO backend
+static int gpio_init_chardev(ili9486l_ctx_t* ctx) {
+    ctx->gpio_fd_dc = gpio_request_line(GPIO_DC, "out", NULL, 0);
+    ctx->gpio_fd_rst = gpio_request_line(GPIO_RST, "out", NULL, 1);
+    ctx->gpio_fd_cs = gpio_request_line(GPIO_CS, "out", NULL, 1);
+    ctx->gpio_fd_led = gpio_request_line(GPIO_LED, "out", NULL, 0);
+    
+    if (ctx->gpio_fd_dc < 0 || ctx->gpio_fd_rst < 0 ||
+        ctx->gpio_fd_cs < 0 || ctx->gpio_fd_led < 0) {
+        gpio_release_lines(ctx);
+        return -1;
+    }
+    
+    ctx->dc_state = 0;
+    return 0;
+}
+
+static int gpio_init_lines(ili9486l_ctx_t* ctx, gpio_backend_t backend) {
+    ctx->gpio_fd_dc = -1;
+    ctx->gpio_fd_rst = -1;
+    ctx->gpio_fd_cs = -1;
+    ctx->gpio_fd_led = -1;
+    ctx->dc_state = -1;
+    
+    if (backend != GPIO_BACKEND_SYSFS) {
+        ctx->gpio_backend = GPIO_BACKEND_CHARDEV;
+        if (gpio_init_chardev(ctx) == 0) {
+            return 0;
+        }
+        
+        if (backend == GPIO_BACKEND_CHARDEV) {
+            return -1;
+        }
+        printf("Warning: GPIO character device unavailable, falling back to sysfs\n");
+    }
+    
+    // Legacy sysfs interface
+    ctx->gpio_backend = GPIO_BACKEND_SYSFS;
+    
+    if (gpio_export(GPIO_DC) < 0 || gpio_export(GPIO_RST) < 0 || 
+        gpio_export(GPIO_CS) < 0 || gpio_export(GPIO_LED) < 0) {
+        return -1;
+    }
+    
+    if (gpio_set_direction(GPIO_DC, "out") < 0 || gpio_set_direction(GPIO_RST, "out") < 0 ||
+        gpio_set_direction(GPIO_CS, "out") < 0 || gpio_set_direction(GPIO_LED, "out") < 0) {
+        return -1;
+    }
+    
+    return 0;
+}
+
+static void gpio_release_lines(ili9486l_ctx_t* ctx) {
+    if (ctx->gpio_backend == GPIO_BACKEND_CHARDEV) {
+        gpio_release_line(&ctx->gpio_fd_dc);
+        gpio_release_line(&ctx->gpio_fd_rst);
+        gpio_release_line(&ctx->gpio_fd_cs);
+        gpio_release_line(&ctx->gpio_fd_led);
+    } else {
+        gpio_unexport(GPIO_DC);
+        gpio_unexport(GPIO_RST);
+        gpio_unexport(GPIO_CS);
+        gpio_unexport(GPIO_LED);
+    }
+}
+
+static int gpio_write_line(ili9486l_ctx_t* ctx, int pin, int value) {
+    ctx->stats.gpio_writes++;
+    
+    if (ctx->trace) {
+        spi_trace_line(ctx->trace, pin, value);
+    }
+    
+    return ctx->transport->write_line(ctx, pin, value);
+}
+
+static int set_dc(ili9486l_ctx_t* ctx, int value) {
+    // Skip redundant DC updates between consecutive data writes
+    if (ctx->dc_state == value) {
+        return 0;
+    }
+    
+    if (gpio_write_line(ctx, GPIO_DC, value) < 0) {
+        ctx->dc_state = -1;
+        return -1;
+    }
+    
+    ctx->dc_state = value;
+    return 0;
+}
+
+// spidev transport
+static int spidev_open_device(ili9486l_ctx_t* ctx) {
     uint8_t mode = SPI_MODE;
     uint8_t bits = SPI_BITS_PER_WORD;
     uint32_t speed = ctx->spi_speed;
@@ -142,6 +348,7 @@ int spi_init(ili9486l_ctx_t* ctx) {
     if (ioctl(ctx->spi_fd, SPI_IOC_WR_MODE, &mode) < 0) {
         perror("Failed to set SPI mode");
         close(ctx->spi_fd);
+        ctx->spi_fd = -1;
         return -1;
     }
     
@@ -149,289 +356,1149 @@ int spi_init(ili9486l_ctx_t* ctx) {
     if (ioctl(ctx->spi_fd, SPI_IOC_WR_BITS_PER_WORD, &bits) < 0) {
         perror("Failed to set SPI bits per word");
         close(ctx->spi_fd);
+        ctx->spi_fd = -1;
+        return -1;
+    }
+    
+    // Set max speed
+    if (ioctl(ctx->spi_fd, SPI_IOC_WR_MAX_SPEED_HZ, &speed) < 0) {
+        perror("Failed to set SPI speed");
+        close(ctx->spi_fd);
+        ctx->spi_fd = -1;
+        return -1;
+    }
+    
+    // Zero-copy needs a controller that shifts 16-bit words; probe it and
+    // restore the 8-bit default used for commands
+    if (ctx->zero_copy) {
+        uint8_t pixel_bits = SPI_PIXEL_BITS;
+        
+        if (ioctl(ctx->spi_fd, SPI_IOC_WR_BITS_PER_WORD, &pixel_bits) < 0) {
+            printf("Warning: SPI controller has no 16-bit word support, zero-copy flush disabled\n");
+            ctx->zero_copy = false;
+        } else if (ioctl(ctx->spi_fd, SPI_IOC_WR_BITS_PER_WORD, &bits) < 0) {
+            perror("Failed to restore SPI bits per word");
+            close(ctx->spi_fd);
+            ctx->spi_fd = -1;
+            return -1;
+        }
+    }
+    
+    return 0;
+}
+
+static int spidev_open(ili9486l_ctx_t* ctx, const display_config_t* config) {
+    if (gpio_init_lines(ctx, config->gpio_backend) < 0) {
+        return RPI_DISPLAY_ERROR_GPIO;
+    }
+    
+    if (spidev_open_device(ctx) < 0) {
+        gpio_release_lines(ctx);
+        return RPI_DISPLAY_ERROR_SPI;
+    }
+    
+    return RPI_DISPLAY_OK;
+}
+
+static void spidev_close(ili9486l_ctx_t* ctx) {
+    if (ctx->spi_fd >= 0) {
+        close(ctx->spi_fd);
+        ctx->spi_fd = -1;
+    }
+    
+    gpio_release_lines(ctx);
+}
+
+static int spidev_message(ili9486l_ctx_t* ctx, struct spi_ioc_transfer* transfers, int count) {
+    if (ioctl(ctx->spi_fd, SPI_IOC_MESSAGE(count), transfers) < 0) {
+        perror("SPI transfer failed");
+        return -1;
+    }
+    
+    return 0;
+}
+
+static int spidev_write_line(ili9486l_ctx_t* ctx, int pin, int value) {
+    if (ctx->gpio_backend == GPIO_BACKEND_CHARDEV) {
+        int line_fd;
+        
+        switch (pin) {
+            case GPIO_DC:  line_fd = ctx->gpio_fd_dc; break;
+            case GPIO_RST: line_fd = ctx->gpio_fd_rst; break;
+            case GPIO_CS:  line_fd = ctx->gpio_fd_cs; break;
+            case GPIO_LED: line_fd = ctx->gpio_fd_led; break;
+            default:       return -1;
+        }
+        
+        ctx->stats.gpio_syscalls += GPIO_CHARDEV_SYSCALLS;
+        return gpio_line_set_value(line_fd, value);
+    }
+    
+    ctx->stats.gpio_syscalls += GPIO_SYSFS_SYSCALLS;
+    return gpio_set_value(pin, value);
+}
+
+const ili9486l_transport_t spidev_transport = {
+    .name = "spidev",
+    .open = spidev_open,
+    .close = spidev_close,
+    .message = spidev_message,
+    .write_line = spidev_write_line,
+    .bus_time_ns = NULL,
+    .read_frame = NULL,
+};
+
+static int transport_message(ili9486l_ctx_t* ctx, struct spi_ioc_transfer* transfers, int count) {
+    if (ctx->trace && spi_trace_message(ctx->trace, transfers, count) < 0) {
+        printf("Warning: SPI trace write failed, recording stopped\n");
+        spi_trace_close(ctx->trace);
+        ctx->trace = NULL;
+    }
+    
+    return ctx->transport->message(ctx, transfers, count);
+}
+
+// SPI helper functions
+int spi_init(ili9486l_ctx_t* ctx) {
+    // Stripes never exceed what spidev accepts in one message
+    uint32_t bufsiz = spi_get_bufsiz();
+    if (ctx->stripe_size == 0 || ctx->stripe_size > bufsiz) {
+        ctx->stripe_size = bufsiz;
+    }
+    if (ctx->stripe_size > DMA_BUFFER_SIZE) {
+        ctx->stripe_size = DMA_BUFFER_SIZE;
+    }
+    ctx->stripe_size &= ~1u; // Whole pixels only
+    
+    // Allocate transfer buffers (two stripes for ping-pong streaming)
+    ctx->tx_buffer = malloc(ctx->stripe_size * 2);
+    ctx->rx_buffer = malloc(DMA_BUFFER_SIZE);
+    
+    if (!ctx->tx_buffer || !ctx->rx_buffer) {
+        perror("Failed to allocate SPI buffers");
+        spi_destroy(ctx);
+        return -1;
+    }
+    
+    return 0;
+}
+
+void spi_destroy(ili9486l_ctx_t* ctx) {
+    spi_stream_stop(ctx);
+    
+    if (ctx->tx_buffer) {
+        free(ctx->tx_buffer);
+        ctx->tx_buffer = NULL;
+    }
+    
+    if (ctx->rx_buffer) {
+        free(ctx->rx_buffer);
+        ctx->rx_buffer = NULL;
+    }
+}
+
+int spi_transfer(ili9486l_ctx_t* ctx, const uint8_t* tx_data, uint8_t* rx_data, uint32_t length) {
+    struct spi_ioc_transfer tr = {
+        .tx_buf = (unsigned long)tx_data,
+        .rx_buf = (unsigned long)rx_data,
+        .len = length,
+        .speed_hz = ctx->spi_speed,
+        .bits_per_word = SPI_BITS_PER_WORD,
+        .delay_usecs = 0,
+    };
+    
+    if (transport_message(ctx, &tr, 1) < 0) {
+        return -1;
+    }
+    
+    ctx->stats.spi_ioctls++;
+    ctx->stats.spi_bytes += length;
+    
+    return 0;
+}
+
+uint32_t spi_get_bufsiz(void) {
+    char value_str[16] = {0};
+    uint32_t bufsiz = SPI_DEFAULT_BUFSIZ;
+    int fd;
+    
+    fd = open(SPI_BUFSIZ_PARAM, O_RDONLY);
+    if (fd < 0) {
+        return bufsiz;
+    }
+    
+    if (read(fd, value_str, sizeof(value_str) - 1) > 0) {
+        long value = atol(value_str);
+        if (value > 0) {
+            bufsiz = value;
+        }
+    }
+    
+    close(fd);
+    return bufsiz;
+}
+
+// Striped pixel streaming
+static void* spi_stream_thread(void* arg) {
+    ili9486l_ctx_t* ctx = (ili9486l_ctx_t*)arg;
+    spi_stream_t* stream = &ctx->stream;
+    
+    pthread_mutex_lock(&stream->lock);
+    
+    while (true) {
+        while (stream->running && !stream->pending) {
+            pthread_cond_wait(&stream->cond, &stream->lock);
+        }
+        
+        if (!stream->pending) {
+            break; // Stopped with nothing queued
+        }
+        
+        const uint8_t* data = stream->pending;
+        uint32_t length = stream->pending_length;
+        stream->pending = NULL;
+        stream->busy = true;
+        pthread_mutex_unlock(&stream->lock);
+        
+        int result = spi_transfer(ctx, data, NULL, length);
+        
+        pthread_mutex_lock(&stream->lock);
+        stream->busy = false;
+        if (result < 0) {
+            stream->error = -1;
+        }
+        pthread_cond_broadcast(&stream->cond);
+    }
+    
+    pthread_mutex_unlock(&stream->lock);
+    return NULL;
+}
+
+int spi_stream_start(ili9486l_ctx_t* ctx) {
+    spi_stream_t* stream = &ctx->stream;
+    
+    if (pthread_mutex_init(&stream->lock, NULL) != 0) {
+        return -1;
+    }
+    
+    if (pthread_cond_init(&stream->cond, NULL) != 0) {
+        pthread_mutex_destroy(&stream->lock);
+        return -1;
+    }
+    
+    stream->running = true;
+    stream->busy = false;
+    stream->pending = NULL;
+    stream->error = 0;
+    
+    if (pthread_create(&stream->thread, NULL, spi_stream_thread, ctx) != 0) {
+        perror("Failed to create SPI stream thread");
+        pthread_cond_destroy(&stream->cond);
+        pthread_mutex_destroy(&stream->lock);
+        stream->running = false;
+        return -1;
+    }
+    
+    ctx->stream_enabled = true;
+    return 0;
+}
+
+void spi_stream_stop(ili9486l_ctx_t* ctx) {
+    spi_stream_t* stream = &ctx->stream;
+    
+    if (!ctx->stream_enabled) return;
+    
+    pthread_mutex_lock(&stream->lock);
+    stream->running = false;
+    pthread_cond_broadcast(&stream->cond);
+    pthread_mutex_unlock(&stream->lock);
+    
+    pthread_join(stream->thread, NULL);
+    pthread_cond_destroy(&stream->cond);
+    pthread_mutex_destroy(&stream->lock);
+    ctx->stream_enabled = false;
+}
+
+// Wait until the worker has drained every queued stripe
+static int spi_stream_wait(spi_stream_t* stream) {
+    pthread_mutex_lock(&stream->lock);
+    while (stream->pending || stream->busy) {
+        pthread_cond_wait(&stream->cond, &stream->lock);
+    }
+    int error = stream->error;
+    stream->error = 0;
+    pthread_mutex_unlock(&stream->lock);
+    
+    return error;
+}
+
+static void spi_stream_queue(spi_stream_t* stream, const uint8_t* data, uint32_t length) {
+    pthread_mutex_lock(&stream->lock);
+    stream->pending = data;
+    stream->pending_length = length;
+    pthread_cond_broadcast(&stream->cond);
+    pthread_mutex_unlock(&stream->lock);
+}
+
+// Batched SPI transport
+static int spi_batch_append(ili9486l_ctx_t* ctx, const uint8_t* data, uint32_t length, uint8_t dc, bool copy) {
+    spi_batch_t* batch = &ctx->batch;
+    
+    if (batch->count == SPI_BATCH_MAX_SEGMENTS ||
+        (copy && batch->scratch_used + length > SPI_BATCH_SCRATCH_SIZE)) {
+        // Batch is full, flush what we have so far
+        if (spi_batch_submit(ctx) < 0) {
+            return -1;
+        }
+    }
+    
+    if (copy) {
+        if (length > SPI_BATCH_SCRATCH_SIZE) {
+            return -1;
+        }
+        memcpy(&batch->scratch[batch->scratch_used], data, length);
+        data = &batch->scratch[batch->scratch_used];
+        batch->scratch_used += length;
+    }
+    
+    spi_segment_t* seg = &batch->segments[batch->count++];
+    seg->data = data;
+    seg->length = length;
+    seg->dc = dc;
+    seg->bits = SPI_BITS_PER_WORD;
+    seg->cs_change = false;
+    
+    return 0;
+}
+
+int spi_batch_command(ili9486l_ctx_t* ctx, uint8_t command, const uint8_t* params, uint32_t length) {
+    spi_batch_t* batch = &ctx->batch;
+    
+    // Terminate the previous command so back-to-back commands are separate transactions
+    if (batch->count > 0) {
+        batch->segments[batch->count - 1].cs_change = true;
+    }
+    
+    if (spi_batch_append(ctx, &command, 1, 0, true) < 0) {
+        return -1;
+    }
+    
+    if (length > 0 && params) {
+        if (spi_batch_append(ctx, params, length, 1, true) < 0) {
+            return -1;
+        }
+    }
+    
+    return 0;
+}
+
+int spi_batch_data(ili9486l_ctx_t* ctx, const uint8_t* data, uint32_t length) {
+    if (length == 0) {
+        return 0;
+    }
+    
+    return spi_batch_append(ctx, data, length, 1, false);
+}
+
+// Queue pixels as 16-bit words straight from the caller's buffer. The
+// buffer must stay untouched until the batch is submitted.
+int spi_batch_pixels(ili9486l_ctx_t* ctx, const uint16_t* pixels, uint32_t count) {
+    if (count == 0) {
+        return 0;
+    }
+    
+    if (spi_batch_append(ctx, (const uint8_t*)pixels, count * 2, 1, false) < 0) {
+        return -1;
+    }
+    
+    ctx->batch.segments[ctx->batch.count - 1].bits = SPI_PIXEL_BITS;
+    return 0;
+}
+
+int spi_batch_submit(ili9486l_ctx_t* ctx) {
+    spi_batch_t* batch = &ctx->batch;
+    struct spi_ioc_transfer tr[SPI_BATCH_MAX_SEGMENTS];
+    int result = 0;
+    int i = 0;
+    
+    while (i < batch->count) {
+        // Collect the run of segments sharing one DC level
+        uint8_t dc = batch->segments[i].dc;
+        uint32_t total = 0;
+        int n = 0;
+        
+        while (i + n < batch->count && batch->segments[i + n].dc == dc) {
+            const spi_segment_t* seg = &batch->segments[i + n];
+            
+            memset(&tr[n], 0, sizeof(tr[n]));
+            tr[n].tx_buf = (unsigned long)seg->data;
+            tr[n].len = seg->length;
+            tr[n].speed_hz = ctx->spi_speed;
+            tr[n].bits_per_word = seg->bits;
+            tr[n].cs_change = seg->cs_change;
+            total += seg->length;
+            n++;
+        }
+        
+        // CS is released at the end of every message anyway
+        tr[n - 1].cs_change = 0;
+        
+        if (set_dc(ctx, dc) < 0) {
+            result = -1;
+            break;
+        }
+        
+        if (transport_message(ctx, tr, n) < 0) {
+            result = -1;
+            break;
+        }
+        
+        ctx->stats.spi_ioctls++;
+        ctx->stats.spi_bytes += total;
+        i += n;
+    }
+    
+    batch->count = 0;
+    batch->scratch_used = 0;
+    
+    return result;
+}
+
+// Display control functions
+int ili9486l_write_command(ili9486l_ctx_t* ctx, uint8_t command) {
+    // Set DC low for command
+    if (set_dc(ctx, 0) < 0) {
+        return -1;
+    }
+    
+    // Send command
+    if (spi_transfer(ctx, &command, NULL, 1) < 0) {
+        return -1;
+    }
+    
+    return 0;
+}
+
+int ili9486l_write_data(ili9486l_ctx_t* ctx, const uint8_t* data, uint32_t length) {
+    // Set DC high for data
+    if (set_dc(ctx, 1) < 0) {
+        return -1;
+    }
+    
+    // Send data
+    if (spi_transfer(ctx, data, NULL, length) < 0) {
         return -1;
     }
     
-    // Set max speed
-    if (ioctl(ctx->spi_fd, SPI_IOC_WR_MAX_SPEED_HZ, &speed) < 0) {
-        perror("Failed to set SPI speed");
-        close(ctx->spi_fd);
-        return -1;
+    return 0;
+}
+
+int ili9486l_reset(ili9486l_ctx_t* ctx) {
+    // Hardware reset
+    gpio_write_line(ctx, GPIO_RST, 0);
+    delay_ms(10);
+    gpio_write_line(ctx, GPIO_RST, 1);
+    delay_ms(120);
+    
+    // Controller registers are back to their defaults
+    invalidate_window(ctx);
+    ctx->shadow_valid = false;
+    
+    return 0;
+}
+
+// Configuration sequence for ILI9486L
+typedef struct {
+    uint8_t command;
+    uint8_t length;
+    uint8_t params[15];
+    uint8_t delay_ms;  // Delay after the command; flushes the batch
+} init_command_t;
+
+static const init_command_t init_sequence[] = {
+    { ILI9486L_SLPOUT,  0, { 0 }, 120 },                                   // Sleep out
+    { ILI9486L_PIXFMT,  1, { 0x55 }, 0 },                                  // 16-bit RGB565
+    { ILI9486L_PWCTR1,  2, { 0x0F, 0x0F }, 0 },                            // Power Control 1
+    { ILI9486L_PWCTR2,  1, { 0x41 }, 0 },                                  // Power Control 2
+    { ILI9486L_VMCTR1,  3, { 0x00, 0x35, 0x80 }, 0 },                      // VCOM Control 1
+    { ILI9486L_VMCTR2,  1, { 0x00 }, 0 },                                  // VCOM Control 2
+    { ILI9486L_FRMCTR1, 2, { 0x00, 0x1B }, 0 },                            // Frame Rate Control
+    { ILI9486L_DFUNCTR, 3, { 0x00, 0x02, 0x3B }, 0 },                      // Display Function Control
+    { ILI9486L_GMCTRP1, 15, { 0x0F, 0x24, 0x1C, 0x0A, 0x0F, 0x08, 0x43, 0x88,
+                              0x32, 0x0F, 0x10, 0x06, 0x0F, 0x07, 0x00 }, 0 }, // Positive Gamma
+    { ILI9486L_GMCTRN1, 15, { 0x0F, 0x38, 0x30, 0x09, 0x0F, 0x0F, 0x4E, 0x77,
+                              0x3C, 0x07, 0x10, 0x05, 0x23, 0x1B, 0x00 }, 0 }, // Negative Gamma
+};
+
+int ili9486l_configure(ili9486l_ctx_t* ctx) {
+    for (size_t i = 0; i < sizeof(init_sequence) / sizeof(init_sequence[0]); i++) {
+        const init_command_t* cmd = &init_sequence[i];
+        
+        if (spi_batch_command(ctx, cmd->command, cmd->params, cmd->length) < 0) return -1;
+        
+        if (cmd->delay_ms > 0) {
+            if (spi_batch_submit(ctx) < 0) return -1;
+            delay_ms(cmd->delay_ms);
+        }
+    }
+    
+    // Set rotation
+    if (queue_rotation(ctx, ctx->rotation) < 0) return -1;
+    
+    // Display on
+    if (spi_batch_command(ctx, ILI9486L_DISPON, NULL, 0) < 0) return -1;
+    if (spi_batch_submit(ctx) < 0) return -1;
+    delay_ms(100);
+    
+    return 0;
+}
+
+static int queue_rotation(ili9486l_ctx_t* ctx, uint8_t rotation) {
+    uint8_t madctl = ILI9486L_MADCTL_BGR;
+    
+    switch (rotation) {
+        case 0: // Portrait
+            madctl |= ILI9486L_MADCTL_MX;
+            ctx->width = DISPLAY_WIDTH;
+            ctx->height = DISPLAY_HEIGHT;
+            break;
+        case 1: // Landscape
+            madctl |= ILI9486L_MADCTL_MV;
+            ctx->width = DISPLAY_HEIGHT;
+            ctx->height = DISPLAY_WIDTH;
+            break;
+        case 2: // Portrait inverted
+            madctl |= ILI9486L_MADCTL_MY;
+            ctx->width = DISPLAY_WIDTH;
+            ctx->height = DISPLAY_HEIGHT;
+            break;
+        case 3: // Landscape inverted
+            madctl |= ILI9486L_MADCTL_MX | ILI9486L_MADCTL_MY | ILI9486L_MADCTL_MV;
+            ctx->width = DISPLAY_HEIGHT;
+            ctx->height = DISPLAY_WIDTH;
+            break;
+    }
+    
+    // The scroll area is tied to the old row direction; drop it
+    if (rotation != ctx->rotation && ctx->scroll_height) {
+        ctx->scroll_top = 0;
+        ctx->scroll_height = 0;
+        ctx->scroll_offset = 0;
+        if (queue_scroll(ctx) < 0) return -1;
+    }
+    
+    ctx->rotation = rotation;
+    invalidate_window(ctx);
+    ctx->shadow_valid = false;
+    
+    // Pending damage is in the old orientation; an empty region flushes
+    // the whole screen on the next refresh
+    clear_dirty_rect(ctx);
+    return spi_batch_command(ctx, ILI9486L_MADCTL, &madctl, 1);
+}
+
+int ili9486l_set_rotation(ili9486l_ctx_t* ctx, uint8_t rotation) {
+    if (queue_rotation(ctx, rotation) < 0) {
+        return -1;
+    }
+    
+    return spi_batch_submit(ctx);
+}
+
+static void invalidate_window(ili9486l_ctx_t* ctx) {
+    ctx->window_x0 = -1;
+    ctx->window_y0 = -1;
+    ctx->window_x1 = -1;
+    ctx->window_y1 = -1;
+}
+
+static int queue_window(ili9486l_ctx_t* ctx, int x, int y, int width, int height) {
+    uint8_t data[4];
+    int x1 = x + width - 1;
+    int y1 = y + height - 1;
+    
+    // RAMWR restarts at the window origin, so an unchanged
+    // column or page range does not need to be sent again
+    if (x != ctx->window_x0 || x1 != ctx->window_x1) {
+        // Column address set
+        data[0] = (x >> 8) & 0xFF;
+        data[1] = x & 0xFF;
+        data[2] = (x1 >> 8) & 0xFF;
+        data[3] = x1 & 0xFF;
+        if (spi_batch_command(ctx, ILI9486L_CASET, data, 4) < 0) return -1;
+        ctx->window_x0 = x;
+        ctx->window_x1 = x1;
+    }
+    
+    if (y != ctx->window_y0 || y1 != ctx->window_y1) {
+        // Page address set
+        data[0] = (y >> 8) & 0xFF;
+        data[1] = y & 0xFF;
+        data[2] = (y1 >> 8) & 0xFF;
+        data[3] = y1 & 0xFF;
+        if (spi_batch_command(ctx, ILI9486L_PASET, data, 4) < 0) return -1;
+        ctx->window_y0 = y;
+        ctx->window_y1 = y1;
+    }
+    
+    // Memory write
+    if (spi_batch_command(ctx, ILI9486L_RAMWR, NULL, 0) < 0) return -1;
+    
+    return 0;
+}
+
+int ili9486l_set_window(ili9486l_ctx_t* ctx, int x, int y, int width, int height) {
+    if (queue_window(ctx, x, y, width, height) < 0) {
+        invalidate_window(ctx);
+        return -1;
+    }
+    
+    if (spi_batch_submit(ctx) < 0) {
+        invalidate_window(ctx);
+        return -1;
+    }
+    
+    return 0;
+}
+
+static void frame_begin(ili9486l_ctx_t* ctx) {
+    ctx->frame_start_spi_ioctls = ctx->stats.spi_ioctls;
+    ctx->frame_start_gpio_syscalls = ctx->stats.gpio_syscalls;
+    ctx->frame_start_spi_bytes = ctx->stats.spi_bytes;
+    ctx->frame_start_time = get_time_ns();
+    if (ctx->transport->bus_time_ns) {
+        ctx->frame_start_bus_ns = ctx->transport->bus_time_ns(ctx);
+    }
+}
+
+static void frame_end(ili9486l_ctx_t* ctx) {
+    uint64_t spi_ioctls = ctx->stats.spi_ioctls - ctx->frame_start_spi_ioctls;
+    uint64_t gpio_syscalls = ctx->stats.gpio_syscalls - ctx->frame_start_gpio_syscalls;
+    uint64_t spi_bytes = ctx->stats.spi_bytes - ctx->frame_start_spi_bytes;
+    uint64_t now = get_time_ns();
+    
+    ctx->stats.last_frame_spi_ioctls = spi_ioctls;
+    ctx->stats.last_frame_syscalls = spi_ioctls + gpio_syscalls;
+    ctx->stats.last_frame_ns = now - ctx->frame_start_time;
+    if (ctx->transport->bus_time_ns) {
+        // The transport models the bus, including per-transfer gaps
+        ctx->stats.last_frame_wire_ns = ctx->transport->bus_time_ns(ctx) - ctx->frame_start_bus_ns;
+    } else {
+        ctx->stats.last_frame_wire_ns = spi_bytes * 8 * 1000000000ULL / ctx->spi_speed;
+    }
+    ctx->stats.last_frame_bytes = spi_bytes;
+    ctx->stats.last_frame_rects = ctx->frame_rects;
+    
+    // Update performance tracking
+    ctx->frame_count++;
+    ctx->stats.frames++;
+    ctx->last_refresh_time = now;
+}
+
+// Shadow frame
+static void shadow_update(ili9486l_ctx_t* ctx, const uint16_t* source, int x, int y, int width, int height) {
+    if (!ctx->shadow) return;
+    
+    for (int row = 0; row < height; row++) {
+        uint32_t offset = (y + row) * ctx->width + x;
+        memcpy(&ctx->shadow[offset], &source[offset], width * sizeof(uint16_t));
+    }
+}
+
+// Find the first and last pixel of a row that differ from the shadow.
+// Whole chunks are compared with memcmp, which is vectorized in libc,
+// so clean stretches are skipped at memory bandwidth.
+static bool shadow_row_span(const uint16_t* src, const uint16_t* shadow, int width, int* first, int* last) {
+    int left = 0;
+    int right = width;
+    
+    while (left < right) {
+        int n = right - left < SHADOW_CHUNK_PIXELS ? right - left : SHADOW_CHUNK_PIXELS;
+        if (memcmp(&src[left], &shadow[left], n * sizeof(uint16_t)) != 0) break;
+        left += n;
+    }
+    
+    if (left == right) {
+        return false; // Row unchanged
     }
     
-    // Allocate transfer buffers
-    ctx->tx_buffer = malloc(DMA_BUFFER_SIZE);
-    ctx->rx_buffer = malloc(DMA_BUFFER_SIZE);
+    while (src[left] == shadow[left]) left++;
     
-    if (!ctx->tx_buffer || !ctx->rx_buffer) {
-        perror("Failed to allocate SPI buffers");
-        spi_destroy(ctx);
-        return -1;
+    while (right - left > SHADOW_CHUNK_PIXELS) {
+        int start = right - SHADOW_CHUNK_PIXELS;
+        if (memcmp(&src[start], &shadow[start], SHADOW_CHUNK_PIXELS * sizeof(uint16_t)) != 0) break;
+        right = start;
     }
     
-    return 0;
+    while (src[right - 1] == shadow[right - 1]) right--;
+    
+    *first = left;
+    *last = right - 1;
+    return true;
 }
 
-void spi_destroy(ili9486l_ctx_t* ctx) {
-    if (ctx->spi_fd >= 0) {
-        close(ctx->spi_fd);
-        ctx->spi_fd = -1;
+// Shrink a damage region to the row spans that actually changed. Spans are
+// fed back through damage_region_add so adjacent rows coalesce under the
+// same window-setup cost model.
+static void shadow_diff_region(ili9486l_ctx_t* ctx, const uint16_t* source, const damage_region_t* in,
+                               damage_region_t* out) {
+    out->count = 0;
+    
+    for (int i = 0; i < in->count; i++) {
+        const damage_rect_t* rect = &in->rects[i];
+        
+        for (int row = 0; row < rect->height; row++) {
+            uint32_t offset = (rect->y + row) * ctx->width + rect->x;
+            int first, last;
+            
+            if (shadow_row_span(&source[offset], &ctx->shadow[offset], rect->width, &first, &last)) {
+                damage_region_add(out, rect->x + first, rect->y + row, last - first + 1, 1,
+                                  ctx->damage_setup_cost);
+            }
+        }
     }
+}
+
+static uint32_t region_bytes(const damage_region_t* region) {
+    uint32_t bytes = 0;
     
-    if (ctx->tx_buffer) {
-        free(ctx->tx_buffer);
-        ctx->tx_buffer = NULL;
+    for (int i = 0; i < region->count; i++) {
+        bytes += region->rects[i].width * region->rects[i].height * 2;
     }
     
-    if (ctx->rx_buffer) {
-        free(ctx->rx_buffer);
-        ctx->rx_buffer = NULL;
+    return bytes;
+}
+
+// Convert count pixels starting at pixel index first of the rect into panel byte order
+static void convert_pixels(ili9486l_ctx_t* ctx, const uint16_t* source, int x, int y, int width,
+                           uint32_t first, uint32_t count, uint8_t* dst) {
+    int row = first / width;
+    int col = first % width;
+    
+    ctx->stats.bytes_staged += count * 2;
+    
+    while (count > 0) {
+        const uint16_t* src = &source[(y + row) * ctx->width + x + col];
+        uint32_t run = width - col;
+        if (run > count) run = count;
+        
+        // Convert from little-endian to big-endian for SPI
+        ctx->kernels->swap16_copy(dst, src, run);
+        
+        dst += run * 2;
+        count -= run;
+        col = 0;
+        row++;
     }
 }
 
-int spi_transfer(ili9486l_ctx_t* ctx, const uint8_t* tx_data, uint8_t* rx_data, uint32_t length) {
-    struct spi_ioc_transfer tr = {
-        .tx_buf = (unsigned long)tx_data,
-        .rx_buf = (unsigned long)rx_data,
-        .len = length,
-        .speed_hz = ctx->spi_speed,
-        .bits_per_word = SPI_BITS_PER_WORD,
-        .delay_usecs = 0,
-    };
+// Send source rows y..y+height-1 to the panel starting at GRAM page
+static int flush_rows(ili9486l_ctx_t* ctx, const uint16_t* source_buffer, int x, int y, int width, int height,
+                      int page) {
+    uint32_t pixel_count = width * height;
+    uint32_t stripe_pixels = ctx->stripe_size / 2;
     
-    if (ioctl(ctx->spi_fd, SPI_IOC_MESSAGE(1), &tr) < 0) {
-        perror("SPI transfer failed");
-        return -1;
+    if (queue_window(ctx, x, page, width, height) < 0) {
+        invalidate_window(ctx);
+        return RPI_DISPLAY_ERROR_SPI;
     }
     
-    return 0;
-}
-
-// Display control functions
-int ili9486l_write_command(ili9486l_ctx_t* ctx, uint8_t command) {
-    // Set DC low for command
-    gpio_set_value(GPIO_DC, 0);
+    if (ctx->zero_copy && (width == (int)ctx->width || height == 1)) {
+        // The rect is one contiguous run of the source buffer, so hand it
+        // to the kernel as-is; 16-bit words go out in panel byte order
+        const uint16_t* pixels = &source_buffer[y * ctx->width + x];
+        
+        for (uint32_t first = 0; first < pixel_count; first += stripe_pixels) {
+            uint32_t count = pixel_count - first;
+            if (count > stripe_pixels) count = stripe_pixels;
+            
+            if (spi_batch_pixels(ctx, &pixels[first], count) < 0 ||
+                spi_batch_submit(ctx) < 0) {
+                invalidate_window(ctx);
+                return RPI_DISPLAY_ERROR_SPI;
+            }
+        }
+        
+        shadow_update(ctx, source_buffer, x, y, width, height);
+        return RPI_DISPLAY_OK;
+    }
     
-    // Send command
-    if (spi_transfer(ctx, &command, NULL, 1) < 0) {
-        return -1;
+    if (pixel_count <= stripe_pixels || !ctx->stream_enabled) {
+        // Small rects go out with the window setup, one stripe at a time
+        for (uint32_t first = 0; first < pixel_count; first += stripe_pixels) {
+            uint32_t count = pixel_count - first;
+            if (count > stripe_pixels) count = stripe_pixels;
+            
+            convert_pixels(ctx, source_buffer, x, y, width, first, count, ctx->tx_buffer);
+            if (spi_batch_data(ctx, ctx->tx_buffer, count * 2) < 0 ||
+                spi_batch_submit(ctx) < 0) {
+                invalidate_window(ctx);
+                return RPI_DISPLAY_ERROR_SPI;
+            }
+        }
+        
+        shadow_update(ctx, source_buffer, x, y, width, height);
+        return RPI_DISPLAY_OK;
     }
     
-    return 0;
+    // Send the window setup and raise DC, then let the worker clock out
+    // stripe N while stripe N+1 is being converted
+    if (spi_batch_submit(ctx) < 0 || set_dc(ctx, 1) < 0) {
+        invalidate_window(ctx);
+        return RPI_DISPLAY_ERROR_SPI;
+    }
+    
+    int half = 0;
+    for (uint32_t first = 0; first < pixel_count; first += stripe_pixels) {
+        uint32_t count = pixel_count - first;
+        if (count > stripe_pixels) count = stripe_pixels;
+        
+        uint8_t* stripe = ctx->tx_buffer + half * ctx->stripe_size;
+        convert_pixels(ctx, source_buffer, x, y, width, first, count, stripe);
+        
+        // The other half must be on the wire before this one is queued
+        if (spi_stream_wait(&ctx->stream) < 0) {
+            invalidate_window(ctx);
+            return RPI_DISPLAY_ERROR_SPI;
+        }
+        spi_stream_queue(&ctx->stream, stripe, count * 2);
+        half ^= 1;
+    }
+    
+    if (spi_stream_wait(&ctx->stream) < 0) {
+        invalidate_window(ctx);
+        return RPI_DISPLAY_ERROR_SPI;
+    }
+    
+    shadow_update(ctx, source_buffer, x, y, width, height);
+    return RPI_DISPLAY_OK;
 }
 
-int ili9486l_write_data(ili9486l_ctx_t* ctx, const uint8_t* data, uint32_t length) {
-    // Set DC high for data
-    gpio_set_value(GPIO_DC, 1);
+// GRAM page holding logical row y
+static int scroll_page(const ili9486l_ctx_t* ctx, int y) {
+    int row = y - ctx->scroll_top;
     
-    // Send data
-    if (spi_transfer(ctx, data, NULL, length) < 0) {
-        return -1;
+    if (row < 0 || row >= ctx->scroll_height) {
+        return y;
     }
     
-    return 0;
+    return ctx->scroll_top + (row + ctx->scroll_offset) % ctx->scroll_height;
 }
 
-static int write_command_data(ili9486l_ctx_t* ctx, uint8_t cmd, const uint8_t* data, int len) {
-    if (ili9486l_write_command(ctx, cmd) < 0) {
-        return -1;
+static int flush_rect(ili9486l_ctx_t* ctx, const uint16_t* source_buffer, int x, int y, int width, int height) {
+    if (x < 0 || y < 0 || width <= 0 || height <= 0 ||
+        x + width > (int)ctx->width || y + height > (int)ctx->height) {
+        return RPI_DISPLAY_ERROR_INVALID;
     }
     
-    if (len > 0 && data) {
-        if (ili9486l_write_data(ctx, data, len) < 0) {
-            return -1;
+    if (ctx->scroll_height == 0) {
+        return flush_rows(ctx, source_buffer, x, y, width, height, y);
+    }
+    
+    // Inside the scroll area rows are contiguous in GRAM up to the ring's
+    // wrap point, so a rect splits into at most four windows
+    int area_end = ctx->scroll_top + ctx->scroll_height;
+    
+    while (height > 0) {
+        int page = scroll_page(ctx, y);
+        int rows = height;
+        
+        if (y < ctx->scroll_top) {
+            if (rows > ctx->scroll_top - y) rows = ctx->scroll_top - y;
+        } else if (y < area_end) {
+            if (rows > area_end - page) rows = area_end - page;
+            if (rows > area_end - y) rows = area_end - y;
         }
+        
+        int result = flush_rows(ctx, source_buffer, x, y, width, rows, page);
+        if (result != RPI_DISPLAY_OK) return result;
+        
+        y += rows;
+        height -= rows;
     }
     
-    return 0;
+    return RPI_DISPLAY_OK;
 }
 
-int ili9486l_reset(ili9486l_ctx_t* ctx) {
-    // Hardware reset
-    gpio_set_value(GPIO_RST, 0);
-    delay_ms(10);
-    gpio_set_value(GPIO_RST, 1);
-    delay_ms(120);
+// Scrolling
+// VSCRDEF and VSCRSADD count native panel rows; with MY set (portrait
+// inverted) logical rows run bottom-up, so the area and start are mirrored
+static int queue_scroll(ili9486l_ctx_t* ctx) {
+    int top = ctx->scroll_top;
+    int height = ctx->scroll_height ? ctx->scroll_height : DISPLAY_HEIGHT;
+    int start = top + ctx->scroll_offset;
+    uint8_t data[6];
+    
+    if (ctx->rotation == ROTATE_180) {
+        top = DISPLAY_HEIGHT - ctx->scroll_top - height;
+        start = top + (height - ctx->scroll_offset) % height;
+    }
+    int bottom = DISPLAY_HEIGHT - top - height;
+    
+    data[0] = (top >> 8) & 0xFF;
+    data[1] = top & 0xFF;
+    data[2] = (height >> 8) & 0xFF;
+    data[3] = height & 0xFF;
+    data[4] = (bottom >> 8) & 0xFF;
+    data[5] = bottom & 0xFF;
+    if (spi_batch_command(ctx, ILI9486L_VSCRDEF, data, 6) < 0) return -1;
+    
+    data[0] = (start >> 8) & 0xFF;
+    data[1] = start & 0xFF;
+    return spi_batch_command(ctx, ILI9486L_VSCRSADD, data, 2);
+}
+
+// Rotate full-width rows so row i takes what was in row i + dy
+static int rotate_rows(uint16_t* rows, int width, int height, int dy) {
+    int count = dy > 0 ? dy : -dy;
+    size_t row_bytes = width * sizeof(uint16_t);
+    uint16_t* saved = malloc(count * row_bytes);
+    
+    if (!saved) return -1;
+    
+    if (dy > 0) {
+        memcpy(saved, rows, count * row_bytes);
+        memmove(rows, rows + count * width, (height - count) * row_bytes);
+        memcpy(rows + (height - count) * width, saved, count * row_bytes);
+    } else {
+        memcpy(saved, rows + (height - count) * width, count * row_bytes);
+        memmove(rows + count * width, rows, (height - count) * row_bytes);
+        memcpy(rows, saved, count * row_bytes);
+    }
     
+    free(saved);
     return 0;
 }
 
-int ili9486l_configure(ili9486l_ctx_t* ctx) {
-    // Configuration sequence for ILI9486L
-    uint8_t data[16];
+// Pending damage follows the content it covers. Inside the band the old
+// rects are replaced by the shifted ones, since GRAM there already moved.
+static void damage_scroll(ili9486l_ctx_t* ctx, int top, int height, int dy) {
+    damage_region_t pending = ctx->damage;
+    int bottom = top + height;
     
-    // Sleep out
-    if (write_command_data(ctx, ILI9486L_SLPOUT, NULL, 0) < 0) return -1;
-    delay_ms(120);
+    clear_dirty_rect(ctx);
     
-    // Pixel format: 16-bit RGB565
-    data[0] = 0x55;
-    if (write_command_data(ctx, ILI9486L_PIXFMT, data, 1) < 0) return -1;
-    
-    // Power Control 1
-    data[0] = 0x0F;
-    data[1] = 0x0F;
-    if (write_command_data(ctx, ILI9486L_PWCTR1, data, 2) < 0) return -1;
-    
-    // Power Control 2
-    data[0] = 0x41;
-    if (write_command_data(ctx, ILI9486L_PWCTR2, data, 1) < 0) return -1;
-    
-    // VCOM Control 1
-    data[0] = 0x00;
-    data[1] = 0x35;
-    data[2] = 0x80;
-    if (write_command_data(ctx, ILI9486L_VMCTR1, data, 3) < 0) return -1;
-    
-    // VCOM Control 2
-    data[0] = 0x00;
-    if (write_command_data(ctx, ILI9486L_VMCTR2, data, 1) < 0) return -1;
-    
-    // Frame Rate Control
-    data[0] = 0x00;
-    data[1] = 0x1B;
-    if (write_command_data(ctx, ILI9486L_FRMCTR1, data, 2) < 0) return -1;
-    
-    // Display Function Control
-    data[0] = 0x00;
-    data[1] = 0x02;
-    data[2] = 0x3B;
-    if (write_command_data(ctx, ILI9486L_DFUNCTR, data, 3) < 0) return -1;
-    
-    // Positive Gamma Correction
-    data[0] = 0x0F; data[1] = 0x24; data[2] = 0x1C; data[3] = 0x0A;
-    data[4] = 0x0F; data[5] = 0x08; data[6] = 0x43; data[7] = 0x88;
-    data[8] = 0x32; data[9] = 0x0F; data[10] = 0x10; data[11] = 0x06;
-    data[12] = 0x0F; data[13] = 0x07; data[14] = 0x00;
-    if (write_command_data(ctx, ILI9486L_GMCTRP1, data, 15) < 0) return -1;
-    
-    // Negative Gamma Correction
-    data[0] = 0x0F; data[1] = 0x38; data[2] = 0x30; data[3] = 0x09;
-    data[4] = 0x0F; data[5] = 0x0F; data[6] = 0x4E; data[7] = 0x77;
-    data[8] = 0x3C; data[9] = 0x07; data[10] = 0x10; data[11] = 0x05;
-    data[12] = 0x23; data[13] = 0x1B; data[14] = 0x00;
-    if (write_command_data(ctx, ILI9486L_GMCTRN1, data, 15) < 0) return -1;
+    for (int i = 0; i < pending.count; i++) {
+        const damage_rect_t* rect = &pending.rects[i];
+        int rect_bottom = rect->y + rect->height;
+        int y0 = rect->y > top ? rect->y : top;
+        int y1 = rect_bottom < bottom ? rect_bottom : bottom;
+        
+        // Parts above and below the band stay where they are
+        if (rect->y < top) {
+            mark_dirty_rect(ctx, rect->x, rect->y, rect->width, (rect_bottom < top ? rect_bottom : top) - rect->y);
+        }
+        if (rect_bottom > bottom) {
+            int start = rect->y > bottom ? rect->y : bottom;
+            mark_dirty_rect(ctx, rect->x, start, rect->width, rect_bottom - start);
+        }
+        
+        if (y0 >= y1) continue;
+        
+        y0 -= dy;
+        y1 -= dy;
+        if (y0 < top) y0 = top;
+        if (y1 > bottom) y1 = bottom;
+        
+        if (y0 < y1) {
+            mark_dirty_rect(ctx, rect->x, y0, rect->width, y1 - y0);
+        }
+    }
+}
+
+// Move rows top..top+height-1 up by dy (down if negative). The framebuffers
+// are shifted; the rows uncovered at the trailing edge keep stale content
+// for the caller to redraw. In portrait the panel scrolls itself and only
+// pending damage is carried over; in landscape the scroll axis is across
+// GRAM rows, so the whole area is marked for resend instead.
+int ili9486l_scroll_region(ili9486l_ctx_t* ctx, int top, int height, int dy) {
+    if (top < 0 || height <= 0 || top + height > (int)ctx->height) {
+        return RPI_DISPLAY_ERROR_INVALID;
+    }
     
-    // Set rotation
-    ili9486l_set_rotation(ctx, ctx->rotation);
+    int count = dy > 0 ? dy : -dy;
+    if (count == 0) return RPI_DISPLAY_OK;
     
-    // Display on
-    if (write_command_data(ctx, ILI9486L_DISPON, NULL, 0) < 0) return -1;
-    delay_ms(100);
+    if (count >= height) {
+        mark_dirty_rect(ctx, 0, top, ctx->width, height);
+        return RPI_DISPLAY_OK;
+    }
     
-    return 0;
-}
-
-int ili9486l_set_rotation(ili9486l_ctx_t* ctx, uint8_t rotation) {
-    uint8_t madctl = ILI9486L_MADCTL_BGR;
+    size_t row_bytes = ctx->width * sizeof(uint16_t);
+    uint16_t* buffers[2] = { ctx->framebuffer, ctx->backbuffer };
     
-    switch (rotation) {
-        case 0: // Portrait
-            madctl |= ILI9486L_MADCTL_MX;
-            ctx->width = DISPLAY_WIDTH;
-            ctx->height = DISPLAY_HEIGHT;
-            break;
-        case 1: // Landscape
-            madctl |= ILI9486L_MADCTL_MV;
-            ctx->width = DISPLAY_HEIGHT;
-            ctx->height = DISPLAY_WIDTH;
-            break;
-        case 2: // Portrait inverted
-            madctl |= ILI9486L_MADCTL_MY;
-            ctx->width = DISPLAY_WIDTH;
-            ctx->height = DISPLAY_HEIGHT;
-            break;
-        case 3: // Landscape inverted
-            madctl |= ILI9486L_MADCTL_MX | ILI9486L_MADCTL_MY | ILI9486L_MADCTL_MV;
-            ctx->width = DISPLAY_HEIGHT;
-            ctx->height = DISPLAY_WIDTH;
-            break;
+    for (int i = 0; i < 2; i++) {
+        if (!buffers[i]) continue;
+        
+        uint16_t* area = buffers[i] + top * ctx->width;
+        if (dy > 0) {
+            memmove(area, area + count * ctx->width, (height - count) * row_bytes);
+        } else {
+            memmove(area + count * ctx->width, area, (height - count) * row_bytes);
+        }
     }
     
-    ctx->rotation = rotation;
-    return write_command_data(ctx, ILI9486L_MADCTL, &madctl, 1);
-}
-
-int ili9486l_set_window(ili9486l_ctx_t* ctx, int x, int y, int width, int height) {
-    uint8_t data[4];
+    bool hardware = ctx->rotation == ROTATE_0 || ctx->rotation == ROTATE_180;
     
-    // Column address set
-    data[0] = (x >> 8) & 0xFF;
-    data[1] = x & 0xFF;
-    data[2] = ((x + width - 1) >> 8) & 0xFF;
-    data[3] = (x + width - 1) & 0xFF;
-    if (write_command_data(ctx, ILI9486L_CASET, data, 4) < 0) return -1;
+    if (!hardware) {
+        mark_dirty_rect(ctx, 0, top, ctx->width, height);
+        return RPI_DISPLAY_OK;
+    }
     
-    // Page address set
-    data[0] = (y >> 8) & 0xFF;
-    data[1] = y & 0xFF;
-    data[2] = ((y + height - 1) >> 8) & 0xFF;
-    data[3] = (y + height - 1) & 0xFF;
-    if (write_command_data(ctx, ILI9486L_PASET, data, 4) < 0) return -1;
+    if (top != ctx->scroll_top || height != ctx->scroll_height) {
+        // A new area re-maps GRAM pages, so everything in the old and
+        // new areas is resent
+        if (ctx->scroll_height) {
+            mark_dirty_rect(ctx, 0, ctx->scroll_top, ctx->width, ctx->scroll_height);
+        }
+        mark_dirty_rect(ctx, 0, top, ctx->width, height);
+        ctx->shadow_valid = false;
+        ctx->scroll_top = top;
+        ctx->scroll_height = height;
+        ctx->scroll_offset = 0;
+    } else {
+        damage_scroll(ctx, top, height, dy);
+    }
     
-    // Memory write
-    if (ili9486l_write_command(ctx, ILI9486L_RAMWR) < 0) return -1;
+    // Uncovered rows show GRAM that wrapped round from the other edge
+    int exposed = dy > 0 ? top + height - count : top;
+    mark_dirty_rect(ctx, 0, exposed, ctx->width, count);
     
-    return 0;
+    ctx->scroll_offset = (ctx->scroll_offset + height + dy % height) % height;
+    
+    if (ctx->shadow && ctx->shadow_valid &&
+        rotate_rows(ctx->shadow + top * ctx->width, ctx->width, height, dy) < 0) {
+        ctx->shadow_valid = false;
+    }
+    
+    if (queue_scroll(ctx) < 0 || spi_batch_submit(ctx) < 0) {
+        ctx->shadow_valid = false;
+        return RPI_DISPLAY_ERROR_SPI;
+    }
+    
+    return RPI_DISPLAY_OK;
+}
+
+static const uint16_t* flush_source(ili9486l_ctx_t* ctx) {
+    return ctx->double_buffer_enabled ? ctx->backbuffer : ctx->framebuffer;
 }
 
 int ili9486l_refresh_display(ili9486l_ctx_t* ctx) {
-    if (has_dirty_rect(ctx)) {
-        // Refresh only dirty rectangle
-        int x = ctx->dirty_x_min;
-        int y = ctx->dirty_y_min;
-        int width = ctx->dirty_x_max - ctx->dirty_x_min + 1;
-        int height = ctx->dirty_y_max - ctx->dirty_y_min + 1;
-        
-        int result = ili9486l_refresh_rect(ctx, x, y, width, height);
-        clear_dirty_rect(ctx);
-        return result;
+    int result = ili9486l_refresh_region_from(ctx, flush_source(ctx), &ctx->damage);
+    clear_dirty_rect(ctx);
+    return result;
+}
+
+int ili9486l_refresh_region_from(ili9486l_ctx_t* ctx, const uint16_t* source, const damage_region_t* region) {
+    int result = RPI_DISPLAY_OK;
+    damage_region_t changed;
+    uint32_t skipped = 0;
+    
+    frame_begin(ctx);
+    
+    if (ctx->shadow && ctx->shadow_valid) {
+        // Only send pixels that differ from what the panel already shows
+        damage_region_t full = { .rects = { { 0, 0, ctx->width, ctx->height } }, .count = 1 };
+        const damage_region_t* damaged = region->count > 0 ? region : &full;
+        
+        shadow_diff_region(ctx, source, damaged, &changed);
+        
+        // Merged spans can reach past the damage and send more than it held
+        int64_t saved = (int64_t)region_bytes(damaged) - region_bytes(&changed);
+        skipped = saved > 0 ? saved : 0;
+        region = &changed;
+        
+        for (int i = 0; i < region->count && result == RPI_DISPLAY_OK; i++) {
+            const damage_rect_t* rect = &region->rects[i];
+            result = flush_rect(ctx, source, rect->x, rect->y, rect->width, rect->height);
+        }
+        ctx->frame_rects = region->count;
+    } else if (region->count > 0 && !ctx->shadow) {
+        // Each damaged rect gets its own window
+        for (int i = 0; i < region->count && result == RPI_DISPLAY_OK; i++) {
+            const damage_rect_t* rect = &region->rects[i];
+            result = flush_rect(ctx, source, rect->x, rect->y, rect->width, rect->height);
+        }
+        ctx->frame_rects = region->count;
+    } else {
+        // Full screen refresh; also establishes the shadow frame
+        result = flush_rect(ctx, source, 0, 0, ctx->width, ctx->height);
+        ctx->frame_rects = 1;
+        ctx->shadow_valid = ctx->shadow && result == RPI_DISPLAY_OK;
+    }
+    
+    if (result != RPI_DISPLAY_OK) {
+        // A partial write leaves the panel out of step with the shadow
+        ctx->shadow_valid = false;
+    } else {
+        ctx->stats.bytes_skipped += skipped;
+        ctx->stats.last_frame_bytes_skipped = skipped;
+        frame_end(ctx);
     }
     
-    // Full screen refresh
-    return ili9486l_refresh_rect(ctx, 0, 0, ctx->width, ctx->height);
+    return result;
 }
 
 int ili9486l_refresh_rect(ili9486l_ctx_t* ctx, int x, int y, int width, int height) {
-    if (x < 0 || y < 0 || x + width > ctx->width || y + height > ctx->height) {
-        return RPI_DISPLAY_ERROR_INVALID;
+    return ili9486l_refresh_rect_from(ctx, flush_source(ctx), x, y, width, height);
+}
+
+int ili9486l_refresh_rect_from(ili9486l_ctx_t* ctx, const uint16_t* source, int x, int y, int width, int height) {
+    frame_begin(ctx);
+    
+    int result = flush_rect(ctx, source, x, y, width, height);
+    ctx->frame_rects = 1;
+    
+    if (result == RPI_DISPLAY_OK) {
+        frame_end(ctx);
     }
     
-    // Set display window
-    if (ili9486l_set_window(ctx, x, y, width, height) < 0) {
-        return RPI_DISPLAY_ERROR_SPI;
+    return result;
+}
+
+int ili9486l_read_frame(ili9486l_ctx_t* ctx, uint16_t* pixels) {
+    if (!ctx->transport || !ctx->transport->read_frame) {
+        return RPI_DISPLAY_ERROR_INVALID;
     }
     
-    // Calculate buffer offset and size
-    uint32_t pixel_count = width * height;
-    uint32_t byte_count = pixel_count * 2; // 16-bit pixels
-    uint16_t* source_buffer = ctx->double_buffer_enabled ? ctx->backbuffer : ctx->framebuffer;
+    return ctx->transport->read_frame(ctx, pixels) < 0 ? RPI_DISPLAY_ERROR_SPI : RPI_DISPLAY_OK;
+}
+
+int ili9486l_trace_start(ili9486l_ctx_t* ctx, const char* path, int flags) {
+    ili9486l_trace_stop(ctx);
     
-    // Copy pixel data to transfer buffer
-    for (int row = 0; row < height; row++) {
-        int fb_offset = ((y + row) * ctx->width + x) * 2;
-        int tx_offset = row * width * 2;
-        
-        // Convert from little-endian to big-endian for SPI
-        for (int col = 0; col < width; col++) {
-            uint16_t pixel = source_buffer[(y + row) * ctx->width + x + col];
-            ctx->tx_buffer[tx_offset + col * 2] = (pixel >> 8) & 0xFF;
-            ctx->tx_buffer[tx_offset + col * 2 + 1] = pixel & 0xFF;
-        }
+    ctx->trace = spi_trace_open(path, ctx->spi_speed, flags);
+    if (!ctx->trace) {
+        return RPI_DISPLAY_ERROR_INVALID;
     }
     
-    // Transfer data
-    if (ili9486l_write_data(ctx, ctx->tx_buffer, byte_count) < 0) {
+    // Make the trace self-contained: it opens with a software reset and the
+    // whole configuration sequence, so any replay target ends up set up like
+    // this panel. GRAM survives SWRESET; DC, the window and scrolling don't.
+    ctx->dc_state = -1;
+    invalidate_window(ctx);
+    if (spi_batch_command(ctx, ILI9486L_SWRESET, NULL, 0) < 0 || spi_batch_submit(ctx) < 0) {
+        ili9486l_trace_stop(ctx);
         return RPI_DISPLAY_ERROR_SPI;
     }
+    delay_ms(120);
     
-    // Update performance tracking
-    ctx->frame_count++;
-    ctx->last_refresh_time = get_time_ns();
+    if (ili9486l_configure(ctx) < 0 ||
+        (ctx->scroll_height && (queue_scroll(ctx) < 0 || spi_batch_submit(ctx) < 0))) {
+        ili9486l_trace_stop(ctx);
+        return RPI_DISPLAY_ERROR_SPI;
+    }
     
     return RPI_DISPLAY_OK;
 }
 
+void ili9486l_trace_stop(ili9486l_ctx_t* ctx) {
+    if (!ctx->trace) return;
+    
+    spi_trace_close(ctx->trace);
+    ctx->trace = NULL;
+}
+
 int ili9486l_init(ili9486l_ctx_t* ctx, const display_config_t* config) {
     memset(ctx, 0, sizeof(*ctx));
     
@@ -444,23 +1511,32 @@ int ili9486l_init(ili9486l_ctx_t* ctx, const display_config_t* config) {
     ctx->width = DISPLAY_WIDTH;
     ctx->height = DISPLAY_HEIGHT;
     ctx->fb_size = ctx->width * ctx->height * 2; // 16-bit pixels
-    
-    // Initialize GPIO pins
-    if (gpio_export(GPIO_DC) < 0 || gpio_export(GPIO_RST) < 0 || 
-        gpio_export(GPIO_CS) < 0 || gpio_export(GPIO_LED) < 0) {
-        return RPI_DISPLAY_ERROR_GPIO;
-    }
-    
-    if (gpio_set_direction(GPIO_DC, "out") < 0 || gpio_set_direction(GPIO_RST, "out") < 0 ||
-        gpio_set_direction(GPIO_CS, "out") < 0 || gpio_set_direction(GPIO_LED, "out") < 0) {
-        return RPI_DISPLAY_ERROR_GPIO;
+    ctx->stripe_size = config->spi_stripe_size;
+    ctx->zero_copy = config->enable_zero_copy;
+    ctx->kernels = pixel_kernels_get();
+    ctx->spi_fd = -1;
+    invalidate_window(ctx);
+    
+    // Open the bus: GPIO lines and SPI device, or the virtual panel
+    const ili9486l_transport_t* transport = config->transport == DISPLAY_TRANSPORT_VIRTUAL ?
+                                            &virtual_panel_transport : &spidev_transport;
+    int result = transport->open(ctx, config);
+    if (result != RPI_DISPLAY_OK) {
+        return result;
     }
+    ctx->transport = transport;
     
-    // Initialize SPI
+    // Allocate transfer buffers
     if (spi_init(ctx) < 0) {
+        ili9486l_destroy(ctx);
         return RPI_DISPLAY_ERROR_SPI;
     }
     
+    // Pipelined flushing is optional; without the worker stripes go out inline
+    if (spi_stream_start(ctx) < 0) {
+        printf("Warning: SPI stream thread unavailable, flushing synchronously\n");
+    }
+    
     // Allocate framebuffer
     ctx->framebuffer = malloc(ctx->fb_size);
     if (!ctx->framebuffer) {
@@ -477,12 +1553,22 @@ int ili9486l_init(ili9486l_ctx_t* ctx, const display_config_t* config) {
         }
     }
     
+    // Allocate shadow frame if pixel-exact damage detection is enabled
+    if (config->enable_shadow_frame) {
+        ctx->shadow = malloc(ctx->fb_size);
+        if (!ctx->shadow) {
+            ili9486l_destroy(ctx);
+            return RPI_DISPLAY_ERROR_MEMORY;
+        }
+    }
+    
     // Initialize dirty rectangle tracking
     ctx->dirty_rect_enabled = true;
+    ctx->damage_setup_cost = DAMAGE_DEFAULT_SETUP_COST;
     clear_dirty_rect(ctx);
     
     // Turn on LED backlight
-    gpio_set_value(GPIO_LED, 1);
+    gpio_write_line(ctx, GPIO_LED, 1);
     
     // Reset and configure display
     if (ili9486l_reset(ctx) < 0) {
@@ -502,7 +1588,9 @@ void ili9486l_destroy(ili9486l_ctx_t* ctx) {
     if (!ctx) return;
     
     // Turn off LED backlight
-    gpio_set_value(GPIO_LED, 0);
+    if (ctx->transport) {
+        gpio_write_line(ctx, GPIO_LED, 0);
+    }
     
     // Free framebuffer
     if (ctx->framebuffer) {
@@ -515,47 +1603,100 @@ void ili9486l_destroy(ili9486l_ctx_t* ctx) {
         ctx->backbuffer = NULL;
     }
     
+    if (ctx->shadow) {
+        free(ctx->shadow);
+        ctx->shadow = NULL;
+    }
+    
     // Clean up SPI
     spi_destroy(ctx);
     
-    // Clean up GPIO
-    gpio_unexport(GPIO_DC);
-    gpio_unexport(GPIO_RST);
-    gpio_unexport(GPIO_CS);
-    gpio_unexport(GPIO_LED);
+    ili9486l_trace_stop(ctx);
+    
+    // Close the transport
+    if (ctx->transport) {
+        ctx->transport->close(ctx);
+        ctx->transport = NULL;
+    }
 }
 
 // Performance helper functions
 void mark_dirty_rect(ili9486l_ctx_t* ctx, int x, int y, int width, int height) {
     if (!ctx->dirty_rect_enabled) return;
     
-    int x_max = x + width - 1;
-    int y_max = y + height - 1;
-    
-    if (ctx->dirty_x_min == -1) {
-        // First dirty rectangle
-        ctx->dirty_x_min = x;
-        ctx->dirty_y_min = y;
-        ctx->dirty_x_max = x_max;
-        ctx->dirty_y_max = y_max;
-    } else {
-        // Expand existing dirty rectangle
-        if (x < ctx->dirty_x_min) ctx->dirty_x_min = x;
-        if (y < ctx->dirty_y_min) ctx->dirty_y_min = y;
-        if (x_max > ctx->dirty_x_max) ctx->dirty_x_max = x_max;
-        if (y_max > ctx->dirty_y_max) ctx->dirty_y_max = y_max;
-    }
+    damage_region_add(&ctx->damage, x, y, width, height, ctx->damage_setup_cost);
 }
 
 void clear_dirty_rect(ili9486l_ctx_t* ctx) {
-    ctx->dirty_x_min = -1;
-    ctx->dirty_y_min = -1;
-    ctx->dirty_x_max = -1;
-    ctx->dirty_y_max = -1;
+    ctx->damage.count = 0;
 }
 
 bool has_dirty_rect(ili9486l_ctx_t* ctx) {
-    return ctx->dirty_x_min != -1;
+    return ctx->damage.count > 0;
+}
+
+static int32_t rect_area(const damage_rect_t* r) {
+    return (int32_t)r->width * r->height;
+}
+
+static damage_rect_t rect_union(const damage_rect_t* a, const damage_rect_t* b) {
+    damage_rect_t u;
+    int x1 = a->x + a->width > b->x + b->width ? a->x + a->width : b->x + b->width;
+    int y1 = a->y + a->height > b->y + b->height ? a->y + a->height : b->y + b->height;
+    
+    u.x = a->x < b->x ? a->x : b->x;
+    u.y = a->y < b->y ? a->y : b->y;
+    u.width = x1 - u.x;
+    u.height = y1 - u.y;
+    return u;
+}
+
+static int32_t rect_overlap(const damage_rect_t* a, const damage_rect_t* b) {
+    int x0 = a->x > b->x ? a->x : b->x;
+    int y0 = a->y > b->y ? a->y : b->y;
+    int x1 = a->x + a->width < b->x + b->width ? a->x + a->width : b->x + b->width;
+    int y1 = a->y + a->height < b->y + b->height ? a->y + a->height : b->y + b->height;
+    
+    if (x1 <= x0 || y1 <= y0) return 0;
+    return (x1 - x0) * (y1 - y0);
+}
+
+// Extra bytes put on the wire by sending a and b as their bounding box
+// instead of as two windows (shared pixels are only sent once when merged)
+static int32_t merge_cost(const damage_rect_t* a, const damage_rect_t* b) {
+    damage_rect_t u = rect_union(a, b);
+    return (rect_area(&u) - rect_area(a) - rect_area(b) + rect_overlap(a, b)) * 2;
+}
+
+void damage_region_add(damage_region_t* region, int x, int y, int width, int height, uint32_t setup_cost) {
+    if (width <= 0 || height <= 0) return;
+    
+    damage_rect_t rect = { x, y, width, height };
+    
+    while (true) {
+        int best = -1;
+        int32_t best_cost = 0;
+        
+        for (int i = 0; i < region->count; i++) {
+            int32_t cost = merge_cost(&region->rects[i], &rect);
+            if (best < 0 || cost < best_cost) {
+                best = i;
+                best_cost = cost;
+            }
+        }
+        
+        // Merge when a window setup costs more than the extra pixels,
+        // or when the region is full and something has to give. Compared
+        // in 64 bits, so UINT32_MAX always merges.
+        if (best < 0 || ((int64_t)best_cost > (int64_t)setup_cost && region->count < DAMAGE_MAX_RECTS)) {
+            break;
+        }
+        
+        rect = rect_union(&region->rects[best], &rect);
+        region->rects[best] = region->rects[--region->count];
+    }
+    
+    region->rects[region->count++] = rect;
 }
 
 // Utility functions
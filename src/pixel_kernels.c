@@ -0,0 +1,550 @@
+#include <string.h>
+#include <pthread.h>
+
+#include "pixel_kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PIXEL_KERNELS_X86 1
+#endif
+
+#if defined(__aarch64__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define PIXEL_KERNELS_NEON 1
+#if !defined(__aarch64__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+#endif
+
+// Scalar reference kernels
+static void fill16_scalar(uint16_t* dst, uint16_t value, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = value;
+    }
+}
+
+static void swap16_copy_scalar(uint8_t* dst, const uint16_t* src, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        uint16_t pixel = src[i];
+        dst[i * 2] = pixel >> 8;
+        dst[i * 2 + 1] = pixel & 0xFF;
+    }
+}
+
+static void rgb888_to_rgb565_scalar(uint16_t* dst, const uint8_t* src, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t* p = &src[i * 3];
+        dst[i] = ((p[0] & 0xF8) << 8) | ((p[1] & 0xFC) << 3) | (p[2] >> 3);
+    }
+}
+
+static void argb8888_to_rgb565_scalar(uint16_t* dst, const uint32_t* src, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        uint32_t p = src[i];
+        dst[i] = ((p >> 8) & 0xF800) | ((p >> 5) & 0x07E0) | ((p >> 3) & 0x001F);
+    }
+}
+
+static void blend_a8_scalar(uint16_t* dst, const uint16_t* src, const uint8_t* alpha, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = pixel_blend565(dst[i], src[i], alpha[i]);
+    }
+}
+
+static void blend_argb8888_scalar(uint16_t* dst, const uint32_t* src, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        uint32_t p = src[i];
+        uint16_t color = ((p >> 8) & 0xF800) | ((p >> 5) & 0x07E0) | ((p >> 3) & 0x001F);
+        dst[i] = pixel_blend565(dst[i], color, p >> 24);
+    }
+}
+
+static void blend_color_a8_scalar(uint16_t* dst, uint16_t color, const uint8_t* alpha, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = pixel_blend565(dst[i], color, alpha[i]);
+    }
+}
+
+static const pixel_kernels_t kernels_scalar = {
+    .isa = PIXEL_ISA_SCALAR,
+    .name = "scalar",
+    .fill16 = fill16_scalar,
+    .swap16_copy = swap16_copy_scalar,
+    .rgb888_to_rgb565 = rgb888_to_rgb565_scalar,
+    .argb8888_to_rgb565 = argb8888_to_rgb565_scalar,
+    .blend_a8 = blend_a8_scalar,
+    .blend_argb8888 = blend_argb8888_scalar,
+    .blend_color_a8 = blend_color_a8_scalar,
+};
+
+#ifdef PIXEL_KERNELS_X86
+// SSE2 kernels, 8 pixels per vector
+__attribute__((target("sse2")))
+static void fill16_sse2(uint16_t* dst, uint16_t value, size_t count) {
+    __m128i v = _mm_set1_epi16((short)value);
+    size_t i = 0;
+    
+    for (; i + 16 <= count; i += 16) {
+        _mm_storeu_si128((__m128i*)&dst[i], v);
+        _mm_storeu_si128((__m128i*)&dst[i + 8], v);
+    }
+    for (; i < count; i++) {
+        dst[i] = value;
+    }
+}
+
+__attribute__((target("sse2")))
+static void swap16_copy_sse2(uint8_t* dst, const uint16_t* src, size_t count) {
+    size_t i = 0;
+    
+    for (; i + 8 <= count; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i*)&src[i]);
+        v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        _mm_storeu_si128((__m128i*)&dst[i * 2], v);
+    }
+    swap16_copy_scalar(&dst[i * 2], &src[i], count - i);
+}
+
+// Four 0x??RRGGBB lanes to RGB565 in the low half of each lane
+__attribute__((target("sse2")))
+static inline __m128i pack565_epi32_sse2(__m128i p) {
+    __m128i r = _mm_and_si128(_mm_srli_epi32(p, 8), _mm_set1_epi32(0xF800));
+    __m128i g = _mm_and_si128(_mm_srli_epi32(p, 5), _mm_set1_epi32(0x07E0));
+    __m128i b = _mm_and_si128(_mm_srli_epi32(p, 3), _mm_set1_epi32(0x001F));
+    return _mm_or_si128(_mm_or_si128(r, g), b);
+}
+
+__attribute__((target("sse2")))
+static void argb8888_to_rgb565_sse2(uint16_t* dst, const uint32_t* src, size_t count) {
+    // SSE2 only has a signed 32->16 pack, so bias into range and back
+    const __m128i bias32 = _mm_set1_epi32(0x8000);
+    const __m128i bias16 = _mm_set1_epi16((short)0x8000);
+    size_t i = 0;
+    
+    for (; i + 8 <= count; i += 8) {
+        __m128i lo = pack565_epi32_sse2(_mm_loadu_si128((const __m128i*)&src[i]));
+        __m128i hi = pack565_epi32_sse2(_mm_loadu_si128((const __m128i*)&src[i + 4]));
+        __m128i v = _mm_packs_epi32(_mm_sub_epi32(lo, bias32), _mm_sub_epi32(hi, bias32));
+        _mm_storeu_si128((__m128i*)&dst[i], _mm_xor_si128(v, bias16));
+    }
+    argb8888_to_rgb565_scalar(&dst[i], &src[i], count - i);
+}
+
+// Eight RGB565 blends at once; a holds widened alpha, 0..256. Uses
+// s*a + d*(256-a) == d*256 + (s-d)*a, so each channel is d + ((s-d)*a >> 8)
+// with an arithmetic shift: one multiply per channel instead of two, and
+// bit-identical to pixel_blend565. |s-d|*a stays below 64 * 256.
+__attribute__((target("sse2")))
+static inline __m128i blend565_sse2(__m128i d, __m128i s, __m128i a) {
+    const __m128i mask5 = _mm_set1_epi16(0x1F);
+    const __m128i mask6 = _mm_set1_epi16(0x3F);
+    
+    __m128i dr = _mm_srli_epi16(d, 11);
+    __m128i dg = _mm_and_si128(_mm_srli_epi16(d, 5), mask6);
+    __m128i db = _mm_and_si128(d, mask5);
+    __m128i r = _mm_sub_epi16(_mm_srli_epi16(s, 11), dr);
+    __m128i g = _mm_sub_epi16(_mm_and_si128(_mm_srli_epi16(s, 5), mask6), dg);
+    __m128i b = _mm_sub_epi16(_mm_and_si128(s, mask5), db);
+    
+    r = _mm_add_epi16(dr, _mm_srai_epi16(_mm_mullo_epi16(r, a), 8));
+    g = _mm_add_epi16(dg, _mm_srai_epi16(_mm_mullo_epi16(g, a), 8));
+    b = _mm_add_epi16(db, _mm_srai_epi16(_mm_mullo_epi16(b, a), 8));
+    return _mm_or_si128(_mm_or_si128(_mm_slli_epi16(r, 11), _mm_slli_epi16(g, 5)), b);
+}
+
+__attribute__((target("sse2")))
+static void blend_argb8888_sse2(uint16_t* dst, const uint32_t* src, size_t count) {
+    const __m128i bias32 = _mm_set1_epi32(0x8000);
+    const __m128i bias16 = _mm_set1_epi16((short)0x8000);
+    size_t i = 0;
+    
+    for (; i + 8 <= count; i += 8) {
+        __m128i lo = _mm_loadu_si128((const __m128i*)&src[i]);
+        __m128i hi = _mm_loadu_si128((const __m128i*)&src[i + 4]);
+        
+        // Alpha fits a signed pack as is, the colors need the bias trick
+        __m128i a = _mm_packs_epi32(_mm_srli_epi32(lo, 24), _mm_srli_epi32(hi, 24));
+        a = _mm_add_epi16(a, _mm_srli_epi16(a, 7));
+        __m128i s = _mm_packs_epi32(_mm_sub_epi32(pack565_epi32_sse2(lo), bias32),
+                                    _mm_sub_epi32(pack565_epi32_sse2(hi), bias32));
+        s = _mm_xor_si128(s, bias16);
+        
+        __m128i d = _mm_loadu_si128((const __m128i*)&dst[i]);
+        _mm_storeu_si128((__m128i*)&dst[i], blend565_sse2(d, s, a));
+    }
+    blend_argb8888_scalar(&dst[i], &src[i], count - i);
+}
+
+static const pixel_kernels_t kernels_sse2 = {
+    .isa = PIXEL_ISA_SSE2,
+    .name = "sse2",
+    .fill16 = fill16_sse2,
+    .swap16_copy = swap16_copy_sse2,
+    .rgb888_to_rgb565 = rgb888_to_rgb565_scalar, // Needs a byte shuffle, see AVX2
+    .argb8888_to_rgb565 = argb8888_to_rgb565_sse2,
+    .blend_a8 = blend_a8_scalar, // The compiler vectorises these two as well
+    .blend_argb8888 = blend_argb8888_sse2,
+    .blend_color_a8 = blend_color_a8_scalar,
+};
+
+// AVX2 kernels, 16 pixels per vector
+__attribute__((target("avx2")))
+static void swap16_copy_avx2(uint8_t* dst, const uint16_t* src, size_t count) {
+    const __m256i swap = _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+                                          1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+    size_t i = 0;
+    
+    for (; i + 16 <= count; i += 16) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)&src[i]);
+        _mm256_storeu_si256((__m256i*)&dst[i * 2], _mm256_shuffle_epi8(v, swap));
+    }
+    swap16_copy_scalar(&dst[i * 2], &src[i], count - i);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i pack565_epi32_avx2(__m256i p) {
+    __m256i r = _mm256_and_si256(_mm256_srli_epi32(p, 8), _mm256_set1_epi32(0xF800));
+    __m256i g = _mm256_and_si256(_mm256_srli_epi32(p, 5), _mm256_set1_epi32(0x07E0));
+    __m256i b = _mm256_and_si256(_mm256_srli_epi32(p, 3), _mm256_set1_epi32(0x001F));
+    return _mm256_or_si256(_mm256_or_si256(r, g), b);
+}
+
+__attribute__((target("avx2")))
+static void rgb888_to_rgb565_avx2(uint16_t* dst, const uint8_t* src, size_t count) {
+    // Spread four R,G,B triples from each 128-bit lane into 0x00RRGGBB words
+    const __m256i spread = _mm256_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1,
+                                            2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+    size_t i = 0;
+    
+    // Each load reads 16 bytes for 12 used, so stop while that stays in bounds
+    for (; i + 18 <= count; i += 16) {
+        const uint8_t* p = &src[i * 3];
+        __m256i a = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)p)),
+                                            _mm_loadu_si128((const __m128i*)(p + 12)), 1);
+        __m256i b = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(p + 24))),
+                                            _mm_loadu_si128((const __m128i*)(p + 36)), 1);
+        a = pack565_epi32_avx2(_mm256_shuffle_epi8(a, spread));
+        b = pack565_epi32_avx2(_mm256_shuffle_epi8(b, spread));
+        
+        // packus works per 128-bit lane; put the quarters back in order
+        __m256i v = _mm256_permute4x64_epi64(_mm256_packus_epi32(a, b), 0xD8);
+        _mm256_storeu_si256((__m256i*)&dst[i], v);
+    }
+    rgb888_to_rgb565_scalar(&dst[i], &src[i * 3], count - i);
+}
+
+__attribute__((target("avx2")))
+static void argb8888_to_rgb565_avx2(uint16_t* dst, const uint32_t* src, size_t count) {
+    size_t i = 0;
+    
+    for (; i + 16 <= count; i += 16) {
+        __m256i a = pack565_epi32_avx2(_mm256_loadu_si256((const __m256i*)&src[i]));
+        __m256i b = pack565_epi32_avx2(_mm256_loadu_si256((const __m256i*)&src[i + 8]));
+        __m256i v = _mm256_permute4x64_epi64(_mm256_packus_epi32(a, b), 0xD8);
+        _mm256_storeu_si256((__m256i*)&dst[i], v);
+    }
+    argb8888_to_rgb565_scalar(&dst[i], &src[i], count - i);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i blend565_avx2(__m256i d, __m256i s, __m256i a) {
+    const __m256i mask5 = _mm256_set1_epi16(0x1F);
+    const __m256i mask6 = _mm256_set1_epi16(0x3F);
+    __m256i ia = _mm256_sub_epi16(_mm256_set1_epi16(256), a);
+    
+    __m256i r = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_srli_epi16(s, 11), a),
+                                 _mm256_mullo_epi16(_mm256_srli_epi16(d, 11), ia));
+    __m256i g = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_and_si256(_mm256_srli_epi16(s, 5), mask6), a),
+                                 _mm256_mullo_epi16(_mm256_and_si256(_mm256_srli_epi16(d, 5), mask6), ia));
+    __m256i b = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_and_si256(s, mask5), a),
+                                 _mm256_mullo_epi16(_mm256_and_si256(d, mask5), ia));
+    
+    r = _mm256_slli_epi16(_mm256_srli_epi16(r, 8), 11);
+    g = _mm256_slli_epi16(_mm256_srli_epi16(g, 8), 5);
+    b = _mm256_srli_epi16(b, 8);
+    return _mm256_or_si256(_mm256_or_si256(r, g), b);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i load_alpha16_avx2(const uint8_t* alpha) {
+    __m256i a = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)alpha));
+    return _mm256_add_epi16(a, _mm256_srli_epi16(a, 7));
+}
+
+__attribute__((target("avx2")))
+static void blend_a8_avx2(uint16_t* dst, const uint16_t* src, const uint8_t* alpha, size_t count) {
+    size_t i = 0;
+    
+    for (; i + 16 <= count; i += 16) {
+        __m256i d = _mm256_loadu_si256((const __m256i*)&dst[i]);
+        __m256i s = _mm256_loadu_si256((const __m256i*)&src[i]);
+        _mm256_storeu_si256((__m256i*)&dst[i], blend565_avx2(d, s, load_alpha16_avx2(&alpha[i])));
+    }
+    blend_a8_scalar(&dst[i], &src[i], &alpha[i], count - i);
+}
+
+__attribute__((target("avx2")))
+static void blend_argb8888_avx2(uint16_t* dst, const uint32_t* src, size_t count) {
+    size_t i = 0;
+    
+    for (; i + 16 <= count; i += 16) {
+        __m256i lo = _mm256_loadu_si256((const __m256i*)&src[i]);
+        __m256i hi = _mm256_loadu_si256((const __m256i*)&src[i + 8]);
+        
+        __m256i a = _mm256_packus_epi32(_mm256_srli_epi32(lo, 24), _mm256_srli_epi32(hi, 24));
+        a = _mm256_permute4x64_epi64(a, 0xD8);
+        a = _mm256_add_epi16(a, _mm256_srli_epi16(a, 7));
+        __m256i s = _mm256_packus_epi32(pack565_epi32_avx2(lo), pack565_epi32_avx2(hi));
+        s = _mm256_permute4x64_epi64(s, 0xD8);
+        
+        __m256i d = _mm256_loadu_si256((const __m256i*)&dst[i]);
+        _mm256_storeu_si256((__m256i*)&dst[i], blend565_avx2(d, s, a));
+    }
+    blend_argb8888_scalar(&dst[i], &src[i], count - i);
+}
+
+__attribute__((target("avx2")))
+static void blend_color_a8_avx2(uint16_t* dst, uint16_t color, const uint8_t* alpha, size_t count) {
+    __m256i s = _mm256_set1_epi16((short)color);
+    size_t i = 0;
+    
+    for (; i + 16 <= count; i += 16) {
+        __m256i d = _mm256_loadu_si256((const __m256i*)&dst[i]);
+        _mm256_storeu_si256((__m256i*)&dst[i], blend565_avx2(d, s, load_alpha16_avx2(&alpha[i])));
+    }
+    blend_color_a8_scalar(&dst[i], color, &alpha[i], count - i);
+}
+
+static const pixel_kernels_t kernels_avx2 = {
+    .isa = PIXEL_ISA_AVX2,
+    .name = "avx2",
+    .fill16 = fill16_sse2, // Store bound; 256-bit stores measured slower
+    .swap16_copy = swap16_copy_avx2,
+    .rgb888_to_rgb565 = rgb888_to_rgb565_avx2,
+    .argb8888_to_rgb565 = argb8888_to_rgb565_avx2,
+    .blend_a8 = blend_a8_avx2,
+    .blend_argb8888 = blend_argb8888_avx2,
+    .blend_color_a8 = blend_color_a8_avx2,
+};
+#endif // PIXEL_KERNELS_X86
+
+#ifdef PIXEL_KERNELS_NEON
+// NEON kernels, 8 pixels per vector
+static void fill16_neon(uint16_t* dst, uint16_t value, size_t count) {
+    uint16x8_t v = vdupq_n_u16(value);
+    size_t i = 0;
+    
+    for (; i + 16 <= count; i += 16) {
+        vst1q_u16(&dst[i], v);
+        vst1q_u16(&dst[i + 8], v);
+    }
+    for (; i < count; i++) {
+        dst[i] = value;
+    }
+}
+
+static void swap16_copy_neon(uint8_t* dst, const uint16_t* src, size_t count) {
+    size_t i = 0;
+    
+    for (; i + 8 <= count; i += 8) {
+        uint8x16_t v = vld1q_u8((const uint8_t*)&src[i]);
+        vst1q_u8(&dst[i * 2], vrev16q_u8(v));
+    }
+    swap16_copy_scalar(&dst[i * 2], &src[i], count - i);
+}
+
+// Widen each channel to the top of a 16-bit lane and shift-insert them together
+static inline uint16x8_t pack565_neon(uint8x8_t r, uint8x8_t g, uint8x8_t b) {
+    uint16x8_t v = vshll_n_u8(r, 8);
+    v = vsriq_n_u16(v, vshll_n_u8(g, 8), 5);
+    return vsriq_n_u16(v, vshll_n_u8(b, 8), 11);
+}
+
+static void rgb888_to_rgb565_neon(uint16_t* dst, const uint8_t* src, size_t count) {
+    size_t i = 0;
+    
+    for (; i + 8 <= count; i += 8) {
+        uint8x8x3_t p = vld3_u8(&src[i * 3]);
+        vst1q_u16(&dst[i], pack565_neon(p.val[0], p.val[1], p.val[2]));
+    }
+    rgb888_to_rgb565_scalar(&dst[i], &src[i * 3], count - i);
+}
+
+static void argb8888_to_rgb565_neon(uint16_t* dst, const uint32_t* src, size_t count) {
+    size_t i = 0;
+    
+    // Little-endian 0xAARRGGBB words deinterleave as B, G, R, A
+    for (; i + 8 <= count; i += 8) {
+        uint8x8x4_t p = vld4_u8((const uint8_t*)&src[i]);
+        vst1q_u16(&dst[i], pack565_neon(p.val[2], p.val[1], p.val[0]));
+    }
+    argb8888_to_rgb565_scalar(&dst[i], &src[i], count - i);
+}
+
+static inline uint16x8_t blend565_neon(uint16x8_t d, uint16x8_t s, uint16x8_t a) {
+    const uint16x8_t mask5 = vdupq_n_u16(0x1F);
+    const uint16x8_t mask6 = vdupq_n_u16(0x3F);
+    uint16x8_t ia = vsubq_u16(vdupq_n_u16(256), a);
+    
+    uint16x8_t r = vmlaq_u16(vmulq_u16(vshrq_n_u16(s, 11), a), vshrq_n_u16(d, 11), ia);
+    uint16x8_t g = vmlaq_u16(vmulq_u16(vandq_u16(vshrq_n_u16(s, 5), mask6), a),
+                             vandq_u16(vshrq_n_u16(d, 5), mask6), ia);
+    uint16x8_t b = vmlaq_u16(vmulq_u16(vandq_u16(s, mask5), a), vandq_u16(d, mask5), ia);
+    
+    r = vshlq_n_u16(vshrq_n_u16(r, 8), 11);
+    g = vshlq_n_u16(vshrq_n_u16(g, 8), 5);
+    return vorrq_u16(vorrq_u16(r, g), vshrq_n_u16(b, 8));
+}
+
+static inline uint16x8_t widen_alpha_neon(uint8x8_t alpha) {
+    uint16x8_t a = vmovl_u8(alpha);
+    return vaddq_u16(a, vshrq_n_u16(a, 7));
+}
+
+static void blend_a8_neon(uint16_t* dst, const uint16_t* src, const uint8_t* alpha, size_t count) {
+    size_t i = 0;
+    
+    for (; i + 8 <= count; i += 8) {
+        uint16x8_t a = widen_alpha_neon(vld1_u8(&alpha[i]));
+        vst1q_u16(&dst[i], blend565_neon(vld1q_u16(&dst[i]), vld1q_u16(&src[i]), a));
+    }
+    blend_a8_scalar(&dst[i], &src[i], &alpha[i], count - i);
+}
+
+static void blend_argb8888_neon(uint16_t* dst, const uint32_t* src, size_t count) {
+    size_t i = 0;
+    
+    for (; i + 8 <= count; i += 8) {
+        uint8x8x4_t p = vld4_u8((const uint8_t*)&src[i]);
+        uint16x8_t s = pack565_neon(p.val[2], p.val[1], p.val[0]);
+        vst1q_u16(&dst[i], blend565_neon(vld1q_u16(&dst[i]), s, widen_alpha_neon(p.val[3])));
+    }
+    blend_argb8888_scalar(&dst[i], &src[i], count - i);
+}
+
+static void blend_color_a8_neon(uint16_t* dst, uint16_t color, const uint8_t* alpha, size_t count) {
+    uint16x8_t s = vdupq_n_u16(color);
+    size_t i = 0;
+    
+    for (; i + 8 <= count; i += 8) {
+        uint16x8_t a = widen_alpha_neon(vld1_u8(&alpha[i]));
+        vst1q_u16(&dst[i], blend565_neon(vld1q_u16(&dst[i]), s, a));
+    }
+    blend_color_a8_scalar(&dst[i], color, &alpha[i], count - i);
+}
+
+static const pixel_kernels_t kernels_neon = {
+    .isa = PIXEL_ISA_NEON,
+    .name = "neon",
+    .fill16 = fill16_neon,
+    .swap16_copy = swap16_copy_neon,
+    .rgb888_to_rgb565 = rgb888_to_rgb565_neon,
+    .argb8888_to_rgb565 = argb8888_to_rgb565_neon,
+    .blend_a8 = blend_a8_neon,
+    .blend_argb8888 = blend_argb8888_neon,
+    .blend_color_a8 = blend_color_a8_neon,
+};
+#endif // PIXEL_KERNELS_NEON
+
+// Runtime dispatch
+static pthread_once_t kernels_once = PTHREAD_ONCE_INIT;
+static const pixel_kernels_t* active_kernels = &kernels_scalar;
+
+const pixel_kernels_t* pixel_kernels_for_isa(pixel_isa_t isa) {
+    switch (isa) {
+        case PIXEL_ISA_SCALAR:
+            return &kernels_scalar;
+#ifdef PIXEL_KERNELS_X86
+        case PIXEL_ISA_SSE2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("sse2") ? &kernels_sse2 : NULL;
+        case PIXEL_ISA_AVX2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2") ? &kernels_avx2 : NULL;
+#endif
+#ifdef PIXEL_KERNELS_NEON
+        case PIXEL_ISA_NEON:
+#if defined(__aarch64__)
+            return &kernels_neon; // Mandatory on AArch64
+#else
+            return (getauxval(AT_HWCAP) & HWCAP_NEON) ? &kernels_neon : NULL;
+#endif
+#endif
+        default:
+            return NULL;
+    }
+}
+
+static void select_kernels(void) {
+    // Highest ISA the CPU supports wins
+    for (int isa = PIXEL_ISA_COUNT - 1; isa > PIXEL_ISA_SCALAR; isa--) {
+        const pixel_kernels_t* kernels = pixel_kernels_for_isa((pixel_isa_t)isa);
+        if (kernels) {
+            active_kernels = kernels;
+            return;
+        }
+    }
+}
+
+const pixel_kernels_t* pixel_kernels_get(void) {
+    pthread_once(&kernels_once, select_kernels);
+    return active_kernels;
+}
+
+// Rect helpers
+void pixel_fill_rect(uint16_t* dst, uint32_t stride, int width, int height, uint16_t color) {
+    const pixel_kernels_t* kernels = pixel_kernels_get();
+    
+    if (width <= 0 || height <= 0) return;
+    
+    if (stride == (uint32_t)width) {
+        // Contiguous rows fill in one run
+        kernels->fill16(dst, color, (size_t)width * height);
+        return;
+    }
+    
+    for (int row = 0; row < height; row++) {
+        kernels->fill16(&dst[row * stride], color, width);
+    }
+}
+
+// Row copies go through memmove, which libc already dispatches per CPU.
+// Rows are walked bottom-up when the destination lies after the source so
+// overlapping copies within one buffer are safe.
+void pixel_copy_rect(uint16_t* dst, uint32_t dst_stride, const uint16_t* src, uint32_t src_stride,
+                     int width, int height) {
+    if (width <= 0 || height <= 0) return;
+    
+    if (dst > src) {
+        for (int row = height - 1; row >= 0; row--) {
+            memmove(&dst[row * dst_stride], &src[row * src_stride], width * sizeof(uint16_t));
+        }
+    } else {
+        for (int row = 0; row < height; row++) {
+            memmove(&dst[row * dst_stride], &src[row * src_stride], width * sizeof(uint16_t));
+        }
+    }
+}
+
+void pixel_blend_rect_a8(uint16_t* dst, uint32_t dst_stride, const uint16_t* src, uint32_t src_stride,
+                         const uint8_t* alpha, uint32_t alpha_stride, int width, int height) {
+    const pixel_kernels_t* kernels = pixel_kernels_get();
+    
+    if (width <= 0 || height <= 0) return;
+    
+    for (int row = 0; row < height; row++) {
+        kernels->blend_a8(&dst[row * dst_stride], &src[row * src_stride], &alpha[row * alpha_stride], width);
+    }
+}
+
+void pixel_blend_rect_argb8888(uint16_t* dst, uint32_t dst_stride, const uint32_t* src, uint32_t src_stride,
+                               int width, int height) {
+    const pixel_kernels_t* kernels = pixel_kernels_get();
+    
+    if (width <= 0 || height <= 0) return;
+    
+    for (int row = 0; row < height; row++) {
+        kernels->blend_argb8888(&dst[row * dst_stride], &src[row * src_stride], width);
+    }
+}
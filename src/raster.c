@@ -0,0 +1,440 @@
+#include <stdlib.h>
+
+#include "raster.h"
+#include "pixel_kernels.h"
+
+// Cohen-Sutherland outcodes
+#define OUT_LEFT    1
+#define OUT_RIGHT   2
+#define OUT_TOP     4
+#define OUT_BOTTOM  8
+
+void raster_bounds_init(raster_bounds_t* bounds) {
+    bounds->x0 = 0;
+    bounds->y0 = 0;
+    bounds->x1 = -1;
+    bounds->y1 = -1;
+}
+
+static void bounds_add(raster_bounds_t* bounds, int x0, int y0, int x1, int y1) {
+    if (bounds->x1 < bounds->x0) {
+        bounds->x0 = x0;
+        bounds->y0 = y0;
+        bounds->x1 = x1;
+        bounds->y1 = y1;
+        return;
+    }
+    
+    if (x0 < bounds->x0) bounds->x0 = x0;
+    if (y0 < bounds->y0) bounds->y0 = y0;
+    if (x1 > bounds->x1) bounds->x1 = x1;
+    if (y1 > bounds->y1) bounds->y1 = y1;
+}
+
+// Spans
+void raster_hspan(const raster_target_t* target, int x0, int x1, int y, uint16_t color, raster_bounds_t* bounds) {
+    if (y < 0 || y >= target->height) return;
+    
+    if (x0 > x1) {
+        int t = x0; x0 = x1; x1 = t;
+    }
+    if (x0 < 0) x0 = 0;
+    if (x1 >= target->width) x1 = target->width - 1;
+    if (x0 > x1) return;
+    
+    pixel_kernels_get()->fill16(&target->pixels[y * target->stride + x0], color, x1 - x0 + 1);
+    bounds_add(bounds, x0, y, x1, y);
+}
+
+// A span whose ends may lie far outside the target, beyond int range
+static void hspan_wide(const raster_target_t* target, int64_t x0, int64_t x1, int64_t y, uint16_t color,
+                       raster_bounds_t* bounds) {
+    if (y < 0 || y >= target->height) return;
+    
+    if (x0 > x1) {
+        int64_t t = x0; x0 = x1; x1 = t;
+    }
+    if (x1 < 0 || x0 >= target->width) return;
+    if (x0 < 0) x0 = 0;
+    if (x1 >= target->width) x1 = target->width - 1;
+    
+    raster_hspan(target, (int)x0, (int)x1, (int)y, color, bounds);
+}
+
+void raster_vspan(const raster_target_t* target, int x, int y0, int y1, uint16_t color, raster_bounds_t* bounds) {
+    if (x < 0 || x >= target->width) return;
+    
+    if (y0 > y1) {
+        int t = y0; y0 = y1; y1 = t;
+    }
+    if (y0 < 0) y0 = 0;
+    if (y1 >= target->height) y1 = target->height - 1;
+    if (y0 > y1) return;
+    
+    uint16_t* dst = &target->pixels[y0 * target->stride + x];
+    for (int y = y0; y <= y1; y++) {
+        *dst = color;
+        dst += target->stride;
+    }
+    bounds_add(bounds, x, y0, x, y1);
+}
+
+// Lines
+static int outcode(const raster_target_t* target, int x, int y) {
+    int code = 0;
+    
+    if (x < 0) code |= OUT_LEFT;
+    else if (x >= target->width) code |= OUT_RIGHT;
+    if (y < 0) code |= OUT_TOP;
+    else if (y >= target->height) code |= OUT_BOTTOM;
+    
+    return code;
+}
+
+// a + da * t / db, truncated like the integer division. The product only
+// leaves 64 bits when both factors pass 2^31, i.e. for points billions of
+// pixels away; those are placed to within a pixel.
+static int64_t interpolate(int64_t a, int64_t da, int64_t db, int64_t t) {
+    if ((da > INT32_MAX || da < -INT32_MAX) && (t > INT32_MAX || t < -INT32_MAX)) {
+        return a + (int64_t)((double)da * (double)t / (double)db);
+    }
+    
+    return a + da * t / db;
+}
+
+// Clip the segment to the target; false when nothing of it is visible
+static bool clip_line(const raster_target_t* target, int* x0, int* y0, int* x1, int* y1) {
+    int code0 = outcode(target, *x0, *y0);
+    int code1 = outcode(target, *x1, *y1);
+    int xmax = target->width - 1;
+    int ymax = target->height - 1;
+    
+    while (code0 | code1) {
+        if (code0 & code1) return false;
+        
+        int code = code0 ? code0 : code1;
+        int64_t dx = (int64_t)*x1 - *x0;
+        int64_t dy = (int64_t)*y1 - *y0;
+        int x, y;
+        
+        // The crossing lies between the ends, so it fits back in an int
+        if (code & OUT_BOTTOM) {
+            x = (int)interpolate(*x0, dx, dy, (int64_t)ymax - *y0);
+            y = ymax;
+        } else if (code & OUT_TOP) {
+            x = (int)interpolate(*x0, dx, dy, -(int64_t)*y0);
+            y = 0;
+        } else if (code & OUT_RIGHT) {
+            y = (int)interpolate(*y0, dy, dx, (int64_t)xmax - *x0);
+            x = xmax;
+        } else {
+            y = (int)interpolate(*y0, dy, dx, -(int64_t)*x0);
+            x = 0;
+        }
+        
+        if (code == code0) {
+            *x0 = x;
+            *y0 = y;
+            code0 = outcode(target, x, y);
+        } else {
+            *x1 = x;
+            *y1 = y;
+            code1 = outcode(target, x, y);
+        }
+    }
+    
+    return true;
+}
+
+void raster_line(const raster_target_t* target, int x0, int y0, int x1, int y1, uint16_t color,
+                 raster_bounds_t* bounds) {
+    // Axis-aligned lines are a single run
+    if (y0 == y1) {
+        raster_hspan(target, x0, x1, y0, color, bounds);
+        return;
+    }
+    if (x0 == x1) {
+        raster_vspan(target, x0, y0, y1, color, bounds);
+        return;
+    }
+    
+    if (!clip_line(target, &x0, &y0, &x1, &y1)) return;
+    
+    // Bresenham over the clipped segment, no per-pixel checks needed
+    int dx = abs(x1 - x0);
+    int dy = abs(y1 - y0);
+    int sx = x0 < x1 ? 1 : -1;
+    int sy = y0 < y1 ? 1 : -1;
+    int err = dx - dy;
+    int x = x0, y = y0;
+    
+    while (true) {
+        target->pixels[y * target->stride + x] = color;
+        
+        if (x == x1 && y == y1) break;
+        
+        int e2 = 2 * err;
+        if (e2 > -dy) {
+            err -= dy;
+            x += sx;
+        }
+        if (e2 < dx) {
+            err += dx;
+            y += sy;
+        }
+    }
+    
+    bounds_add(bounds, x0 < x1 ? x0 : x1, y0 < y1 ? y0 : y1, x0 > x1 ? x0 : x1, y0 > y1 ? y0 : y1);
+}
+
+// Circles
+//
+// The midpoint walk visits one octant; runs of points that share a row
+// (or, mirrored, a column) are emitted as single spans.
+static void circle_runs(const raster_target_t* target, int cx, int cy, int first, int last, int r,
+                        uint16_t color, raster_bounds_t* bounds) {
+    // Top and bottom octants are horizontal runs
+    if (first == 0) {
+        raster_hspan(target, cx - last, cx + last, cy - r, color, bounds);
+        raster_hspan(target, cx - last, cx + last, cy + r, color, bounds);
+    } else {
+        raster_hspan(target, cx - last, cx - first, cy - r, color, bounds);
+        raster_hspan(target, cx + first, cx + last, cy - r, color, bounds);
+        raster_hspan(target, cx - last, cx - first, cy + r, color, bounds);
+        raster_hspan(target, cx + first, cx + last, cy + r, color, bounds);
+    }
+    
+    // Left and right octants are the same runs transposed
+    if (first == 0) {
+        raster_vspan(target, cx - r, cy - last, cy + last, color, bounds);
+        raster_vspan(target, cx + r, cy - last, cy + last, color, bounds);
+    } else {
+        raster_vspan(target, cx - r, cy - last, cy - first, color, bounds);
+        raster_vspan(target, cx - r, cy + first, cy + last, color, bounds);
+        raster_vspan(target, cx + r, cy - last, cy - first, color, bounds);
+        raster_vspan(target, cx + r, cy + first, cy + last, color, bounds);
+    }
+}
+
+void raster_circle(const raster_target_t* target, int cx, int cy, int radius, uint16_t color,
+                   raster_bounds_t* bounds) {
+    if (radius < 0) return;
+    
+    int xx = 0;
+    int yy = radius;
+    int d = 3 - 2 * radius;
+    int run_start = 0;
+    
+    while (yy >= xx) {
+        int run_y = yy;
+        int run_end = xx;
+        
+        xx++;
+        if (d > 0) {
+            yy--;
+            d = d + 4 * (xx - yy) + 10;
+        } else {
+            d = d + 4 * xx + 6;
+        }
+        
+        // The run ends when the walk steps to the next row or finishes
+        if (yy != run_y || yy < xx) {
+            circle_runs(target, cx, cy, run_start, run_end, run_y, color, bounds);
+            run_start = xx;
+        }
+    }
+}
+
+void raster_fill_circle(const raster_target_t* target, int cx, int cy, int radius, uint16_t color,
+                        raster_bounds_t* bounds) {
+    if (radius < 0) return;
+    
+    int xx = 0;
+    int yy = radius;
+    int d = 3 - 2 * radius;
+    
+    while (yy >= xx) {
+        int row = yy;
+        int half = xx;
+        
+        // Rows near the middle are spanned once per step
+        raster_hspan(target, cx - yy, cx + yy, cy - xx, color, bounds);
+        if (xx > 0) {
+            raster_hspan(target, cx - yy, cx + yy, cy + xx, color, bounds);
+        }
+        
+        xx++;
+        if (d > 0) {
+            yy--;
+            d = d + 4 * (xx - yy) + 10;
+        } else {
+            d = d + 4 * xx + 6;
+        }
+        
+        // Rows near the poles are spanned once, at their widest
+        if (yy != row && row >= xx) {
+            raster_hspan(target, cx - half, cx + half, cy - row, color, bounds);
+            raster_hspan(target, cx - half, cx + half, cy + row, color, bounds);
+        }
+    }
+}
+
+// Filled shapes
+//
+// Only rows on the target are visited, so a huge shape costs no more than
+// a screenful. Widths come straight from each row's distance to the centre.
+
+// Rows cy - dy and cy + dy that can reach the target, for dy in 0..r
+static bool visible_rows(const raster_target_t* target, int cy, int r, int64_t* first, int64_t* last) {
+    int64_t top = (int64_t)cy - (target->height - 1);
+    int64_t lo = top > 0 ? top : (cy < 0 ? -(int64_t)cy : 0);
+    int64_t hi = (int64_t)target->height - 1 - cy;
+    
+    if (cy > hi) hi = cy;
+    if (hi > r) hi = r;
+    
+    *first = lo;
+    *last = hi;
+    return lo <= hi;
+}
+
+static uint64_t isqrt64(uint64_t n) {
+    uint64_t root = 0;
+    uint64_t bit = (uint64_t)1 << 62;
+    
+    while (bit > n) bit >>= 2;
+    
+    while (bit) {
+        if (n >= root + bit) {
+            n -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    
+    return root;
+}
+
+// a * b <= c * d for operands below 2^63, without a 128-bit type
+static bool product_le(uint64_t a, uint64_t b, uint64_t c, uint64_t d) {
+    uint64_t hi[2], lo[2];
+    uint64_t x[2] = { a, c };
+    uint64_t y[2] = { b, d };
+    
+    for (int i = 0; i < 2; i++) {
+        uint64_t p0 = (x[i] & 0xFFFFFFFF) * (y[i] & 0xFFFFFFFF);
+        uint64_t p1 = (x[i] & 0xFFFFFFFF) * (y[i] >> 32);
+        uint64_t p2 = (x[i] >> 32) * (y[i] & 0xFFFFFFFF);
+        uint64_t mid = (p0 >> 32) + (p1 & 0xFFFFFFFF) + (p2 & 0xFFFFFFFF);
+        
+        lo[i] = (mid << 32) | (p0 & 0xFFFFFFFF);
+        hi[i] = (x[i] >> 32) * (y[i] >> 32) + (p1 >> 32) + (p2 >> 32) + (mid >> 32);
+    }
+    
+    return hi[0] < hi[1] || (hi[0] == hi[1] && lo[0] <= lo[1]);
+}
+
+void raster_fill_ellipse(const raster_target_t* target, int cx, int cy, int rx, int ry, uint16_t color,
+                         raster_bounds_t* bounds) {
+    if (rx < 0 || ry < 0) return;
+    
+    int64_t first, last;
+    if (!visible_rows(target, cy, ry, &first, &last)) return;
+    
+    uint64_t rx2 = (uint64_t)rx * rx;
+    uint64_t ry2 = (uint64_t)ry * ry;
+    int64_t half = rx;
+    
+    for (int64_t dy = first; dy <= last; dy++) {
+        // Widest half with half^2 * ry^2 <= rx^2 * (ry^2 - dy^2). It only
+        // shrinks away from the centre row, so search below the last one.
+        uint64_t room = ry2 - (uint64_t)(dy * dy);
+        int64_t lo = 0;
+        
+        while (lo < half) {
+            int64_t mid = lo + (half - lo + 1) / 2;
+            if (product_le((uint64_t)(mid * mid), ry2, rx2, room)) {
+                lo = mid;
+            } else {
+                half = mid - 1;
+            }
+        }
+        
+        hspan_wide(target, cx - half, cx + half, cy - dy, color, bounds);
+        if (dy > 0) {
+            hspan_wide(target, cx - half, cx + half, cy + dy, color, bounds);
+        }
+    }
+}
+
+void raster_fill_round_rect(const raster_target_t* target, int x, int y, int width, int height, int radius,
+                            uint16_t color, raster_bounds_t* bounds) {
+    if (width <= 0 || height <= 0) return;
+    
+    int max_radius = (width < height ? width : height) / 2;
+    if (radius > max_radius) radius = max_radius;
+    if (radius < 0) radius = 0;
+    
+    int64_t x1 = (int64_t)x + width - 1;
+    int64_t y1 = (int64_t)y + height - 1;
+    int64_t r2 = (int64_t)radius * radius;
+    int64_t first = y > 0 ? y : 0;
+    int64_t last = y1 < target->height - 1 ? y1 : target->height - 1;
+    
+    for (int64_t row = first; row <= last; row++) {
+        // Corner rows are inset by the quarter circle
+        int64_t dy = 0;
+        if (row < (int64_t)y + radius) {
+            dy = (int64_t)y + radius - row;
+        } else if (row > y1 - radius) {
+            dy = row - (y1 - radius);
+        }
+        
+        int64_t inset = dy ? radius - (int64_t)isqrt64(r2 - dy * dy) : 0;
+        hspan_wide(target, x + inset, x1 - inset, row, color, bounds);
+    }
+}
+
+void raster_fill_triangle(const raster_target_t* target, int x0, int y0, int x1, int y1, int x2, int y2,
+                          uint16_t color, raster_bounds_t* bounds) {
+    int t;
+    
+    // Sort vertices by y
+    if (y0 > y1) { t = y0; y0 = y1; y1 = t; t = x0; x0 = x1; x1 = t; }
+    if (y1 > y2) { t = y1; y1 = y2; y2 = t; t = x1; x1 = x2; x2 = t; }
+    if (y0 > y1) { t = y0; y0 = y1; y1 = t; t = x0; x0 = x1; x1 = t; }
+    
+    if (y2 < 0 || y0 >= target->height) return;
+    
+    if (y0 == y2) {
+        // Degenerate: all three on one row
+        int a = x0, b = x0;
+        if (x1 < a) a = x1; else if (x1 > b) b = x1;
+        if (x2 < a) a = x2; else if (x2 > b) b = x2;
+        raster_hspan(target, a, b, y0, color, bounds);
+        return;
+    }
+    
+    int64_t dx01 = (int64_t)x1 - x0, dy01 = (int64_t)y1 - y0;
+    int64_t dx02 = (int64_t)x2 - x0, dy02 = (int64_t)y2 - y0;
+    int64_t dx12 = (int64_t)x2 - x1, dy12 = (int64_t)y2 - y1;
+    int bottom = y2 < target->height - 1 ? y2 : target->height - 1;
+    int y = y0 > 0 ? y0 : 0;
+    
+    // Upper part: edges 0-1 and 0-2. A flat bottom includes row y1 here.
+    int last = (y1 == y2) ? y1 : y1 - 1;
+    if (last > bottom) last = bottom;
+    
+    for (; y <= last; y++) {
+        hspan_wide(target, interpolate(x0, dx01, dy01, (int64_t)y - y0),
+                   interpolate(x0, dx02, dy02, (int64_t)y - y0), y, color, bounds);
+    }
+    
+    // Lower part: edges 1-2 and 0-2
+    for (; y <= bottom; y++) {
+        hspan_wide(target, interpolate(x1, dx12, dy12, (int64_t)y - y1),
+                   interpolate(x0, dx02, dy02, (int64_t)y - y0), y, color, bounds);
+    }
+}
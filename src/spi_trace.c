@@ -0,0 +1,415 @@
+// clock_nanosleep and TIMER_ABSTIME are POSIX, hidden under -std=c11
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#include "spi_trace.h"
+#include "ili9486l_driver.h"
+#include "efficient_rpi_display.h"
+
+// Static helper functions
+static uint64_t trace_time_ns(void);
+static void put_varint(FILE* file, uint64_t value);
+static int get_varint(FILE* file, uint64_t* value);
+static int get_u8(FILE* file, uint8_t* value);
+static void put_le(FILE* file, uint32_t value, int bytes);
+static uint32_t get_le(const uint8_t* data, int bytes);
+static void trace_record(spi_trace_t* trace, uint8_t tag);
+static uint32_t encode_rle(const uint8_t* wire, uint32_t length, uint8_t* out, uint32_t capacity);
+static int decode_rle(FILE* file, uint8_t* wire, uint32_t length);
+
+static uint64_t trace_time_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// LEB128: seven bits per byte, high bit set on all but the last
+static void put_varint(FILE* file, uint64_t value) {
+    while (value >= 0x80) {
+        fputc((int)(value & 0x7F) | 0x80, file);
+        value >>= 7;
+    }
+    fputc((int)value, file);
+}
+
+static int get_varint(FILE* file, uint64_t* value) {
+    uint64_t result = 0;
+    
+    for (int shift = 0; shift < 64; shift += 7) {
+        int c = fgetc(file);
+        if (c == EOF) return -1;
+        
+        result |= (uint64_t)(c & 0x7F) << shift;
+        if (!(c & 0x80)) {
+            *value = result;
+            return 0;
+        }
+    }
+    
+    return -1;
+}
+
+static int get_u8(FILE* file, uint8_t* value) {
+    int c = fgetc(file);
+    if (c == EOF) return -1;
+    
+    *value = (uint8_t)c;
+    return 0;
+}
+
+static void put_le(FILE* file, uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        fputc((value >> (8 * i)) & 0xFF, file);
+    }
+}
+
+static uint32_t get_le(const uint8_t* data, int bytes) {
+    uint32_t value = 0;
+    for (int i = 0; i < bytes; i++) {
+        value |= (uint32_t)data[i] << (8 * i);
+    }
+    return value;
+}
+
+// Runs of identical 16-bit units; returns 0 if the result would not fit
+static uint32_t encode_rle(const uint8_t* wire, uint32_t length, uint8_t* out, uint32_t capacity) {
+    uint32_t used = 0;
+    
+    for (uint32_t i = 0; i < length; ) {
+        uint32_t run = 1;
+        while (i + run * 2 + 1 < length &&
+               wire[i + run * 2] == wire[i] && wire[i + run * 2 + 1] == wire[i + 1]) {
+            run++;
+        }
+        
+        // Worst case varint plus the unit
+        if (used + 7 > capacity) return 0;
+        
+        uint32_t value = run;
+        while (value >= 0x80) {
+            out[used++] = (value & 0x7F) | 0x80;
+            value >>= 7;
+        }
+        out[used++] = value;
+        out[used++] = wire[i];
+        out[used++] = wire[i + 1];
+        
+        i += run * 2;
+    }
+    
+    return used;
+}
+
+static int decode_rle(FILE* file, uint8_t* wire, uint32_t length) {
+    uint64_t size;
+    if (get_varint(file, &size) < 0 || size > SPI_TRACE_MAX_LENGTH) return -1;
+    
+    uint32_t filled = 0;
+    uint64_t consumed = 0;
+    
+    while (consumed < size) {
+        uint64_t run;
+        uint8_t hi, lo;
+        long before = ftell(file);
+        
+        if (get_varint(file, &run) < 0 || get_u8(file, &hi) < 0 || get_u8(file, &lo) < 0) return -1;
+        consumed += ftell(file) - before;
+        
+        if (run > (length - filled) / 2) return -1;
+        for (uint64_t r = 0; r < run; r++) {
+            wire[filled++] = hi;
+            wire[filled++] = lo;
+        }
+    }
+    
+    return filled == length ? 0 : -1;
+}
+
+// Recording
+spi_trace_t* spi_trace_open(const char* path, uint32_t spi_speed, int flags) {
+    spi_trace_t* trace = calloc(1, sizeof(spi_trace_t));
+    if (!trace) {
+        return NULL;
+    }
+    
+    trace->file = fopen(path, "wb");
+    if (!trace->file) {
+        perror("Failed to open SPI trace");
+        free(trace);
+        return NULL;
+    }
+    
+    trace->flags = flags;
+    trace->last_ns = trace_time_ns();
+    
+    fwrite(SPI_TRACE_MAGIC, 1, 4, trace->file);
+    put_le(trace->file, SPI_TRACE_VERSION, 2);
+    put_le(trace->file, (uint32_t)flags, 2);
+    put_le(trace->file, spi_speed, 4);
+    put_le(trace->file, 0, 4);
+    
+    return trace;
+}
+
+void spi_trace_close(spi_trace_t* trace) {
+    if (!trace) return;
+    
+    if (fclose(trace->file) != 0) {
+        perror("Failed to finish SPI trace");
+    }
+    
+    free(trace->scratch);
+    free(trace);
+}
+
+static void trace_record(spi_trace_t* trace, uint8_t tag) {
+    uint64_t now = trace_time_ns();
+    
+    fputc(tag, trace->file);
+    put_varint(trace->file, now - trace->last_ns);
+    trace->last_ns = now;
+    trace->records++;
+}
+
+int spi_trace_line(spi_trace_t* trace, int pin, int value) {
+    trace_record(trace, SPI_TRACE_TAG_LINE);
+    fputc(pin & 0xFF, trace->file);
+    fputc(value ? 1 : 0, trace->file);
+    
+    return ferror(trace->file) ? -1 : 0;
+}
+
+int spi_trace_message(spi_trace_t* trace, const struct spi_ioc_transfer* transfers, int count) {
+    // Size scratch up front so a failed allocation never leaves half a record
+    uint32_t longest = 0;
+    for (int i = 0; i < count; i++) {
+        if (transfers[i].len > longest) longest = transfers[i].len;
+    }
+    
+    if (trace->scratch_size < longest * 2) {
+        uint8_t* scratch = realloc(trace->scratch, longest * 2);
+        if (!scratch) return -1;
+        trace->scratch = scratch;
+        trace->scratch_size = longest * 2;
+    }
+    
+    trace_record(trace, SPI_TRACE_TAG_MESSAGE);
+    put_varint(trace->file, (uint64_t)count);
+    
+    for (int i = 0; i < count; i++) {
+        const struct spi_ioc_transfer* tr = &transfers[i];
+        const uint8_t* data = (const uint8_t*)(uintptr_t)tr->tx_buf;
+        uint32_t length = tr->len;
+        uint8_t encoding = SPI_TRACE_PAYLOAD_RAW;
+        uint32_t encoded = 0;
+        
+        trace->bytes += length;
+        
+        if (!data || ((trace->flags & RPI_DISPLAY_TRACE_ELIDE_PAYLOAD) && length >= SPI_TRACE_ELIDE_MIN_BYTES)) {
+            encoding = SPI_TRACE_PAYLOAD_ELIDED;
+        } else if (tr->bits_per_word == 16 || (trace->flags & RPI_DISPLAY_TRACE_COMPRESS)) {
+            // Word transfers go through scratch to get wire byte order
+            if (tr->bits_per_word == 16) {
+                const uint16_t* words = (const uint16_t*)data;
+                for (uint32_t w = 0; w < length / 2; w++) {
+                    trace->scratch[w * 2] = words[w] >> 8;
+                    trace->scratch[w * 2 + 1] = words[w] & 0xFF;
+                }
+                data = trace->scratch;
+            } else {
+                memcpy(trace->scratch, data, length);
+                data = trace->scratch;
+            }
+            
+            if ((trace->flags & RPI_DISPLAY_TRACE_COMPRESS) && !(length & 1)) {
+                encoded = encode_rle(data, length, trace->scratch + length, length);
+                if (encoded > 0 && encoded < length) {
+                    encoding = SPI_TRACE_PAYLOAD_RLE;
+                }
+            }
+        }
+        
+        fputc(tr->bits_per_word, trace->file);
+        fputc(encoding | (tr->cs_change ? SPI_TRACE_CS_CHANGE : 0), trace->file);
+        put_varint(trace->file, tr->speed_hz);
+        put_varint(trace->file, length);
+        
+        if (encoding == SPI_TRACE_PAYLOAD_RAW) {
+            fwrite(data, 1, length, trace->file);
+            trace->bytes_written += length;
+        } else if (encoding == SPI_TRACE_PAYLOAD_RLE) {
+            put_varint(trace->file, encoded);
+            fwrite(trace->scratch + length, 1, encoded, trace->file);
+            trace->bytes_written += encoded;
+        }
+    }
+    
+    return ferror(trace->file) ? -1 : 0;
+}
+
+// Replay
+// Rebuild one SPI message from the trace and send it; RPI_DISPLAY_* result
+static int replay_message(ili9486l_ctx_t* ctx, FILE* file, uint8_t** arena, uint32_t* arena_size,
+                          spi_trace_stats_t* stats) {
+    struct spi_ioc_transfer tr[SPI_TRACE_MAX_TRANSFERS];
+    uint32_t offsets[SPI_TRACE_MAX_TRANSFERS];
+    uint32_t used = 0;
+    uint64_t count;
+    
+    if (get_varint(file, &count) < 0 || count == 0 || count > SPI_TRACE_MAX_TRANSFERS) return RPI_DISPLAY_ERROR_INVALID;
+    
+    memset(tr, 0, sizeof(struct spi_ioc_transfer) * count);
+    
+    for (uint64_t i = 0; i < count; i++) {
+        uint8_t bits, encoding;
+        uint64_t speed, length;
+        
+        if (get_u8(file, &bits) < 0 || get_u8(file, &encoding) < 0 ||
+            get_varint(file, &speed) < 0 || get_varint(file, &length) < 0) {
+            return RPI_DISPLAY_ERROR_INVALID;
+        }
+        if (length > SPI_TRACE_MAX_LENGTH - used || (bits == 16 && (length & 1))) {
+            return RPI_DISPLAY_ERROR_INVALID;
+        }
+        
+        // Payloads share one arena; pointers are fixed up once it stops growing
+        if (used + length > *arena_size) {
+            uint32_t size = (used + length) * 2;
+            uint8_t* grown = realloc(*arena, size);
+            if (!grown) return RPI_DISPLAY_ERROR_MEMORY;
+            *arena = grown;
+            *arena_size = size;
+        }
+        
+        uint8_t* wire = *arena + used;
+        
+        switch (encoding & ~SPI_TRACE_CS_CHANGE) {
+            case SPI_TRACE_PAYLOAD_RAW:
+                if (fread(wire, 1, length, file) != length) return RPI_DISPLAY_ERROR_INVALID;
+                break;
+            case SPI_TRACE_PAYLOAD_RLE:
+                if (decode_rle(file, wire, (uint32_t)length) < 0) return RPI_DISPLAY_ERROR_INVALID;
+                break;
+            case SPI_TRACE_PAYLOAD_ELIDED:
+                memset(wire, 0, length);
+                stats->bytes_elided += length;
+                break;
+            default:
+                return RPI_DISPLAY_ERROR_INVALID;
+        }
+        
+        // Back to the in-memory layout the controller expects for word transfers
+        if (bits == 16) {
+            for (uint32_t b = 0; b < length; b += 2) {
+                uint16_t word = (uint16_t)(wire[b] << 8 | wire[b + 1]);
+                memcpy(wire + b, &word, 2);
+            }
+        }
+        
+        offsets[i] = used;
+        tr[i].len = (uint32_t)length;
+        tr[i].speed_hz = (uint32_t)speed;
+        tr[i].bits_per_word = bits;
+        tr[i].cs_change = (encoding & SPI_TRACE_CS_CHANGE) ? 1 : 0;
+        used += (uint32_t)length;
+        stats->bytes += length;
+    }
+    
+    for (uint64_t i = 0; i < count; i++) {
+        tr[i].tx_buf = (unsigned long)(*arena + offsets[i]);
+    }
+    
+    stats->messages++;
+    stats->transfers += count;
+    
+    if (ctx->transport->message(ctx, tr, (int)count) < 0) {
+        return RPI_DISPLAY_ERROR_SPI;
+    }
+    
+    return RPI_DISPLAY_OK;
+}
+
+int spi_trace_replay(ili9486l_ctx_t* ctx, const char* path, int flags, spi_trace_stats_t* stats) {
+    if (!ctx || !ctx->transport || !path || !stats) return RPI_DISPLAY_ERROR_INVALID;
+    
+    memset(stats, 0, sizeof(*stats));
+    
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        perror("Failed to open SPI trace");
+        return RPI_DISPLAY_ERROR_INVALID;
+    }
+    
+    uint8_t header[16];
+    if (fread(header, 1, sizeof(header), file) != sizeof(header) ||
+        memcmp(header, SPI_TRACE_MAGIC, 4) != 0 || get_le(header + 4, 2) != SPI_TRACE_VERSION) {
+        printf("Warning: %s is not a version %d SPI trace\n", path, SPI_TRACE_VERSION);
+        fclose(file);
+        return RPI_DISPLAY_ERROR_INVALID;
+    }
+    stats->spi_speed = get_le(header + 8, 4);
+    
+    uint8_t* arena = NULL;
+    uint32_t arena_size = 0;
+    int result = RPI_DISPLAY_OK;
+    uint64_t start = trace_time_ns();
+    int tag;
+    
+    while ((tag = fgetc(file)) != EOF) {
+        uint64_t delta;
+        if (get_varint(file, &delta) < 0) {
+            result = RPI_DISPLAY_ERROR_INVALID;
+            break;
+        }
+        stats->trace_ns += delta;
+        
+        // Hold each record until its recorded offset from the start
+        if (flags & SPI_TRACE_REPLAY_REALTIME) {
+            uint64_t target = start + stats->trace_ns;
+            struct timespec ts = {
+                .tv_sec = target / 1000000000ULL,
+                .tv_nsec = target % 1000000000ULL,
+            };
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+            }
+        }
+        
+        if (tag == SPI_TRACE_TAG_LINE) {
+            uint8_t pin, value;
+            if (get_u8(file, &pin) < 0 || get_u8(file, &value) < 0) {
+                result = RPI_DISPLAY_ERROR_INVALID;
+                break;
+            }
+            stats->line_writes++;
+            if (ctx->transport->write_line(ctx, pin, value) < 0) {
+                result = RPI_DISPLAY_ERROR_GPIO;
+                break;
+            }
+        } else if (tag == SPI_TRACE_TAG_MESSAGE) {
+            result = replay_message(ctx, file, &arena, &arena_size, stats);
+            if (result != RPI_DISPLAY_OK) break;
+        } else {
+            result = RPI_DISPLAY_ERROR_INVALID;
+            break;
+        }
+        
+        stats->records++;
+    }
+    
+    stats->replay_ns = trace_time_ns() - start;
+    
+    if (result == RPI_DISPLAY_ERROR_INVALID) {
+        printf("Warning: SPI trace %s is truncated or corrupt after %llu records\n",
+               path, (unsigned long long)stats->records);
+    }
+    
+    free(arena);
+    fclose(file);
+    
+    return result;
+}
@@ -0,0 +1,133 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sprite.h"
+#include "pixel_kernels.h"
+
+sprite_t* sprite_create(const uint16_t* pixels, const uint8_t* alpha, int width, int height,
+                        int hot_x, int hot_y) {
+    if (!pixels || width <= 0 || height <= 0) return NULL;
+    
+    // Header, image, save-under and alpha in one block
+    size_t count = (size_t)width * height;
+    size_t bytes = sizeof(sprite_t) + 2 * count * sizeof(uint16_t) + (alpha ? count : 0);
+    sprite_t* sprite = calloc(1, bytes);
+    if (!sprite) {
+        perror("Failed to allocate sprite");
+        return NULL;
+    }
+    
+    sprite->pixels = (uint16_t*)(sprite + 1);
+    sprite->save = sprite->pixels + count;
+    memcpy(sprite->pixels, pixels, count * sizeof(uint16_t));
+    
+    if (alpha) {
+        sprite->alpha = (uint8_t*)(sprite->save + count);
+        memcpy(sprite->alpha, alpha, count);
+    }
+    
+    sprite->width = width;
+    sprite->height = height;
+    sprite->hot_x = hot_x;
+    sprite->hot_y = hot_y;
+    
+    return sprite;
+}
+
+void sprite_destroy(sprite_t* sprite) {
+    free(sprite);
+}
+
+int sprite_set_add(sprite_set_t* set, sprite_t* sprite) {
+    if (set->count == SPRITE_MAX) {
+        printf("Warning: At most %d sprites per display\n", SPRITE_MAX);
+        return RPI_DISPLAY_ERROR_INVALID;
+    }
+    
+    set->sprites[set->count++] = sprite;
+    return RPI_DISPLAY_OK;
+}
+
+void sprite_set_remove(sprite_set_t* set, sprite_t* sprite) {
+    for (int i = 0; i < set->count; i++) {
+        if (set->sprites[i] == sprite) {
+            memmove(&set->sprites[i], &set->sprites[i + 1], (set->count - i - 1) * sizeof(sprite_t*));
+            set->count--;
+            return;
+        }
+    }
+}
+
+bool sprite_screen_rect(const sprite_t* sprite, int screen_width, int screen_height,
+                        int* x, int* y, int* width, int* height) {
+    if (!sprite->visible) return false;
+    
+    int x0 = sprite->x - sprite->hot_x;
+    int y0 = sprite->y - sprite->hot_y;
+    int x1 = x0 + sprite->width;
+    int y1 = y0 + sprite->height;
+    
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > screen_width) x1 = screen_width;
+    if (y1 > screen_height) y1 = screen_height;
+    
+    *x = x0;
+    *y = y0;
+    *width = x1 - x0;
+    *height = y1 - y0;
+    
+    return *width > 0 && *height > 0;
+}
+
+void sprite_set_apply(sprite_set_t* set, const raster_target_t* target, bool save) {
+    const pixel_kernels_t* kernels = pixel_kernels_get();
+    
+    for (int i = 0; i < set->count; i++) {
+        sprite_t* sprite = set->sprites[i];
+        int x, y, width, height;
+        
+        sprite->saved_width = 0;
+        if (!sprite_screen_rect(sprite, target->width, target->height, &x, &y, &width, &height)) continue;
+        
+        // Offset of the visible part within the sprite
+        int src_x = x - (sprite->x - sprite->hot_x);
+        int src_y = y - (sprite->y - sprite->hot_y);
+        uint16_t* dst = &target->pixels[y * target->stride + x];
+        
+        if (save) {
+            pixel_copy_rect(sprite->save, width, dst, target->stride, width, height);
+            sprite->saved_x = x;
+            sprite->saved_y = y;
+            sprite->saved_width = width;
+            sprite->saved_height = height;
+        }
+        
+        const uint16_t* src = &sprite->pixels[src_y * sprite->width + src_x];
+        
+        if (!sprite->alpha) {
+            pixel_copy_rect(dst, target->stride, src, sprite->width, width, height);
+            continue;
+        }
+        
+        const uint8_t* alpha = &sprite->alpha[src_y * sprite->width + src_x];
+        
+        for (int row = 0; row < height; row++) {
+            kernels->blend_a8(&dst[row * target->stride], &src[row * sprite->width],
+                              &alpha[row * sprite->width], width);
+        }
+    }
+}
+
+void sprite_set_restore(sprite_set_t* set, const raster_target_t* target) {
+    // Top first, so overlapping sprites unwind to the original pixels
+    for (int i = set->count - 1; i >= 0; i--) {
+        sprite_t* sprite = set->sprites[i];
+        if (sprite->saved_width == 0) continue;
+        
+        pixel_copy_rect(&target->pixels[sprite->saved_y * target->stride + sprite->saved_x], target->stride,
+                        sprite->save, sprite->saved_width, sprite->saved_width, sprite->saved_height);
+        sprite->saved_width = 0;
+    }
+}
@@ -0,0 +1,185 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "surface.h"
+
+// Header padded so the pixels after it start on a cache line
+#define SURFACE_HEADER_SIZE  ((sizeof(surface_t) + SURFACE_ALIGN - 1) & ~(size_t)(SURFACE_ALIGN - 1))
+
+// Free blocks are linked through their first bytes
+typedef struct free_block {
+    struct free_block* next;
+} free_block_t;
+
+// Pool state, shared by every display in the process
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static free_block_t* free_lists[SURFACE_POOL_CLASSES];
+static uint8_t* arena_next;
+static size_t arena_left;
+static surface_pool_stats_t pool_stats;
+
+// Static helper functions
+static int size_class(size_t size);
+static size_t class_bytes(int cls);
+static void* pool_alloc(size_t size, int* cls, size_t* block_size);
+static void pool_free(void* block, int cls, size_t block_size);
+
+surface_t* surface_create(int width, int height) {
+    if (width <= 0 || height <= 0 || width > SURFACE_MAX_SIDE || height > SURFACE_MAX_SIDE) {
+        return NULL;
+    }
+    
+    int stride = (width + SURFACE_STRIDE_PIXELS - 1) & ~(SURFACE_STRIDE_PIXELS - 1);
+    size_t pixel_bytes = (size_t)stride * height * sizeof(uint16_t);
+    int cls;
+    size_t block_size;
+    uint8_t* block = pool_alloc(SURFACE_HEADER_SIZE + pixel_bytes, &cls, &block_size);
+    
+    if (!block) {
+        perror("Failed to allocate surface");
+        return NULL;
+    }
+    
+    surface_t* surface = (surface_t*)block;
+    surface->target.pixels = (uint16_t*)(block + SURFACE_HEADER_SIZE);
+    surface->target.width = width;
+    surface->target.height = height;
+    surface->target.stride = stride;
+    surface->block_size = block_size;
+    surface->size_class = cls;
+    surface->layer = NULL;
+    
+    memset(surface->target.pixels, 0, pixel_bytes);
+    
+    return surface;
+}
+
+void surface_destroy(surface_t* surface) {
+    if (!surface) return;
+    
+    pool_free(surface, surface->size_class, surface->block_size);
+}
+
+void surface_pool_get_stats(surface_pool_stats_t* stats) {
+    pthread_mutex_lock(&pool_lock);
+    *stats = pool_stats;
+    pthread_mutex_unlock(&pool_lock);
+}
+
+void surface_pool_trim(void) {
+    pthread_mutex_lock(&pool_lock);
+    
+    for (int cls = 0; cls < SURFACE_POOL_CLASSES; cls++) {
+        size_t bytes = class_bytes(cls);
+        if (bytes <= SURFACE_ARENA_MAX_BLOCK) continue;
+        
+        while (free_lists[cls]) {
+            free_block_t* block = free_lists[cls];
+            free_lists[cls] = block->next;
+            free(block);
+            pool_stats.bytes_cached -= bytes;
+            pool_stats.bytes_reserved -= bytes;
+        }
+    }
+    
+    pthread_mutex_unlock(&pool_lock);
+}
+
+// Smallest class holding size bytes, or -1 past the largest. Sizes in
+// (2^k, 2^(k+1)] round up to a multiple of 2^(k-2).
+static int size_class(size_t size) {
+    if (size <= (size_t)1 << SURFACE_POOL_MIN_SHIFT) return 0;
+    if (size > (size_t)1 << SURFACE_POOL_MAX_SHIFT) return -1;
+    
+    int shift = 63 - __builtin_clzll((unsigned long long)size - 1);
+    size_t step = (size_t)1 << (shift - 2);
+    size_t steps = (size + step - 1) / step;  // 5..8
+    
+    return (shift - SURFACE_POOL_MIN_SHIFT) * SURFACE_POOL_STEPS + (int)steps - SURFACE_POOL_STEPS;
+}
+
+static size_t class_bytes(int cls) {
+    if (cls == 0) return (size_t)1 << SURFACE_POOL_MIN_SHIFT;
+    
+    int shift = SURFACE_POOL_MIN_SHIFT + (cls - 1) / SURFACE_POOL_STEPS;
+    size_t step = (size_t)1 << (shift - 2);
+    
+    return (SURFACE_POOL_STEPS + 1 + (cls - 1) % SURFACE_POOL_STEPS) * step;
+}
+
+static void* pool_alloc(size_t size, int* cls, size_t* block_size) {
+    int c = size_class(size);
+    void* block = NULL;
+    
+    pthread_mutex_lock(&pool_lock);
+    
+    if (c < 0) {
+        // Too big to pool: one aligned allocation, freed on destroy
+        size_t bytes = (size + SURFACE_ALIGN - 1) & ~(size_t)(SURFACE_ALIGN - 1);
+        block = aligned_alloc(SURFACE_ALIGN, bytes);
+        if (block) {
+            *block_size = bytes;
+            pool_stats.bytes_reserved += bytes;
+        }
+    } else if (free_lists[c]) {
+        block = free_lists[c];
+        free_lists[c] = free_lists[c]->next;
+        *block_size = class_bytes(c);
+        pool_stats.bytes_cached -= *block_size;
+        pool_stats.reused++;
+    } else if (class_bytes(c) <= SURFACE_ARENA_MAX_BLOCK) {
+        size_t bytes = class_bytes(c);
+        
+        // The tail of a spent arena is abandoned; it is smaller than one block
+        if (arena_left < bytes) {
+            arena_next = aligned_alloc(SURFACE_ALIGN, SURFACE_ARENA_SIZE);
+            arena_left = arena_next ? SURFACE_ARENA_SIZE : 0;
+            if (arena_next) pool_stats.bytes_reserved += SURFACE_ARENA_SIZE;
+        }
+        
+        if (arena_left >= bytes) {
+            block = arena_next;
+            arena_next += bytes;
+            arena_left -= bytes;
+            *block_size = bytes;
+        }
+    } else {
+        block = aligned_alloc(SURFACE_ALIGN, class_bytes(c));
+        if (block) {
+            *block_size = class_bytes(c);
+            pool_stats.bytes_reserved += *block_size;
+        }
+    }
+    
+    if (block) {
+        *cls = c;
+        pool_stats.allocations++;
+        pool_stats.surfaces++;
+        pool_stats.bytes_in_use += *block_size;
+    }
+    
+    pthread_mutex_unlock(&pool_lock);
+    
+    return block;
+}
+
+static void pool_free(void* block, int cls, size_t block_size) {
+    pthread_mutex_lock(&pool_lock);
+    
+    pool_stats.surfaces--;
+    pool_stats.bytes_in_use -= block_size;
+    
+    if (cls < 0) {
+        free(block);
+        pool_stats.bytes_reserved -= block_size;
+    } else {
+        free_block_t* node = block;
+        node->next = free_lists[cls];
+        free_lists[cls] = node;
+        pool_stats.bytes_cached += block_size;
+    }
+    
+    pthread_mutex_unlock(&pool_lock);
+}
@@ -0,0 +1,270 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "text_render.h"
+#include "pixel_kernels.h"
+
+// Pixel lanes selected by a nibble of glyph bits, leftmost pixel first
+static const uint16_t nibble_lanes[16][4] = {
+    {0x0000, 0x0000, 0x0000, 0x0000},
+    {0x0000, 0x0000, 0x0000, 0xFFFF},
+    {0x0000, 0x0000, 0xFFFF, 0x0000},
+    {0x0000, 0x0000, 0xFFFF, 0xFFFF},
+    {0x0000, 0xFFFF, 0x0000, 0x0000},
+    {0x0000, 0xFFFF, 0x0000, 0xFFFF},
+    {0x0000, 0xFFFF, 0xFFFF, 0x0000},
+    {0x0000, 0xFFFF, 0xFFFF, 0xFFFF},
+    {0xFFFF, 0x0000, 0x0000, 0x0000},
+    {0xFFFF, 0x0000, 0x0000, 0xFFFF},
+    {0xFFFF, 0x0000, 0xFFFF, 0x0000},
+    {0xFFFF, 0x0000, 0xFFFF, 0xFFFF},
+    {0xFFFF, 0xFFFF, 0x0000, 0x0000},
+    {0xFFFF, 0xFFFF, 0x0000, 0xFFFF},
+    {0xFFFF, 0xFFFF, 0xFFFF, 0x0000},
+    {0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF},
+};
+
+// Static helper functions
+static void blend_byte(uint16_t* dst, unsigned int bits, uint64_t color4);
+static void draw_coverage(const raster_target_t* target, const font_t* font, uint32_t glyph,
+                          int x, int y, uint16_t color);
+static uint32_t glyph_coverage(const font_t* font, const uint8_t* row, int c);
+static void expand_glyph(uint16_t* cell, const font_t* font, uint32_t glyph, uint16_t fg, uint16_t bg);
+static uint32_t cache_set(const font_t* font, uint32_t glyph, uint32_t colors);
+static void reset_entries(glyph_cache_t* cache);
+
+void glyph_cache_init(glyph_cache_t* cache) {
+    memset(cache, 0, sizeof(*cache));
+    reset_entries(cache);
+}
+
+void glyph_cache_destroy(glyph_cache_t* cache) {
+    free(cache->pixels);
+    memset(cache, 0, sizeof(*cache));
+}
+
+const uint16_t* glyph_cache_get(glyph_cache_t* cache, const font_t* font, uint32_t glyph,
+                                uint16_t fg, uint16_t bg) {
+    int cell_pixels = font->width * font->height;
+    uint32_t colors = (uint32_t)fg << 16 | bg;
+    
+    // Entries are fixed size, so a bigger cell regrows the store and starts over
+    if (cell_pixels > cache->cell_pixels) {
+        size_t entries = GLYPH_CACHE_SETS * GLYPH_CACHE_WAYS;
+        uint16_t* pixels = malloc(entries * cell_pixels * sizeof(uint16_t));
+        if (!pixels) return NULL;
+        
+        free(cache->pixels);
+        cache->pixels = pixels;
+        cache->cell_pixels = cell_pixels;
+        reset_entries(cache);
+    }
+    
+    glyph_cache_entry_t* ways = &cache->entries[cache_set(font, glyph, colors) * GLYPH_CACHE_WAYS];
+    glyph_cache_entry_t entry;
+    int way;
+    
+    for (way = 0; way < GLYPH_CACHE_WAYS; way++) {
+        if (ways[way].font_id == font->id && ways[way].glyph == glyph && ways[way].colors == colors) {
+            break;
+        }
+    }
+    
+    if (way < GLYPH_CACHE_WAYS) {
+        cache->hits++;
+        if (way == 0) {
+            return &cache->pixels[ways[0].slot * cache->cell_pixels];
+        }
+        entry = ways[way];
+    } else {
+        // Evict the least recently used way and reuse its pixels
+        cache->misses++;
+        way = GLYPH_CACHE_WAYS - 1;
+        entry = ways[way];
+        entry.font_id = font->id;
+        entry.glyph = glyph;
+        entry.colors = colors;
+        expand_glyph(&cache->pixels[entry.slot * cache->cell_pixels], font, glyph, fg, bg);
+    }
+    
+    // Most recent first, so a run of one glyph hits way 0 every time
+    memmove(&ways[1], &ways[0], way * sizeof(glyph_cache_entry_t));
+    ways[0] = entry;
+    
+    return &cache->pixels[entry.slot * cache->cell_pixels];
+}
+
+void text_draw_glyph(const raster_target_t* target, const font_t* font, uint32_t glyph,
+                     int x, int y, uint16_t color) {
+    const uint8_t* bits = font_glyph(font, glyph);
+    int span = font->row_bytes * 8;
+    
+    if (x >= target->width || y >= target->height || x + font->width <= 0 || y + font->height <= 0) {
+        return;
+    }
+    
+    if (font->bpp > 1) {
+        draw_coverage(target, font, glyph, x, y, color);
+        return;
+    }
+    
+    // Whole cell on screen: blend eight pixels per byte of glyph bits
+    if (x >= 0 && y >= 0 && x + span <= target->width && y + font->height <= target->height) {
+        uint64_t color4 = color * 0x0001000100010001ULL;
+        uint8_t last_mask = (uint8_t)(0xFF << (span - font->width));
+        uint16_t* row = &target->pixels[y * target->stride + x];
+        
+        for (int r = 0; r < font->height; r++) {
+            for (int b = 0; b < font->row_bytes; b++) {
+                unsigned int byte = bits[b];
+                if (b == font->row_bytes - 1) byte &= last_mask;
+                
+                blend_byte(&row[b * 8], byte, color4);
+            }
+            
+            bits += font->row_bytes;
+            row += target->stride;
+        }
+        return;
+    }
+    
+    // Clipped at an edge
+    for (int r = 0; r < font->height; r++, bits += font->row_bytes) {
+        int py = y + r;
+        if (py < 0 || py >= target->height) continue;
+        
+        for (int c = 0; c < font->width; c++) {
+            int px = x + c;
+            if (px >= 0 && px < target->width && (bits[c >> 3] & (0x80 >> (c & 7)))) {
+                target->pixels[py * target->stride + px] = color;
+            }
+        }
+    }
+}
+
+void text_draw_glyph_opaque(const raster_target_t* target, glyph_cache_t* cache, const font_t* font,
+                            uint32_t glyph, int x, int y, uint16_t fg, uint16_t bg) {
+    int x0 = x < 0 ? 0 : x;
+    int y0 = y < 0 ? 0 : y;
+    int x1 = x + font->width < target->width ? x + font->width : target->width;
+    int y1 = y + font->height < target->height ? y + font->height : target->height;
+    
+    if (x0 >= x1 || y0 >= y1) return;
+    
+    const uint16_t* cell = glyph_cache_get(cache, font, glyph, fg, bg);
+    
+    if (!cell) {
+        const uint8_t* bits = font_glyph(font, glyph);
+        
+        for (int py = y0; py < y1; py++) {
+            const uint8_t* row = &bits[(py - y) * font->row_bytes];
+            for (int px = x0; px < x1; px++) {
+                target->pixels[py * target->stride + px] = pixel_blend565(bg, fg, glyph_coverage(font, row, px - x));
+            }
+        }
+        return;
+    }
+    
+    // One rect copy of the visible part of the cell
+    const uint16_t* src = &cell[(y0 - y) * font->width + (x0 - x)];
+    uint16_t* dst = &target->pixels[y0 * target->stride + x0];
+    int width = x1 - x0;
+    
+    for (int py = y0; py < y1; py++) {
+        memcpy(dst, src, width * sizeof(uint16_t));
+        src += font->width;
+        dst += target->stride;
+    }
+}
+
+// Write color into the eight pixels bits selects, leave the rest. No
+// branches: glyph bits are too irregular for the predictor.
+static inline void blend_byte(uint16_t* dst, unsigned int bits, uint64_t color4) {
+    uint64_t high, low, left, right;
+    
+    memcpy(&high, nibble_lanes[bits >> 4], sizeof(high));
+    memcpy(&low, nibble_lanes[bits & 0x0F], sizeof(low));
+    memcpy(&left, dst, sizeof(left));
+    memcpy(&right, dst + 4, sizeof(right));
+    left = (left & ~high) | (color4 & high);
+    right = (right & ~low) | (color4 & low);
+    memcpy(dst, &left, sizeof(left));
+    memcpy(dst + 4, &right, sizeof(right));
+}
+
+// Blend color through the glyph's coverage one clipped row at a time
+static void draw_coverage(const raster_target_t* target, const font_t* font, uint32_t glyph,
+                          int x, int y, uint16_t color) {
+    const pixel_kernels_t* kernels = pixel_kernels_get();
+    const uint8_t* bits = font_glyph(font, glyph);
+    int x0 = x < 0 ? 0 : x;
+    int y0 = y < 0 ? 0 : y;
+    int x1 = x + font->width < target->width ? x + font->width : target->width;
+    int y1 = y + font->height < target->height ? y + font->height : target->height;
+    uint8_t coverage[256];
+    
+    for (int py = y0; py < y1; py++) {
+        const uint8_t* row = &bits[(py - y) * font->row_bytes];
+        const uint8_t* alpha = coverage;
+        
+        if (font->bpp == 8) {
+            alpha = &row[x0 - x];
+        } else {
+            for (int px = x0; px < x1; px++) {
+                coverage[px - x0] = glyph_coverage(font, row, px - x);
+            }
+        }
+        
+        kernels->blend_color_a8(&target->pixels[py * target->stride + x0], color, alpha, x1 - x0);
+    }
+}
+
+// Coverage of pixel c in a glyph row, 0..255 whatever the depth
+static inline uint32_t glyph_coverage(const font_t* font, const uint8_t* row, int c) {
+    switch (font->bpp) {
+        case 8:
+            return row[c];
+        case 4:
+            return ((row[c >> 1] >> ((~c & 1) * 4)) & 0x0F) * 17;
+        default:
+            return (row[c >> 3] & (0x80 >> (c & 7))) ? 255 : 0;
+    }
+}
+
+static void expand_glyph(uint16_t* cell, const font_t* font, uint32_t glyph, uint16_t fg, uint16_t bg) {
+    const uint8_t* bits = font_glyph(font, glyph);
+    
+    if (font->bpp > 1) {
+        for (int r = 0; r < font->height; r++, bits += font->row_bytes) {
+            for (int c = 0; c < font->width; c++) {
+                *cell++ = pixel_blend565(bg, fg, glyph_coverage(font, bits, c));
+            }
+        }
+        return;
+    }
+    
+    for (int r = 0; r < font->height; r++, bits += font->row_bytes) {
+        for (int c = 0; c < font->width; c++) {
+            *cell++ = (bits[c >> 3] & (0x80 >> (c & 7))) ? fg : bg;
+        }
+    }
+}
+
+// Multiplicative hash; the top bits depend on every key bit
+static uint32_t cache_set(const font_t* font, uint32_t glyph, uint32_t colors) {
+    uint32_t hash = glyph;
+    
+    hash ^= colors * 0x85EBCA77u;
+    hash ^= font->id * 0xC2B2AE35u;
+    hash *= 0x9E3779B1u;
+    
+    return hash >> (32 - GLYPH_CACHE_SET_BITS);
+}
+
+// Empty every entry and give each its own pixel slot
+static void reset_entries(glyph_cache_t* cache) {
+    for (int i = 0; i < GLYPH_CACHE_SETS * GLYPH_CACHE_WAYS; i++) {
+        cache->entries[i].font_id = 0;
+        cache->entries[i].slot = i;
+    }
+}
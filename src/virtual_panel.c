@@ -0,0 +1,301 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "virtual_panel.h"
+#include "ili9486l_driver.h"
+
+// Static helper functions
+static void panel_command(virtual_panel_t* panel, uint8_t command);
+static void panel_param(virtual_panel_t* panel, uint8_t value);
+static void panel_pixel(virtual_panel_t* panel, uint16_t color);
+static void panel_map(const virtual_panel_t* panel, int col, int page, int* x, int* y);
+
+virtual_panel_t* virtual_panel_create(uint32_t spi_speed) {
+    virtual_panel_t* panel = calloc(1, sizeof(virtual_panel_t));
+    if (!panel) {
+        return NULL;
+    }
+    
+    panel->spi_speed = spi_speed > 0 ? spi_speed : SPI_MAX_SPEED_HZ;
+    virtual_panel_reset(panel);
+    
+    return panel;
+}
+
+void virtual_panel_destroy(virtual_panel_t* panel) {
+    free(panel);
+}
+
+// Register defaults after hardware or software reset; GRAM is kept
+void virtual_panel_reset(virtual_panel_t* panel) {
+    panel->command = 0;
+    panel->param_count = 0;
+    panel->pixel_half = false;
+    panel->col_start = 0;
+    panel->col_end = DISPLAY_WIDTH - 1;
+    panel->page_start = 0;
+    panel->page_end = DISPLAY_HEIGHT - 1;
+    panel->col = 0;
+    panel->page = 0;
+    panel->madctl = 0;
+    panel->scroll_tfa = 0;
+    panel->scroll_vsa = DISPLAY_HEIGHT;
+    panel->scroll_bfa = 0;
+    panel->scroll_start = 0;
+}
+
+void virtual_panel_set_dc(virtual_panel_t* panel, int dc) {
+    panel->dc = dc;
+}
+
+void virtual_panel_write(virtual_panel_t* panel, const uint8_t* data, size_t length) {
+    panel->bytes += length;
+    
+    if (panel->dc == 0) {
+        for (size_t i = 0; i < length; i++) {
+            panel_command(panel, data[i]);
+        }
+        return;
+    }
+    
+    if (panel->command != ILI9486L_RAMWR && panel->command != ILI9486L_RAMWRC) {
+        for (size_t i = 0; i < length; i++) {
+            panel_param(panel, data[i]);
+        }
+        return;
+    }
+    
+    // Pixel data, 16 bpp high byte first; a pixel may straddle transfers
+    size_t i = 0;
+    if (panel->pixel_half && length > 0) {
+        panel_pixel(panel, (uint16_t)(panel->pixel_high << 8 | data[0]));
+        panel->pixel_half = false;
+        i = 1;
+    }
+    for (; i + 1 < length; i += 2) {
+        panel_pixel(panel, (uint16_t)(data[i] << 8 | data[i + 1]));
+    }
+    if (i < length) {
+        panel->pixel_high = data[i];
+        panel->pixel_half = true;
+    }
+}
+
+void virtual_panel_read_frame(const virtual_panel_t* panel, uint16_t* pixels) {
+    bool exchange = panel->madctl & ILI9486L_MADCTL_MV;
+    int width = exchange ? DISPLAY_HEIGHT : DISPLAY_WIDTH;
+    int height = exchange ? DISPLAY_WIDTH : DISPLAY_HEIGHT;
+    int tfa = panel->scroll_tfa;
+    int vsa = panel->scroll_vsa;
+    bool scrolling = vsa > 0 && tfa + vsa <= DISPLAY_HEIGHT;
+    int vsp = panel->scroll_start;
+    
+    if (scrolling && (vsp < tfa || vsp >= tfa + vsa)) {
+        vsp = tfa;
+    }
+    
+    for (int page = 0; page < height; page++) {
+        for (int col = 0; col < width; col++) {
+            int x, y;
+            panel_map(panel, col, page, &x, &y);
+            
+            // Scan line y of the scroll area shows GRAM row VSP + (y - TFA), wrapped
+            if (scrolling && y >= tfa && y < tfa + vsa) {
+                y = tfa + ((vsp - tfa) + (y - tfa)) % vsa;
+            }
+            
+            pixels[page * width + col] = panel->gram[y][x];
+        }
+    }
+}
+
+// Logical column/page address to native GRAM position. MX and MY mirror
+// the logical axes, MV then exchanges them.
+static void panel_map(const virtual_panel_t* panel, int col, int page, int* x, int* y) {
+    bool exchange = panel->madctl & ILI9486L_MADCTL_MV;
+    int width = exchange ? DISPLAY_HEIGHT : DISPLAY_WIDTH;
+    int height = exchange ? DISPLAY_WIDTH : DISPLAY_HEIGHT;
+    
+    if (panel->madctl & ILI9486L_MADCTL_MX) col = width - 1 - col;
+    if (panel->madctl & ILI9486L_MADCTL_MY) page = height - 1 - page;
+    
+    if (exchange) {
+        *x = page;
+        *y = col;
+    } else {
+        *x = col;
+        *y = page;
+    }
+}
+
+static void panel_command(virtual_panel_t* panel, uint8_t command) {
+    panel->commands++;
+    panel->command = command;
+    panel->param_count = 0;
+    panel->pixel_half = false;
+    
+    switch (command) {
+        case ILI9486L_SWRESET:
+            virtual_panel_reset(panel);
+            break;
+        case ILI9486L_RAMWR:
+            panel->col = panel->col_start;
+            panel->page = panel->page_start;
+            break;
+        default:
+            break;
+    }
+}
+
+static void panel_param(virtual_panel_t* panel, uint8_t value) {
+    if (panel->param_count < sizeof(panel->params)) {
+        panel->params[panel->param_count] = value;
+    }
+    panel->param_count++;
+    
+    const uint8_t* p = panel->params;
+    
+    switch (panel->command) {
+        case ILI9486L_CASET:
+            if (panel->param_count == 4) {
+                panel->col_start = p[0] << 8 | p[1];
+                panel->col_end = p[2] << 8 | p[3];
+            }
+            break;
+        case ILI9486L_PASET:
+            if (panel->param_count == 4) {
+                panel->page_start = p[0] << 8 | p[1];
+                panel->page_end = p[2] << 8 | p[3];
+            }
+            break;
+        case ILI9486L_MADCTL:
+            if (panel->param_count == 1) {
+                panel->madctl = p[0];
+            }
+            break;
+        case ILI9486L_VSCRDEF:
+            if (panel->param_count == 6) {
+                panel->scroll_tfa = p[0] << 8 | p[1];
+                panel->scroll_vsa = p[2] << 8 | p[3];
+                panel->scroll_bfa = p[4] << 8 | p[5];
+            }
+            break;
+        case ILI9486L_VSCRSADD:
+            if (panel->param_count == 2) {
+                panel->scroll_start = p[0] << 8 | p[1];
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+// Store at the cursor and advance through the window, columns first
+static void panel_pixel(virtual_panel_t* panel, uint16_t color) {
+    bool exchange = panel->madctl & ILI9486L_MADCTL_MV;
+    int width = exchange ? DISPLAY_HEIGHT : DISPLAY_WIDTH;
+    int height = exchange ? DISPLAY_WIDTH : DISPLAY_HEIGHT;
+    
+    if (panel->col < width && panel->page < height) {
+        int x, y;
+        panel_map(panel, panel->col, panel->page, &x, &y);
+        panel->gram[y][x] = color;
+    }
+    panel->pixels++;
+    
+    if (panel->col < panel->col_end) {
+        panel->col++;
+        return;
+    }
+    
+    panel->col = panel->col_start;
+    panel->page = panel->page < panel->page_end ? panel->page + 1 : panel->page_start;
+}
+
+// Transport glue
+static int virtual_open(ili9486l_ctx_t* ctx, const display_config_t* config) {
+    (void)config;
+    
+    virtual_panel_t* panel = virtual_panel_create(ctx->spi_speed);
+    if (!panel) {
+        perror("Failed to allocate virtual panel");
+        return RPI_DISPLAY_ERROR_MEMORY;
+    }
+    
+    ctx->transport_data = panel;
+    return RPI_DISPLAY_OK;
+}
+
+static void virtual_close(ili9486l_ctx_t* ctx) {
+    virtual_panel_destroy(ctx->transport_data);
+    ctx->transport_data = NULL;
+}
+
+static int virtual_message(ili9486l_ctx_t* ctx, struct spi_ioc_transfer* transfers, int count) {
+    virtual_panel_t* panel = ctx->transport_data;
+    
+    panel->messages++;
+    panel->bus_ns += VIRTUAL_PANEL_MESSAGE_GAP_NS;
+    
+    for (int i = 0; i < count; i++) {
+        const struct spi_ioc_transfer* tr = &transfers[i];
+        uint32_t speed = tr->speed_hz ? tr->speed_hz : panel->spi_speed;
+        
+        panel->bus_ns += (uint64_t)tr->len * 8 * 1000000000ULL / speed;
+        if (!tr->tx_buf) continue;
+        
+        if (tr->bits_per_word == 16) {
+            // Words leave the controller MSB first
+            const uint16_t* words = (const uint16_t*)(uintptr_t)tr->tx_buf;
+            for (uint32_t w = 0; w < tr->len / 2; w++) {
+                uint8_t bytes[2] = { words[w] >> 8, words[w] & 0xFF };
+                virtual_panel_write(panel, bytes, 2);
+            }
+        } else {
+            virtual_panel_write(panel, (const uint8_t*)(uintptr_t)tr->tx_buf, tr->len);
+        }
+    }
+    
+    return 0;
+}
+
+static int virtual_write_line(ili9486l_ctx_t* ctx, int pin, int value) {
+    virtual_panel_t* panel = ctx->transport_data;
+    
+    switch (pin) {
+        case GPIO_DC:
+            virtual_panel_set_dc(panel, value);
+            break;
+        case GPIO_RST:
+            if (!value) virtual_panel_reset(panel);
+            break;
+        case GPIO_LED:
+            panel->backlight = value;
+            break;
+        default:
+            break;
+    }
+    
+    return 0;
+}
+
+static uint64_t virtual_bus_time_ns(ili9486l_ctx_t* ctx) {
+    virtual_panel_t* panel = ctx->transport_data;
+    return panel->bus_ns;
+}
+
+static int virtual_read_frame(ili9486l_ctx_t* ctx, uint16_t* pixels) {
+    virtual_panel_read_frame(ctx->transport_data, pixels);
+    return 0;
+}
+
+const ili9486l_transport_t virtual_panel_transport = {
+    .name = "virtual",
+    .open = virtual_open,
+    .close = virtual_close,
+    .message = virtual_message,
+    .write_line = virtual_write_line,
+    .bus_time_ns = virtual_bus_time_ns,
+    .read_frame = virtual_read_frame,
+};
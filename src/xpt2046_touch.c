@@ -5,6 +5,9 @@
 #include <fcntl.h>
 #include <sys/ioctl.h>
 #include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <poll.h>
 #include <errno.h>
 #include <time.h>
 #include <math.h>
@@ -15,9 +18,52 @@
 #include "ili9486l_driver.h"
 
 // Static helper functions
-static void delay_ms(int ms);
 static uint64_t get_time_ns(void);
 static int median_filter(int16_t* values, int count);
+static int sample_spread(const int16_t* values, int count);
+static int16_t smooth_axis(touch_axis_filter_t* axis, int16_t raw, float dt);
+static float smoothing_alpha(float cutoff, float dt);
+static int touch_gpio_set_cs(xpt2046_ctx_t* ctx, int value);
+static int touch_gpio_get_irq(xpt2046_ctx_t* ctx);
+static uint32_t gpio_syscalls(const xpt2046_ctx_t* ctx);
+static int touch_pressure(int z1, int z2);
+static void build_sampler(xpt2046_ctx_t* ctx);
+static int sampler_result(const xpt2046_ctx_t* ctx, int conversion);
+static void count_report(xpt2046_ctx_t* ctx, uint64_t now, bool pen_down);
+static uint32_t queue_free(xpt2046_ctx_t* ctx);
+static void queue_event(xpt2046_ctx_t* ctx, const touch_event_t* event);
+static uint32_t flush_pending_move(xpt2046_ctx_t* ctx);
+static void push_event(xpt2046_ctx_t* ctx, touch_event_type_t type, int16_t pressure, uint64_t now);
+static int signal_events(xpt2046_ctx_t* ctx);
+static int add_fd(xpt2046_ctx_t* ctx, int fd, uint32_t events);
+static uint32_t clear_interrupt(xpt2046_ctx_t* ctx);
+static uint32_t set_interrupt_armed(xpt2046_ctx_t* ctx, bool armed);
+static uint32_t set_report_timer(xpt2046_ctx_t* ctx, bool periodic);
+static uint32_t stop_report_timer(xpt2046_ctx_t* ctx);
+static void report_touch(xpt2046_ctx_t* ctx, uint64_t wake_ns, uint32_t syscalls);
+static void enter_idle(xpt2046_ctx_t* ctx);
+
+// Touch GPIO helper functions
+static int touch_gpio_set_cs(xpt2046_ctx_t* ctx, int value) {
+    if (ctx->gpio_backend == GPIO_BACKEND_CHARDEV) {
+        return gpio_line_set_value(ctx->gpio_fd_cs, value);
+    }
+    
+    return gpio_set_value(GPIO_TOUCH_CS, value);
+}
+
+static int touch_gpio_get_irq(xpt2046_ctx_t* ctx) {
+    if (ctx->gpio_backend == GPIO_BACKEND_CHARDEV) {
+        return gpio_line_get_value(ctx->gpio_fd_irq);
+    }
+    
+    return gpio_get_value(GPIO_TOUCH_IRQ);
+}
+
+// Kernel entries per line access: one ioctl, or open/access/close on sysfs
+static uint32_t gpio_syscalls(const xpt2046_ctx_t* ctx) {
+    return ctx->gpio_backend == GPIO_BACKEND_CHARDEV ? 1 : 3;
+}
 
 // Touch SPI helper functions
 int touch_spi_init(xpt2046_ctx_t* ctx) {
@@ -85,21 +131,21 @@ int xpt2046_read_channel(xpt2046_ctx_t* ctx, uint8_t channel) {
     uint8_t tx_data[3] = {XPT2046_START_BIT | channel, 0x00, 0x00};
     uint8_t rx_data[3] = {0, 0, 0};
     
-    // Set touch CS low
-    gpio_set_value(GPIO_TOUCH_CS, 0);
+    // Set touch CS low, unless the SPI controller does it
+    if (ctx->software_cs) touch_gpio_set_cs(ctx, 0);
     
     // Transfer data
-    if (touch_spi_transfer(ctx, tx_data, rx_data, 3) < 0) {
-        gpio_set_value(GPIO_TOUCH_CS, 1);
-        return -1;
-    }
+    int result = touch_spi_transfer(ctx, tx_data, rx_data, 3);
     
     // Set touch CS high
-    gpio_set_value(GPIO_TOUCH_CS, 1);
+    if (ctx->software_cs) touch_gpio_set_cs(ctx, 1);
+    
+    if (result < 0) {
+        return -1;
+    }
     
     // Extract 12-bit value from response
-    int result = ((rx_data[1] & 0x7F) << 5) | (rx_data[2] >> 3);
-    return result;
+    return ((rx_data[1] & 0x7F) << 5) | (rx_data[2] >> 3);
 }
 
 int xpt2046_read_raw_x(xpt2046_ctx_t* ctx) {
@@ -114,45 +160,150 @@ int xpt2046_read_pressure(xpt2046_ctx_t* ctx) {
     int z1 = xpt2046_read_channel(ctx, XPT2046_Z1_MEASURE);
     int z2 = xpt2046_read_channel(ctx, XPT2046_Z2_MEASURE);
     
-    if (z1 == 0) return 0;
+    return touch_pressure(z1, z2);
+}
+
+int xpt2046_read_samples(xpt2046_ctx_t* ctx, int count, int16_t* x, int16_t* y, int16_t* pressure) {
+    if (count > TOUCH_MAX_SAMPLES) count = TOUCH_MAX_SAMPLES;
     
-    // Calculate pressure using formula from datasheet
-    int pressure = (z2 - z1) * 1000 / z1;
-    return pressure;
+    // The command stream covers TOUCH_MAX_SAMPLES; a shorter message ends
+    // on an empty byte rather than starting one more conversion
+    uint32_t length = count * XPT2046_CHANNELS * 2 + 1;
+    uint8_t next_command = ctx->sample_tx[length - 1];
+    ctx->sample_tx[length - 1] = 0;
+    
+    if (ctx->software_cs) touch_gpio_set_cs(ctx, 0);
+    
+    // The controller holds its chip select across the whole message
+    int result = touch_spi_transfer(ctx, ctx->sample_tx, ctx->sample_rx, length);
+    
+    if (ctx->software_cs) touch_gpio_set_cs(ctx, 1);
+    
+    ctx->sample_tx[length - 1] = next_command;
+    
+    ctx->stats.spi_ioctls++;
+    ctx->stats.syscalls += 1 + (ctx->software_cs ? 2 * gpio_syscalls(ctx) : 0);
+    
+    if (result < 0) return -1;
+    
+    int valid = 0;
+    
+    for (int i = 0; i < count; i++) {
+        int conversion = i * XPT2046_CHANNELS;
+        int sx = sampler_result(ctx, conversion);
+        int sy = sampler_result(ctx, conversion + 1);
+        int sp = touch_pressure(sampler_result(ctx, conversion + 2), sampler_result(ctx, conversion + 3));
+        
+        ctx->stats.samples++;
+        
+        if (sx > 0 && sy > 0 && sp > TOUCH_PRESSURE_THRESHOLD) {
+            x[valid] = sx;
+            y[valid] = sy;
+            if (pressure) pressure[valid] = sp > INT16_MAX ? INT16_MAX : sp;
+            valid++;
+        } else {
+            ctx->stats.rejected++;
+        }
+    }
+    
+    return valid;
 }
 
-// Filtering functions
-void xpt2046_filter_touch(xpt2046_ctx_t* ctx, int16_t raw_x, int16_t raw_y, int16_t* filtered_x, int16_t* filtered_y) {
-    // Add new values to circular buffer
-    ctx->filter_x[ctx->filter_index] = raw_x;
-    ctx->filter_y[ctx->filter_index] = raw_y;
-    ctx->filter_index = (ctx->filter_index + 1) % TOUCH_SAMPLE_COUNT;
+void xpt2046_get_stats(xpt2046_ctx_t* ctx, touch_stats_t* stats) {
+    pthread_mutex_lock(&ctx->touch_mutex);
+    *stats = ctx->stats;
+    pthread_mutex_unlock(&ctx->touch_mutex);
     
-    if (!ctx->filter_initialized) {
-        // Fill buffer with initial values
-        for (int i = 0; i < TOUCH_SAMPLE_COUNT; i++) {
-            ctx->filter_x[i] = raw_x;
-            ctx->filter_y[i] = raw_y;
+    stats->syscalls_per_report = stats->reports ? (float)stats->syscalls / stats->reports : 0.0f;
+}
+
+void xpt2046_reset_stats(xpt2046_ctx_t* ctx) {
+    pthread_mutex_lock(&ctx->touch_mutex);
+    memset(&ctx->stats, 0, sizeof(ctx->stats));
+    ctx->rate_start_ns = get_time_ns();
+    ctx->rate_reports = 0;
+    pthread_mutex_unlock(&ctx->touch_mutex);
+}
+
+int xpt2046_poll_events(xpt2046_ctx_t* ctx, touch_event_t* events, int max) {
+    uint32_t tail = atomic_load_explicit(&ctx->event_tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&ctx->event_head, memory_order_acquire);
+    int count = 0;
+    
+    while (tail != head && count < max) {
+        events[count++] = ctx->events[tail & (TOUCH_EVENT_QUEUE - 1)];
+        tail++;
+    }
+    
+    // Hands the slots back to the touch thread. Sequentially consistent,
+    // like the head store in queue_event: either the touch thread sees the
+    // queue empty and signals, or the check below sees its event.
+    atomic_store_explicit(&ctx->event_tail, tail, memory_order_seq_cst);
+    
+    // Drained: clear the eventfd, then re-arm it if an event slipped in
+    if (count > 0 && tail == head) {
+        uint64_t value;
+        
+        if (read(ctx->event_fd, &value, sizeof(value)) < 0 && errno != EAGAIN) {
+            perror("Failed to clear touch eventfd");
+        }
+        
+        if (atomic_load_explicit(&ctx->event_head, memory_order_seq_cst) != tail) {
+            signal_events(ctx);
         }
-        ctx->filter_initialized = true;
     }
     
-    // Apply median filter to reduce noise
-    int16_t temp_x[TOUCH_SAMPLE_COUNT];
-    int16_t temp_y[TOUCH_SAMPLE_COUNT];
+    return count;
+}
+
+int xpt2046_wait_events(xpt2046_ctx_t* ctx, int timeout_ms) {
+    if (atomic_load_explicit(&ctx->event_head, memory_order_acquire) !=
+        atomic_load_explicit(&ctx->event_tail, memory_order_relaxed)) {
+        return RPI_DISPLAY_OK;
+    }
     
-    memcpy(temp_x, ctx->filter_x, sizeof(temp_x));
-    memcpy(temp_y, ctx->filter_y, sizeof(temp_y));
+    struct pollfd pfd = { .fd = ctx->event_fd, .events = POLLIN };
+    int ready = poll(&pfd, 1, timeout_ms < 0 ? -1 : timeout_ms);
     
-    *filtered_x = median_filter(temp_x, TOUCH_SAMPLE_COUNT);
-    *filtered_y = median_filter(temp_y, TOUCH_SAMPLE_COUNT);
+    if (ready < 0 && errno != EINTR) {
+        perror("Failed to wait for touch events");
+        return RPI_DISPLAY_ERROR_INIT;
+    }
+    
+    // A signal ends the wait like a timeout, so callers can check their flags
+    return ready > 0 ? RPI_DISPLAY_OK : RPI_DISPLAY_ERROR_TIMEOUT;
+}
+
+// Filtering functions
+void xpt2046_filter_touch(xpt2046_ctx_t* ctx, int16_t raw_x, int16_t raw_y, uint64_t now_ns,
+                          int16_t* filtered_x, int16_t* filtered_y) {
+    if (!ctx->filter_initialized) {
+        // Pen down: start where the pen is, at rest
+        ctx->filter_x.value = raw_x;
+        ctx->filter_x.slope = 0.0f;
+        ctx->filter_y.value = raw_y;
+        ctx->filter_y.slope = 0.0f;
+        ctx->filter_time_ns = now_ns;
+        ctx->filter_initialized = true;
+        
+        *filtered_x = raw_x;
+        *filtered_y = raw_y;
+        return;
+    }
+    
+    // Reports are timer-driven but can be late; use the real interval
+    float dt = (now_ns - ctx->filter_time_ns) * 1e-9f;
+    if (dt < 1e-4f) dt = 1e-4f;
+    ctx->filter_time_ns = now_ns;
+    
+    *filtered_x = smooth_axis(&ctx->filter_x, raw_x, dt);
+    *filtered_y = smooth_axis(&ctx->filter_y, raw_y, dt);
 }
 
 void xpt2046_reset_filter(xpt2046_ctx_t* ctx) {
     ctx->filter_initialized = false;
-    ctx->filter_index = 0;
-    memset(ctx->filter_x, 0, sizeof(ctx->filter_x));
-    memset(ctx->filter_y, 0, sizeof(ctx->filter_y));
+    memset(&ctx->filter_x, 0, sizeof(ctx->filter_x));
+    memset(&ctx->filter_y, 0, sizeof(ctx->filter_y));
 }
 
 // Calibration functions
@@ -190,7 +341,10 @@ void xpt2046_apply_calibration(xpt2046_ctx_t* ctx, int16_t raw_x, int16_t raw_y,
 }
 
 void xpt2046_set_calibration(xpt2046_ctx_t* ctx, const touch_config_t* config) {
+    pthread_mutex_lock(&ctx->touch_mutex);
     memcpy(&ctx->calibration, config, sizeof(touch_config_t));
+    build_sampler(ctx);
+    pthread_mutex_unlock(&ctx->touch_mutex);
 }
 
 // Interrupt handling
@@ -198,51 +352,79 @@ int xpt2046_setup_interrupt(xpt2046_ctx_t* ctx) {
     char path[64];
     int fd;
     
-    // Set up interrupt pin
-    if (gpio_export(GPIO_TOUCH_IRQ) < 0) {
-        return -1;
+    if (ctx->gpio_backend == GPIO_BACKEND_CHARDEV) {
+        // Edge events are delivered on the line request fd
+        ctx->gpio_fd_irq = gpio_request_line(GPIO_TOUCH_IRQ, "in", "falling", 0);
+        if (ctx->gpio_fd_irq < 0) {
+            // Without a CS line this request was the probe for the
+            // character device, so automatic selection can still fall back
+            if (ctx->software_cs || ctx->calibration.gpio_backend == GPIO_BACKEND_CHARDEV) {
+                return -1;
+            }
+            ctx->gpio_backend = GPIO_BACKEND_SYSFS;
+        }
     }
     
-    if (gpio_set_direction(GPIO_TOUCH_IRQ, "in") < 0) {
-        return -1;
+    if (ctx->gpio_backend == GPIO_BACKEND_SYSFS) {
+        // Set up interrupt pin
+        if (gpio_export(GPIO_TOUCH_IRQ) < 0) {
+            return -1;
+        }
+        
+        if (gpio_set_direction(GPIO_TOUCH_IRQ, "in") < 0) {
+            return -1;
+        }
+        
+        // Set interrupt edge
+        snprintf(path, sizeof(path), "/sys/class/gpio/gpio%d/edge", GPIO_TOUCH_IRQ);
+        fd = open(path, O_WRONLY);
+        if (fd < 0) {
+            perror("Failed to open interrupt edge");
+            return -1;
+        }
+        
+        if (write(fd, "falling", 7) < 0) {
+            perror("Failed to set interrupt edge");
+            close(fd);
+            return -1;
+        }
+        close(fd);
+        
+        // Open interrupt value file
+        snprintf(path, sizeof(path), "/sys/class/gpio/gpio%d/value", GPIO_TOUCH_IRQ);
+        ctx->gpio_fd_irq = open(path, O_RDONLY);
+        if (ctx->gpio_fd_irq < 0) {
+            perror("Failed to open interrupt value");
+            return -1;
+        }
     }
     
-    // Set interrupt edge
-    snprintf(path, sizeof(path), "/sys/class/gpio/gpio%d/edge", GPIO_TOUCH_IRQ);
-    fd = open(path, O_WRONLY);
-    if (fd < 0) {
-        perror("Failed to open interrupt edge");
+    // Set up epoll for interrupt handling
+    ctx->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (ctx->epoll_fd < 0) {
+        perror("Failed to create epoll");
         return -1;
     }
     
-    if (write(fd, "falling", 7) < 0) {
-        perror("Failed to set interrupt edge");
-        close(fd);
+    ctx->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (ctx->timer_fd < 0) {
+        perror("Failed to create touch report timer");
         return -1;
     }
-    close(fd);
     
-    // Open interrupt value file
-    snprintf(path, sizeof(path), "/sys/class/gpio/gpio%d/value", GPIO_TOUCH_IRQ);
-    ctx->gpio_fd_irq = open(path, O_RDONLY);
-    if (ctx->gpio_fd_irq < 0) {
-        perror("Failed to open interrupt value");
+    ctx->stop_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (ctx->stop_fd < 0) {
+        perror("Failed to create touch stop eventfd");
         return -1;
     }
     
-    // Set up epoll for interrupt handling
-    ctx->epoll_fd = epoll_create1(0);
-    if (ctx->epoll_fd < 0) {
-        perror("Failed to create epoll");
+    if (add_fd(ctx, ctx->timer_fd, EPOLLIN) < 0 || add_fd(ctx, ctx->stop_fd, EPOLLIN) < 0) {
         return -1;
     }
     
-    struct epoll_event ev;
-    ev.events = EPOLLIN | EPOLLET;
-    ev.data.fd = ctx->gpio_fd_irq;
-    
-    if (epoll_ctl(ctx->epoll_fd, EPOLL_CTL_ADD, ctx->gpio_fd_irq, &ev) < 0) {
-        perror("Failed to add interrupt to epoll");
+    // Start idle, waiting for the pen
+    ctx->state = TOUCH_STATE_IDLE;
+    if (set_interrupt_armed(ctx, true) == 0) {
         return -1;
     }
     
@@ -256,22 +438,34 @@ void xpt2046_cleanup_interrupt(xpt2046_ctx_t* ctx) {
         ctx->epoll_fd = -1;
     }
     
+    if (ctx->timer_fd >= 0) {
+        close(ctx->timer_fd);
+        ctx->timer_fd = -1;
+    }
+    
+    if (ctx->stop_fd >= 0) {
+        close(ctx->stop_fd);
+        ctx->stop_fd = -1;
+    }
+    
     if (ctx->gpio_fd_irq >= 0) {
         close(ctx->gpio_fd_irq);
         ctx->gpio_fd_irq = -1;
     }
     
-    gpio_unexport(GPIO_TOUCH_IRQ);
+    if (ctx->gpio_backend == GPIO_BACKEND_SYSFS) {
+        gpio_unexport(GPIO_TOUCH_IRQ);
+    }
     ctx->interrupt_enabled = false;
 }
 
 void* xpt2046_interrupt_thread(void* arg) {
     xpt2046_ctx_t* ctx = (xpt2046_ctx_t*)arg;
-    struct epoll_event events[1];
-    char buffer[64];
+    struct epoll_event events[3];
     
     while (ctx->thread_running) {
-        int nfds = epoll_wait(ctx->epoll_fd, events, 1, 100); // 100ms timeout
+        // No timeout: idle, only the pen or a stop request wakes us
+        int nfds = epoll_wait(ctx->epoll_fd, events, 3, -1);
         
         if (nfds < 0) {
             if (errno == EINTR) continue;
@@ -279,63 +473,33 @@ void* xpt2046_interrupt_thread(void* arg) {
             break;
         }
         
-        if (nfds == 0) continue; // Timeout, check if thread should continue
-        
-        // Clear the interrupt by reading the value
-        if (read(ctx->gpio_fd_irq, buffer, sizeof(buffer)) < 0) {
-            perror("Failed to read interrupt value");
-            continue;
-        }
+        uint64_t wake_ns = get_time_ns();
+        uint32_t syscalls = 1;  // The epoll_wait that woke us
+        bool sample = false;
         
-        // Check if touch is still pressed
-        if (gpio_get_value(GPIO_TOUCH_IRQ) == 0) {
-            // Touch is pressed, read coordinates
-            pthread_mutex_lock(&ctx->touch_mutex);
-            
-            // Read multiple samples for better accuracy
-            int16_t x_samples[TOUCH_SAMPLE_COUNT];
-            int16_t y_samples[TOUCH_SAMPLE_COUNT];
-            int valid_samples = 0;
+        for (int i = 0; i < nfds; i++) {
+            int fd = events[i].data.fd;
             
-            for (int i = 0; i < TOUCH_SAMPLE_COUNT; i++) {
-                int x = xpt2046_read_raw_x(ctx);
-                int y = xpt2046_read_raw_y(ctx);
-                int pressure = xpt2046_read_pressure(ctx);
-                
-                if (x > 0 && y > 0 && pressure > TOUCH_PRESSURE_THRESHOLD) {
-                    x_samples[valid_samples] = x;
-                    y_samples[valid_samples] = y;
-                    valid_samples++;
-                }
-                
-                delay_ms(1); // Small delay between samples
+            if (fd == ctx->stop_fd) {
+                return NULL;
             }
             
-            if (valid_samples > 0) {
-                // Use median of valid samples
-                ctx->raw_x = median_filter(x_samples, valid_samples);
-                ctx->raw_y = median_filter(y_samples, valid_samples);
-                
-                // Apply filtering
-                int16_t filtered_x, filtered_y;
-                xpt2046_filter_touch(ctx, ctx->raw_x, ctx->raw_y, &filtered_x, &filtered_y);
-                
-                // Apply calibration
-                xpt2046_apply_calibration(ctx, filtered_x, filtered_y, &ctx->screen_x, &ctx->screen_y);
+            if (fd == ctx->timer_fd) {
+                uint64_t expirations;
                 
-                ctx->touch_pressed = true;
-                ctx->touch_timestamp = get_time_ns() / 1000000; // Convert to milliseconds
-                ctx->touch_count++;
-                ctx->last_touch_time = ctx->touch_timestamp;
+                // Missed ticks are not made up, the next report is current
+                syscalls++;
+                if (read(ctx->timer_fd, &expirations, sizeof(expirations)) > 0) {
+                    sample = true;
+                }
+            } else if (fd == ctx->gpio_fd_irq) {
+                syscalls += clear_interrupt(ctx);
+                sample = true;
             }
-            
-            pthread_mutex_unlock(&ctx->touch_mutex);
-        } else {
-            // Touch is released
-            pthread_mutex_lock(&ctx->touch_mutex);
-            ctx->touch_pressed = false;
-            xpt2046_reset_filter(ctx);
-            pthread_mutex_unlock(&ctx->touch_mutex);
+        }
+        
+        if (sample) {
+            report_touch(ctx, wake_ns, syscalls);
         }
     }
     
@@ -360,17 +524,45 @@ int xpt2046_init(xpt2046_ctx_t* ctx, const touch_config_t* config) {
         ctx->calibration.invert_y = false;
     }
     
-    // Initialize GPIO pins
-    if (gpio_export(GPIO_TOUCH_CS) < 0) {
-        return RPI_DISPLAY_ERROR_GPIO;
-    }
+    ctx->spi_fd = -1;
+    ctx->gpio_fd_cs = -1;
+    ctx->gpio_fd_irq = -1;
+    ctx->epoll_fd = -1;
+    ctx->event_fd = -1;
+    ctx->timer_fd = -1;
+    ctx->stop_fd = -1;
+    ctx->software_cs = ctx->calibration.software_cs;
+    build_sampler(ctx);
     
-    if (gpio_set_direction(GPIO_TOUCH_CS, "out") < 0) {
-        return RPI_DISPLAY_ERROR_GPIO;
+    // Initialize GPIO pins, preferring the character device. With the SPI
+    // controller driving CE1 the IRQ line request decides instead.
+    ctx->gpio_backend = GPIO_BACKEND_SYSFS;
+    if (!ctx->software_cs) {
+        if (ctx->calibration.gpio_backend != GPIO_BACKEND_SYSFS) {
+            ctx->gpio_backend = GPIO_BACKEND_CHARDEV;
+        }
+    } else if (ctx->calibration.gpio_backend != GPIO_BACKEND_SYSFS) {
+        // CS is requested high
+        ctx->gpio_fd_cs = gpio_request_line(GPIO_TOUCH_CS, "out", NULL, 1);
+        if (ctx->gpio_fd_cs >= 0) {
+            ctx->gpio_backend = GPIO_BACKEND_CHARDEV;
+        } else if (ctx->calibration.gpio_backend == GPIO_BACKEND_CHARDEV) {
+            return RPI_DISPLAY_ERROR_GPIO;
+        }
     }
     
-    // Set CS high initially
-    gpio_set_value(GPIO_TOUCH_CS, 1);
+    if (ctx->software_cs && ctx->gpio_backend == GPIO_BACKEND_SYSFS) {
+        if (gpio_export(GPIO_TOUCH_CS) < 0) {
+            return RPI_DISPLAY_ERROR_GPIO;
+        }
+        
+        if (gpio_set_direction(GPIO_TOUCH_CS, "out") < 0) {
+            return RPI_DISPLAY_ERROR_GPIO;
+        }
+        
+        // Set CS high initially
+        gpio_set_value(GPIO_TOUCH_CS, 1);
+    }
     
     // Initialize SPI
     if (touch_spi_init(ctx) < 0) {
@@ -383,8 +575,18 @@ int xpt2046_init(xpt2046_ctx_t* ctx, const touch_config_t* config) {
         return RPI_DISPLAY_ERROR_INIT;
     }
     
+    // Readiness of the event queue for callers' poll loops
+    ctx->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (ctx->event_fd < 0) {
+        perror("Failed to create touch eventfd");
+        return RPI_DISPLAY_ERROR_INIT;
+    }
+    
     // Set up interrupt handling
     if (xpt2046_setup_interrupt(ctx) < 0) {
+        xpt2046_cleanup_interrupt(ctx);
+        close(ctx->event_fd);
+        ctx->event_fd = -1;
         return RPI_DISPLAY_ERROR_GPIO;
     }
     
@@ -406,8 +608,17 @@ void xpt2046_destroy(xpt2046_ctx_t* ctx) {
     // Clean up SPI
     touch_spi_destroy(ctx);
     
-    // Clean up GPIO
-    gpio_unexport(GPIO_TOUCH_CS);
+    if (ctx->event_fd >= 0) {
+        close(ctx->event_fd);
+        ctx->event_fd = -1;
+    }
+    
+    // Clean up GPIO; without software CS the line is the SPI controller's
+    if (ctx->software_cs && ctx->gpio_backend == GPIO_BACKEND_CHARDEV) {
+        gpio_release_line(&ctx->gpio_fd_cs);
+    } else if (ctx->software_cs) {
+        gpio_unexport(GPIO_TOUCH_CS);
+    }
     
     // Destroy mutex
     pthread_mutex_destroy(&ctx->touch_mutex);
@@ -427,7 +638,12 @@ int xpt2046_start_interrupt_thread(xpt2046_ctx_t* ctx) {
 
 void xpt2046_stop_interrupt_thread(xpt2046_ctx_t* ctx) {
     if (ctx->thread_running) {
+        uint64_t value = 1;
+        
         ctx->thread_running = false;
+        if (write(ctx->stop_fd, &value, sizeof(value)) < 0) {
+            perror("Failed to wake touch thread");
+        }
         pthread_join(ctx->touch_thread, NULL);
     }
 }
@@ -466,11 +682,366 @@ int xpt2046_calibrate(xpt2046_ctx_t* ctx) {
 }
 
 // Helper functions
-static void delay_ms(int ms) {
-    struct timespec ts;
-    ts.tv_sec = ms / 1000;
-    ts.tv_nsec = (ms % 1000) * 1000000;
-    nanosleep(&ts, NULL);
+static int touch_pressure(int z1, int z2) {
+    if (z1 == 0) return 0;
+    
+    // Calculate pressure using formula from datasheet
+    return (z2 - z1) * 1000 / z1;
+}
+
+// Command stream for TOUCH_MAX_SAMPLES sets of X, Y, Z1, Z2; reports send
+// a prefix of it. Each command goes out in the second byte of the previous
+// conversion, so a conversion costs 16 clocks, 8 us at TOUCH_SPI_SPEED:
+// the XPT2046's 125 kHz maximum. PD1-PD0 stay 00 so PENIRQ is armed again
+// afterwards.
+static void build_sampler(xpt2046_ctx_t* ctx) {
+    static const uint8_t channels[XPT2046_CHANNELS] = {
+        XPT2046_X_MEASURE, XPT2046_Y_MEASURE, XPT2046_Z1_MEASURE, XPT2046_Z2_MEASURE
+    };
+    int samples = ctx->calibration.samples ? ctx->calibration.samples : TOUCH_SAMPLE_COUNT;
+    int max_samples = ctx->calibration.max_samples ? ctx->calibration.max_samples : TOUCH_OVERSAMPLE_COUNT;
+    bool low_res = ctx->calibration.resolution == 8;
+    
+    if (samples > TOUCH_MAX_SAMPLES) samples = TOUCH_MAX_SAMPLES;
+    if (max_samples > TOUCH_MAX_SAMPLES) max_samples = TOUCH_MAX_SAMPLES;
+    if (max_samples < samples) max_samples = samples;
+    
+    memset(ctx->sample_tx, 0, sizeof(ctx->sample_tx));
+    for (int i = 0; i < TOUCH_MAX_SAMPLES * XPT2046_CHANNELS; i++) {
+        ctx->sample_tx[2 * i] = XPT2046_START_BIT | channels[i % XPT2046_CHANNELS] |
+                                (low_res ? XPT2046_MODE_8BIT : 0);
+    }
+    
+    ctx->sample_count = samples;
+    ctx->sample_max = max_samples;
+    
+    // Results start one clock after the command byte, MSB first; 8-bit
+    // ones are widened so calibration works on the same 0..4095 range
+    ctx->sample_shift = low_res ? 7 : 3;
+    ctx->sample_scale = low_res ? 4 : 0;
+}
+
+static int sampler_result(const xpt2046_ctx_t* ctx, int conversion) {
+    const uint8_t* rx = &ctx->sample_rx[1 + 2 * conversion];
+    int word = rx[0] << 8 | rx[1];
+    
+    return ((word >> ctx->sample_shift) & (0xFFF >> ctx->sample_scale)) << ctx->sample_scale;
+}
+
+// Reports per second over windows of at least a second of contact
+static void count_report(xpt2046_ctx_t* ctx, uint64_t now, bool pen_down) {
+    ctx->stats.reports++;
+    
+    if (pen_down) {
+        ctx->rate_start_ns = now;
+        ctx->rate_reports = 0;
+        return;
+    }
+    
+    ctx->rate_reports++;
+    
+    if (now - ctx->rate_start_ns >= 1000000000ULL) {
+        ctx->stats.report_rate = ctx->rate_reports * 1e9f / (now - ctx->rate_start_ns);
+        ctx->rate_start_ns = now;
+        ctx->rate_reports = 0;
+    }
+}
+
+// Producer side of the event queue, run by the touch thread under
+// touch_mutex; the consumer never takes the lock
+static uint32_t queue_free(xpt2046_ctx_t* ctx) {
+    uint32_t head = atomic_load_explicit(&ctx->event_head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&ctx->event_tail, memory_order_acquire);
+    
+    return TOUCH_EVENT_QUEUE - (head - tail);
+}
+
+static void queue_event(xpt2046_ctx_t* ctx, const touch_event_t* event) {
+    uint32_t head = atomic_load_explicit(&ctx->event_head, memory_order_relaxed);
+    
+    ctx->events[head & (TOUCH_EVENT_QUEUE - 1)] = *event;
+    atomic_store_explicit(&ctx->event_head, head + 1, memory_order_seq_cst);
+    ctx->stats.events++;
+    
+    // The eventfd stays readable until the queue is drained, so only the
+    // first event after that needs the write
+    if (atomic_load_explicit(&ctx->event_tail, memory_order_seq_cst) == head) {
+        signal_events(ctx);
+        ctx->stats.syscalls++;
+    }
+}
+
+static int signal_events(xpt2046_ctx_t* ctx) {
+    uint64_t value = 1;
+    
+    if (write(ctx->event_fd, &value, sizeof(value)) < 0 && errno != EAGAIN) {
+        perror("Failed to signal touch eventfd");
+        return -1;
+    }
+    
+    return 0;
+}
+
+// Queue the held-back move once the consumer has made room; returns the
+// slots left
+static uint32_t flush_pending_move(xpt2046_ctx_t* ctx) {
+    uint32_t free_slots = queue_free(ctx);
+    
+    if (ctx->move_pending && free_slots > TOUCH_EVENT_RESERVE) {
+        queue_event(ctx, &ctx->pending_move);
+        ctx->move_pending = false;
+        free_slots--;
+    }
+    
+    return free_slots;
+}
+
+// Moves only need their latest position, so a full queue folds them into
+// one held-back move; downs and ups always get a slot while one is free
+static void push_event(xpt2046_ctx_t* ctx, touch_event_type_t type, int16_t pressure, uint64_t now) {
+    touch_event_t event = {
+        .type = type,
+        .x = ctx->screen_x,
+        .y = ctx->screen_y,
+        .pressure = pressure,
+        .timestamp_ns = now,
+    };
+    uint32_t free_slots = flush_pending_move(ctx);
+    
+    if (type == TOUCH_EVENT_MOVE) {
+        if (free_slots > TOUCH_EVENT_RESERVE) {
+            queue_event(ctx, &event);
+            return;
+        }
+        
+        if (ctx->move_pending) ctx->stats.moves_coalesced++;
+        ctx->pending_move = event;
+        ctx->move_pending = true;
+        return;
+    }
+    
+    // Only an up can follow a held move, and it ends at the same position
+    if (ctx->move_pending) {
+        ctx->stats.moves_coalesced++;
+        ctx->move_pending = false;
+    }
+    
+    if (free_slots == 0) {
+        ctx->stats.events_dropped++;
+        return;
+    }
+    
+    queue_event(ctx, &event);
+}
+
+static int add_fd(xpt2046_ctx_t* ctx, int fd, uint32_t events) {
+    struct epoll_event ev;
+    ev.events = events;
+    ev.data.fd = fd;
+    
+    if (epoll_ctl(ctx->epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        perror("Failed to add touch fd to epoll");
+        return -1;
+    }
+    
+    return 0;
+}
+
+// Consume pending PENIRQ edges; returns the syscalls spent. Draining the
+// character device takes a second read that comes back empty, sysfs
+// needs a rewind before the read that acknowledges the edge.
+static uint32_t clear_interrupt(xpt2046_ctx_t* ctx) {
+    char buffer[8];
+    
+    if (ctx->gpio_backend == GPIO_BACKEND_CHARDEV) {
+        gpio_line_read_events(ctx->gpio_fd_irq);
+        return 2;
+    }
+    
+    lseek(ctx->gpio_fd_irq, 0, SEEK_SET);
+    if (read(ctx->gpio_fd_irq, buffer, sizeof(buffer)) < 0) {
+        perror("Failed to read interrupt value");
+    }
+    
+    return 2;
+}
+
+// PENIRQ is out of the epoll set while pressed: conversions make it
+// bounce, and sysfs reports an unacknowledged edge on every wait.
+// Returns the syscalls spent, 0 on failure.
+static uint32_t set_interrupt_armed(xpt2046_ctx_t* ctx, bool armed) {
+    if (!armed) {
+        if (epoll_ctl(ctx->epoll_fd, EPOLL_CTL_DEL, ctx->gpio_fd_irq, NULL) < 0) {
+            perror("Failed to mask touch interrupt");
+            return 0;
+        }
+        return 1;
+    }
+    
+    // Edges from the pressed period are stale
+    uint32_t syscalls = clear_interrupt(ctx) + 1;
+    
+    if (add_fd(ctx, ctx->gpio_fd_irq, ctx->gpio_backend == GPIO_BACKEND_CHARDEV ?
+               EPOLLIN : EPOLLPRI | EPOLLERR) < 0) {
+        return 0;
+    }
+    
+    return syscalls;
+}
+
+// Periodic at the report rate, or one tick from now. Returns the syscalls
+// spent, 0 on failure.
+static uint32_t set_report_timer(xpt2046_ctx_t* ctx, bool periodic) {
+    int rate = ctx->calibration.report_rate ? ctx->calibration.report_rate : TOUCH_REPORT_RATE;
+    struct itimerspec spec;
+    
+    if (rate > TOUCH_REPORT_RATE_MAX) rate = TOUCH_REPORT_RATE_MAX;
+    
+    // One report a second is a whole second, which tv_nsec can't hold
+    long period = 1000000000L / rate;
+    
+    memset(&spec, 0, sizeof(spec));
+    spec.it_value.tv_sec = period / 1000000000L;
+    spec.it_value.tv_nsec = period % 1000000000L;
+    if (periodic) {
+        spec.it_interval = spec.it_value;
+    }
+    
+    if (timerfd_settime(ctx->timer_fd, 0, &spec, NULL) < 0) {
+        perror("Failed to set touch report timer");
+        return 0;
+    }
+    
+    return 1;
+}
+
+static uint32_t stop_report_timer(xpt2046_ctx_t* ctx) {
+    struct itimerspec spec;
+    
+    memset(&spec, 0, sizeof(spec));
+    if (timerfd_settime(ctx->timer_fd, 0, &spec, NULL) < 0) {
+        perror("Failed to stop touch report timer");
+        return 0;
+    }
+    
+    return 1;
+}
+
+// One pass of the state machine, after an edge or a timer tick
+static void report_touch(xpt2046_ctx_t* ctx, uint64_t wake_ns, uint32_t syscalls) {
+    int16_t x_samples[TOUCH_MAX_SAMPLES];
+    int16_t y_samples[TOUCH_MAX_SAMPLES];
+    int16_t p_samples[TOUCH_MAX_SAMPLES];
+    
+    pthread_mutex_lock(&ctx->touch_mutex);
+    
+    // First samples in one SPI message
+    int valid_samples = xpt2046_read_samples(ctx, ctx->sample_count, x_samples, y_samples, p_samples);
+    
+    // Take the rest only when the first ones disagree, which is rare on a
+    // quiet panel and common while the pen lands or on a noisy board
+    if (valid_samples > 0 && ctx->sample_max > ctx->sample_count &&
+        (sample_spread(x_samples, valid_samples) > TOUCH_SPREAD_THRESHOLD ||
+         sample_spread(y_samples, valid_samples) > TOUCH_SPREAD_THRESHOLD)) {
+        int more = xpt2046_read_samples(ctx, ctx->sample_max - ctx->sample_count,
+                                        &x_samples[valid_samples], &y_samples[valid_samples],
+                                        &p_samples[valid_samples]);
+        if (more > 0) valid_samples += more;
+        ctx->stats.oversampled++;
+    }
+    
+    if (valid_samples > 0) {
+        ctx->release_count = 0;
+        
+        // Use median of valid samples
+        ctx->raw_x = median_filter(x_samples, valid_samples);
+        ctx->raw_y = median_filter(y_samples, valid_samples);
+        ctx->pressure = median_filter(p_samples, valid_samples);
+        
+        // Apply filtering
+        int16_t filtered_x, filtered_y;
+        xpt2046_filter_touch(ctx, ctx->raw_x, ctx->raw_y, wake_ns, &filtered_x, &filtered_y);
+        
+        // Apply calibration
+        int16_t last_x = ctx->screen_x;
+        int16_t last_y = ctx->screen_y;
+        xpt2046_apply_calibration(ctx, filtered_x, filtered_y, &ctx->screen_x, &ctx->screen_y);
+        
+        bool pen_down = ctx->state == TOUCH_STATE_IDLE;
+        bool moved = ctx->screen_x != last_x || ctx->screen_y != last_y;
+        
+        if (pen_down) {
+            // Pressed: sample on the clock, PENIRQ masked
+            ctx->state = TOUCH_STATE_PRESSED;
+            syscalls += set_interrupt_armed(ctx, false);
+            
+            uint32_t timer_syscalls = set_report_timer(ctx, true);
+            if (timer_syscalls == 0) {
+                // Nothing would sample again; drop the touch and go back
+                // to waiting on PENIRQ
+                ctx->stats.syscalls += syscalls;
+                xpt2046_reset_filter(ctx);
+                enter_idle(ctx);
+                pthread_mutex_unlock(&ctx->touch_mutex);
+                return;
+            }
+            syscalls += timer_syscalls;
+        }
+        
+        uint64_t now = get_time_ns();
+        
+        ctx->touch_pressed = true;
+        ctx->touch_timestamp = now / 1000000; // Convert to milliseconds
+        ctx->touch_count++;
+        ctx->last_touch_time = ctx->touch_timestamp;
+        
+        count_report(ctx, now, pen_down);
+        if (pen_down || moved) {
+            push_event(ctx, pen_down ? TOUCH_EVENT_DOWN : TOUCH_EVENT_MOVE, ctx->pressure, now);
+        }
+        ctx->stats.last_report_ns = now - wake_ns;
+    } else if (ctx->state == TOUCH_STATE_PRESSED && ++ctx->release_count >= TOUCH_RELEASE_REPORTS) {
+        // Pressure gone: the pen is up
+        push_event(ctx, TOUCH_EVENT_UP, 0, get_time_ns());
+        ctx->touch_pressed = false;
+        xpt2046_reset_filter(ctx);
+        enter_idle(ctx);
+    } else if (ctx->state == TOUCH_STATE_IDLE) {
+        // An edge without pressure, or a recheck after lift-off; wait for
+        // the next edge unless PENIRQ says the pen is still on the panel
+        syscalls += gpio_syscalls(ctx);
+        if (touch_gpio_get_irq(ctx) == 0) {
+            syscalls += set_report_timer(ctx, false);
+        }
+    }
+    
+    // A pen resting after a burst sends nothing new, so the held-back move
+    // goes out on the next report that finds room for it
+    if (ctx->move_pending && ctx->state == TOUCH_STATE_PRESSED) {
+        flush_pending_move(ctx);
+    }
+    
+    ctx->stats.syscalls += syscalls;
+    
+    pthread_mutex_unlock(&ctx->touch_mutex);
+}
+
+// Back to waiting on PENIRQ. A touch landing between the last sample and
+// re-arming raised no edge we will see, so the line level is checked once
+// and a single timer tick samples again if it is low.
+static void enter_idle(xpt2046_ctx_t* ctx) {
+    uint32_t syscalls = stop_report_timer(ctx);
+    
+    ctx->state = TOUCH_STATE_IDLE;
+    ctx->release_count = 0;
+    syscalls += set_interrupt_armed(ctx, true);
+    
+    syscalls += gpio_syscalls(ctx);
+    if (touch_gpio_get_irq(ctx) == 0) {
+        syscalls += set_report_timer(ctx, false);
+    }
+    
+    ctx->stats.syscalls += syscalls;
 }
 
 static uint64_t get_time_ns(void) {
@@ -479,17 +1050,80 @@ static uint64_t get_time_ns(void) {
     return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
 }
 
-static int median_filter(int16_t* values, int count) {
-    // Simple bubble sort for median filtering
-    for (int i = 0; i < count - 1; i++) {
-        for (int j = 0; j < count - i - 1; j++) {
-            if (values[j] > values[j + 1]) {
-                int16_t temp = values[j];
-                values[j] = values[j + 1];
-                values[j + 1] = temp;
-            }
+// Compare-exchange for the median networks. Both sides are plain
+// min/max, which compile to conditional moves rather than branches.
+#define SORT2(a, b) do {                    \
+        int16_t lo_ = (a) < (b) ? (a) : (b);  \
+        (b) = (a) < (b) ? (b) : (a);          \
+        (a) = lo_;                            \
+    } while (0)
+
+// Median of count values, reordering them. The counts a report normally
+// ends up with use fixed networks of 3, 7 and 19 exchanges (the last is
+// Paeth's from Graphics Gems); anything else, left over after pressure
+// rejection, gets an insertion sort.
+static int median_filter(int16_t* v, int count) {
+    switch (count) {
+    case 1:
+        return v[0];
+    case 3:
+        SORT2(v[0], v[1]); SORT2(v[1], v[2]); SORT2(v[0], v[1]);
+        return v[1];
+    case 5:
+        SORT2(v[0], v[1]); SORT2(v[3], v[4]); SORT2(v[0], v[3]);
+        SORT2(v[1], v[4]); SORT2(v[1], v[2]); SORT2(v[2], v[3]);
+        SORT2(v[1], v[2]);
+        return v[2];
+    case 9:
+        SORT2(v[1], v[2]); SORT2(v[4], v[5]); SORT2(v[7], v[8]);
+        SORT2(v[0], v[1]); SORT2(v[3], v[4]); SORT2(v[6], v[7]);
+        SORT2(v[1], v[2]); SORT2(v[4], v[5]); SORT2(v[7], v[8]);
+        SORT2(v[0], v[3]); SORT2(v[5], v[8]); SORT2(v[4], v[7]);
+        SORT2(v[3], v[6]); SORT2(v[1], v[4]); SORT2(v[2], v[5]);
+        SORT2(v[4], v[7]); SORT2(v[4], v[2]); SORT2(v[6], v[4]);
+        SORT2(v[4], v[2]);
+        return v[4];
+    }
+    
+    for (int i = 1; i < count; i++) {
+        int16_t value = v[i];
+        int j = i;
+        
+        while (j > 0 && v[j - 1] > value) {
+            v[j] = v[j - 1];
+            j--;
         }
+        v[j] = value;
+    }
+    
+    return v[count / 2];
+}
+
+static int sample_spread(const int16_t* values, int count) {
+    int16_t lo = values[0];
+    int16_t hi = values[0];
+    
+    for (int i = 1; i < count; i++) {
+        lo = values[i] < lo ? values[i] : lo;
+        hi = values[i] > hi ? values[i] : hi;
     }
     
-    return values[count / 2];
-} 
\ No newline at end of file
+    return hi - lo;
+}
+
+// One-euro filter step: a low-pass whose cutoff follows the smoothed speed
+static int16_t smooth_axis(touch_axis_filter_t* axis, int16_t raw, float dt) {
+    float slope = (raw - axis->value) / dt;
+    axis->slope += smoothing_alpha(TOUCH_FILTER_SLOPE_CUTOFF, dt) * (slope - axis->slope);
+    
+    float cutoff = TOUCH_FILTER_MIN_CUTOFF + TOUCH_FILTER_BETA * fabsf(axis->slope);
+    axis->value += smoothing_alpha(cutoff, dt) * (raw - axis->value);
+    
+    return (int16_t)(axis->value + 0.5f);
+}
+
+// Weight of a new value in a first-order low-pass at cutoff Hz
+static float smoothing_alpha(float cutoff, float dt) {
+    float tau = 1.0f / (2.0f * 3.14159265f * cutoff);
+    return 1.0f / (1.0f + tau / dt);
+}